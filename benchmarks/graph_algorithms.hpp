@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <grb/grb.hpp>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// The algorithms of examples/algorithms, without their printing, so that
+// they can be timed on any matrix backend.  Each takes the adjacency matrix
+// `a` of an undirected graph.
+
+namespace bench {
+
+// Breadth-first search from `source`, returning the number of levels.
+template <grb::MatrixRange M>
+std::size_t bfs(M&& a, std::size_t source) {
+  using I = grb::matrix_index_t<M>;
+  grb::vector<bool, I> frontier(a.shape()[0]);
+  grb::vector<bool, I> visited(a.shape()[0]);
+  frontier[source] = true;
+  visited[source] = true;
+
+  std::size_t levels = 0;
+  while (frontier.size() > 0) {
+    auto next =
+        grb::multiply(grb::transpose(a), frontier, grb::logical_or{},
+                      grb::logical_and{}, grb::complement_view(visited));
+    for (auto&& [v, _] : next) {
+      visited[v] = true;
+    }
+    frontier = std::move(next);
+    levels++;
+  }
+  return levels;
+}
+
+// Bellman-Ford single source shortest paths from `source`, returning the
+// number of relaxation rounds.
+template <grb::MatrixRange M>
+std::size_t sssp(M&& a, std::size_t source) {
+  using T = grb::matrix_scalar_t<M>;
+  using I = grb::matrix_index_t<M>;
+  grb::vector<T, I> dist(a.shape()[0]);
+  dist[source] = 0;
+
+  std::size_t rounds = 0;
+  while (true) {
+    rounds++;
+    auto update = grb::multiply(grb::transpose(a), dist, grb::min{},
+                                grb::plus{}, grb::full_vector_mask{});
+
+    bool updated = false;
+    auto next = grb::ewise_union(dist, update, [&](T x, T y) {
+      if (y < x) {
+        updated = true;
+      }
+      return std::min(x, y);
+    });
+
+    if (!updated && next.size() == dist.size()) {
+      return rounds;
+    }
+    dist = std::move(next);
+  }
+}
+
+// Betweenness centrality contributions of shortest paths from `source`.
+template <grb::MatrixRange M>
+auto betweenness_centrality(M&& a, std::size_t source) {
+  auto s = grb::views::transform(a, [](auto&&) -> int { return 1; });
+
+  grb::vector<float> delta(a.shape()[0]);
+  std::vector<grb::vector<int>> sigma;
+
+  grb::vector<int> q(a.shape()[0]);
+  q[source] = 1;
+  grb::vector<int> p = q;
+
+  q = grb::multiply(grb::transpose(s), q, grb::plus{}, grb::times{},
+                    grb::complement_view(p));
+
+  int d = 0;
+  do {
+    sigma.push_back(q);
+    p = grb::ewise_union(p, q, grb::plus{});
+    q = grb::multiply(grb::transpose(s), q, grb::plus{}, grb::times{},
+                      grb::complement_view(p));
+    ++d;
+  } while (!q.empty());
+
+  grb::vector<float> t1(a.shape()[0]);
+  grb::vector<float> t2(a.shape()[0]);
+  grb::vector<float> t3(a.shape()[0]);
+  grb::vector<float> t4(a.shape()[0]);
+
+  for (int i = d - 1; i > 0; i--) {
+    grb::assign(t1, 1.0f);
+    t1 = grb::ewise_union(t1, delta, grb::plus{});
+    t2 = sigma[i];
+    t2 = grb::ewise_intersection(t1, t2, grb::divides{});
+    t3 = grb::multiply(s, t2, grb::plus{}, grb::times{});
+    t4 = sigma[i - 1];
+    t4 = grb::ewise_intersection(t4, t3, grb::times{});
+    delta = grb::ewise_union(delta, t4, grb::plus{});
+  }
+
+  return delta;
+}
+
+// Number of triangles, counted as the sum of L * L masked by L, where L is
+// the strictly lower triangle of `a`.
+template <grb::MatrixRange M>
+std::size_t triangle_count(M&& a) {
+  auto l = grb::views::transform(grb::views::filter(a, grb::lower_triangle()),
+                                 [](auto&&) -> std::size_t { return 1; });
+  auto c = grb::multiply(l, l, grb::plus(), grb::times(), l);
+  auto values = grb::views::stored_values(c);
+  return std::reduce(values.begin(), values.end(), std::size_t(0));
+}
+
+// Luby's maximal independent set, returning the number of vertices in the
+// set.
+template <grb::MatrixRange M>
+std::size_t maximal_independent_set(M&& a, unsigned int seed) {
+  std::default_random_engine generator(seed);
+  std::uniform_real_distribution<double> distribution;
+
+  grb::vector<int> independent_set(a.shape()[0]);
+
+  auto a_structure = grb::views::transform(a, [](auto&&) -> int { return 1; });
+  auto degrees = grb::reduce(a_structure);
+
+  grb::vector<bool> candidates = degrees;
+  grb::assign(independent_set, grb::complement_view(degrees));
+
+  while (!candidates.empty()) {
+    auto prob = grb::ewise_intersection(
+        candidates, degrees, [&](auto&&, int degree) -> float {
+          return 0.0001 + distribution(generator) / 1. + 2. * degree;
+        });
+
+    auto neighbor_max =
+        grb::multiply(a_structure, prob, grb::max(), grb::take_right());
+
+    auto new_members =
+        grb::ewise_union(prob, neighbor_max, std::greater<float>());
+
+    grb::vector<bool> new_members_sparse(new_members.shape());
+    for (auto&& [idx, value] : new_members) {
+      if (bool(value)) {
+        new_members_sparse.insert({idx, value});
+      }
+    }
+
+    candidates = grb::ewise_intersection(
+        candidates, grb::complement_view(new_members_sparse),
+        grb::take_left<int>());
+
+    independent_set =
+        grb::ewise_union(independent_set, new_members_sparse, grb::plus());
+
+    auto new_neighbors = grb::multiply(a_structure, new_members_sparse,
+                                       grb::logical_or(), grb::logical_and());
+
+    candidates = grb::ewise_intersection(
+        candidates, grb::complement_view(new_neighbors), grb::take_left());
+  }
+
+  return independent_set.size();
+}
+
+} // namespace bench
@@ -0,0 +1,265 @@
+#include "graph_algorithms.hpp"
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <grb/grb.hpp>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Time the library's kernels and the example algorithms on a generated
+// graph, for each matrix backend, and report the results as JSON.
+//
+// Usage: see `usage` below.
+//
+// The graph has 2^scale vertices and about edge-factor * 2^scale edges, and
+// is symmetrized, without self loops, for the graph algorithms.  Each
+// benchmark runs `repetitions` times, or fewer if its runs take more than
+// `max-seconds` in total, and only benchmarks whose name contains `filter`
+// run.
+
+using T = float;
+using I = std::size_t;
+
+constexpr const char* usage =
+    "Usage: grb_benchmarks [--generator rmat|er] [--scale 8]\n"
+    "                      [--edge-factor 16] [--seed 0] [--backends csr,coo]\n"
+    "                      [--repetitions 5] [--max-seconds 10]\n"
+    "                      [--filter name] [--output file] [--help]\n";
+
+struct options {
+  std::string generator = "rmat";
+  std::size_t scale = 8;
+  std::size_t edge_factor = 16;
+  unsigned int seed = 0;
+  std::vector<std::string> backends = {"csr", "coo"};
+  std::size_t repetitions = 5;
+  double max_seconds = 10;
+  std::string filter;
+  std::string output;
+  bool help = false;
+};
+
+options parse_options(int argc, char** argv) {
+  options o;
+  for (int i = 1; i < argc; i += 2) {
+    std::string key = argv[i];
+    if (key == "--help" || key == "-h") {
+      o.help = true;
+      return o;
+    }
+    if (i + 1 == argc) {
+      throw std::invalid_argument("missing value for option " + key);
+    }
+    std::string value = argv[i + 1];
+    if (key == "--generator") {
+      o.generator = value;
+    } else if (key == "--scale") {
+      o.scale = std::stoul(value);
+    } else if (key == "--edge-factor") {
+      o.edge_factor = std::stoul(value);
+    } else if (key == "--seed") {
+      o.seed = std::stoul(value);
+    } else if (key == "--backends") {
+      o.backends.clear();
+      std::stringstream list(value);
+      for (std::string backend; std::getline(list, backend, ',');) {
+        o.backends.push_back(backend);
+      }
+    } else if (key == "--repetitions") {
+      o.repetitions = std::max<std::size_t>(1, std::stoul(value));
+    } else if (key == "--max-seconds") {
+      o.max_seconds = std::stod(value);
+    } else if (key == "--filter") {
+      o.filter = value;
+    } else if (key == "--output") {
+      o.output = value;
+    } else {
+      throw std::invalid_argument("unknown option " + key);
+    }
+  }
+  return o;
+}
+
+grb::matrix<T, I> generate_graph(const options& o) {
+  if (o.generator == "rmat") {
+    return grb::generate_rmat<T, I>(o.scale, o.edge_factor, o.seed);
+  } else if (o.generator == "er") {
+    std::size_t n = std::size_t(1) << o.scale;
+    double density = std::min(1.0, double(o.edge_factor) / n);
+    return grb::generate_random<T, I>({n, n}, density, o.seed);
+  } else {
+    throw std::invalid_argument("unknown generator " + o.generator);
+  }
+}
+
+// The union of `a` and its transpose, without the diagonal.
+grb::matrix<T, I> symmetrize(const grb::matrix<T, I>& a) {
+  std::vector<grb::matrix_entry<T, I>> edges;
+  edges.reserve(2 * a.size());
+  for (auto&& [index, value] : a) {
+    auto&& [i, j] = index;
+    if (i != j) {
+      edges.push_back({{i, j}, value});
+      edges.push_back({{j, i}, value});
+    }
+  }
+
+  grb::matrix<T, I> g(a.shape());
+  g.insert(edges.begin(), edges.end());
+  return g;
+}
+
+template <typename M>
+std::size_t nbytes(const M& m) {
+  return m.backend().nbytes();
+}
+
+// Copy of `a` stored in the backend picked by `Hint`.
+template <typename Hint>
+grb::matrix<T, I, Hint> convert(const grb::matrix<T, I>& a) {
+  grb::matrix<T, I, Hint> b(a.shape());
+  if constexpr (std::is_same_v<Hint, grb::sparse>) {
+    b = a;
+  } else {
+    b.backend().push_back(a.begin(), a.end());
+  }
+  return b;
+}
+
+template <typename Hint>
+void run_backend(bench::runner& runner, const std::string& backend,
+                 const grb::matrix<T, I>& csr_a,
+                 const grb::matrix<T, I>& csr_g, const options& o) {
+  using bench::work_kind;
+
+  auto a = convert<Hint>(csr_a);
+  auto g = convert<Hint>(csr_g);
+  std::size_t m = a.shape()[0];
+  std::size_t nnz = a.size();
+
+  std::vector<std::size_t> row_length(m);
+  for (auto&& [index, _] : a) {
+    row_length[grb::get<0>(index)]++;
+  }
+
+  // SpMV with a dense vector of ones.
+  grb::vector<T, I> x(a.shape()[1]);
+  for (std::size_t j = 0; j < a.shape()[1]; j++) {
+    x[j] = 1;
+  }
+  runner.run("spmv", backend, 2.0 * nnz, work_kind::flops, nbytes(a),
+             [&] { grb::multiply(a, x); });
+
+  // SpMSpV with A^T and a sparse vector, as in one step of a traversal.
+  auto sparse_x = grb::generate_random<T, I>(I(m), 0.01, o.seed);
+  double spmspv_flops = 0;
+  for (auto&& [j, _] : sparse_x) {
+    spmspv_flops += 2.0 * row_length[j];
+  }
+  runner.run("spmspv", backend, spmspv_flops, work_kind::flops, nbytes(a),
+             [&] { grb::multiply(grb::transpose(a), sparse_x); });
+
+  // SpGEMM of A with itself.
+  double spgemm_flops = 0;
+  for (auto&& [index, _] : a) {
+    spgemm_flops += 2.0 * row_length[grb::get<1>(index)];
+  }
+  runner.run("spgemm", backend, spgemm_flops, work_kind::flops, nbytes(a),
+             [&] { grb::multiply(a, a); });
+
+  auto g_nnz = g.size();
+  runner.run("ewise_union", backend, double(nnz + g_nnz), work_kind::flops,
+             nbytes(a), [&] { grb::ewise_union(a, g, grb::plus{}); });
+  runner.run("ewise_intersection", backend, double(nnz + g_nnz),
+             work_kind::flops, nbytes(a),
+             [&] { grb::ewise_intersection(a, g, grb::times{}); });
+
+  runner.run("reduce", backend, double(nnz), work_kind::flops, nbytes(a),
+             [&] { grb::reduce(a); });
+
+  runner.run("transpose", backend, double(nnz), work_kind::edges, nbytes(a),
+             [&] { grb::transpose_materialize(a); });
+
+  std::vector<I> permutation(m);
+  std::iota(permutation.begin(), permutation.end(), I(0));
+  std::shuffle(permutation.begin(), permutation.end(),
+               std::mt19937_64(o.seed));
+  runner.run("permute", backend, double(nnz), work_kind::edges, nbytes(a),
+             [&] { grb::permute(a, permutation); });
+
+  auto path = (std::filesystem::temp_directory_path() /
+               ("grb_benchmarks_" + std::to_string(getpid()) + ".mtx"))
+                  .string();
+  grb::mmwrite(path, a);
+  runner.run("mmread", backend, double(nnz), work_kind::edges, nbytes(a),
+             [&] { grb::matrix<T, I, Hint> b(path); });
+  std::filesystem::remove(path);
+
+  // Start the traversals from the vertex of highest degree.
+  std::vector<std::size_t> degree(m);
+  for (auto&& [index, _] : g) {
+    degree[grb::get<0>(index)]++;
+  }
+  std::size_t source =
+      std::max_element(degree.begin(), degree.end()) - degree.begin();
+
+  double edges = double(g_nnz);
+  runner.run("bfs", backend, edges, work_kind::edges, nbytes(g),
+             [&] { bench::bfs(g, source); });
+  runner.run("sssp", backend, edges, work_kind::edges, nbytes(g),
+             [&] { bench::sssp(g, source); });
+  runner.run("betweenness_centrality", backend, edges, work_kind::edges,
+             nbytes(g), [&] { bench::betweenness_centrality(g, source); });
+  runner.run("triangle_counting", backend, edges, work_kind::edges, nbytes(g),
+             [&] { bench::triangle_count(g); });
+  runner.run("maximal_independent_set", backend, edges, work_kind::edges,
+             nbytes(g), [&] { bench::maximal_independent_set(g, o.seed); });
+}
+
+int main(int argc, char** argv) {
+  options o;
+  try {
+    o = parse_options(argc, argv);
+  } catch (const std::logic_error& e) {
+    std::cerr << "grb_benchmarks: " << e.what() << "\n" << usage;
+    return 1;
+  }
+  if (o.help) {
+    std::cout << usage;
+    return 0;
+  }
+
+  auto a = generate_graph(o);
+  auto g = symmetrize(a);
+
+  bench::runner runner(o.repetitions, o.max_seconds, o.filter);
+  for (auto&& backend : o.backends) {
+    if (backend == "csr") {
+      run_backend<grb::sparse>(runner, backend, a, g, o);
+    } else if (backend == "coo") {
+      run_backend<grb::coordinate>(runner, backend, a, g, o);
+    } else {
+      throw std::invalid_argument("unknown backend " + backend);
+    }
+  }
+
+  nlohmann::json context;
+  context["generator"] = o.generator;
+  context["scale"] = o.scale;
+  context["edge_factor"] = o.edge_factor;
+  context["seed"] = o.seed;
+  context["vertices"] = a.shape()[0];
+  context["edges"] = a.size();
+  context["symmetric_edges"] = g.size();
+  context["threads"] = grb::detail::max_threads();
+  bench::write_report(o.output, context, runner);
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+// A small timing harness for the benchmarks.  Each benchmark is run a number
+// of times and reported, with the amount of work it does, as one record of a
+// JSON document that can be compared between runs.
+
+namespace bench {
+
+// What the `work` of a benchmark counts, and the rate it is reported in.
+enum class work_kind { flops, edges };
+
+struct result {
+  std::string name;
+  std::string backend;
+  std::size_t repetitions = 0;
+  double seconds_min = 0;
+  double seconds_median = 0;
+  double work = 0;
+  work_kind kind = work_kind::flops;
+  std::size_t nbytes = 0;
+  // High-water mark of the process after the benchmark, which includes the
+  // memory of all benchmarks run before it.
+  std::size_t peak_rss_bytes = 0;
+};
+
+// Peak resident set size of the process so far, in bytes.
+inline std::size_t peak_rss() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return std::size_t(usage.ru_maxrss);
+#else
+  return std::size_t(usage.ru_maxrss) * 1024;
+#endif
+}
+
+// Run `fn` up to `repetitions` times, stopping early once the runs have
+// taken `max_seconds` in total, and return the time of each run in seconds.
+template <typename Fn>
+std::vector<double> time_runs(std::size_t repetitions, double max_seconds,
+                              Fn&& fn) {
+  std::vector<double> times;
+  double total = 0;
+  for (std::size_t i = 0; i < repetitions && total < max_seconds; i++) {
+    auto begin = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double>(end - begin).count());
+    total += times.back();
+  }
+  return times;
+}
+
+class runner {
+public:
+  runner(std::size_t repetitions, double max_seconds, std::string filter)
+      : repetitions_(repetitions), max_seconds_(max_seconds),
+        filter_(std::move(filter)) {}
+
+  // Time `fn` as benchmark `name` on `backend`, unless it is filtered out.
+  // `work` is the number of flops or edges of one run, and `nbytes` the size
+  // of the matrix it runs on.
+  template <typename Fn>
+  void run(const std::string& name, const std::string& backend, double work,
+           work_kind kind, std::size_t nbytes, Fn&& fn) {
+    if (!filter_.empty() && name.find(filter_) == std::string::npos) {
+      return;
+    }
+
+    auto times = time_runs(repetitions_, max_seconds_, fn);
+    std::sort(times.begin(), times.end());
+
+    result r;
+    r.name = name;
+    r.backend = backend;
+    r.repetitions = times.size();
+    r.seconds_min = times.front();
+    r.seconds_median = times[times.size() / 2];
+    r.work = work;
+    r.kind = kind;
+    r.nbytes = nbytes;
+    r.peak_rss_bytes = peak_rss();
+
+    std::cerr << name << " [" << backend << "]: " << r.seconds_median
+              << " s\n";
+    results_.push_back(r);
+  }
+
+  const std::vector<result>& results() const noexcept {
+    return results_;
+  }
+
+private:
+  std::size_t repetitions_;
+  double max_seconds_;
+  std::string filter_;
+  std::vector<result> results_;
+};
+
+inline nlohmann::json to_json(const result& r) {
+  bool flops = r.kind == work_kind::flops;
+  double rate = r.seconds_median > 0 ? r.work / r.seconds_median * 1e-9 : 0;
+
+  nlohmann::json j;
+  j["name"] = r.name;
+  j["backend"] = r.backend;
+  j["repetitions"] = r.repetitions;
+  j["seconds_min"] = r.seconds_min;
+  j["seconds_median"] = r.seconds_median;
+  j[flops ? "flops" : "edges"] = r.work;
+  j[flops ? "gflops" : "gteps"] = rate;
+  j["nbytes"] = r.nbytes;
+  j["peak_rss_bytes"] = r.peak_rss_bytes;
+  return j;
+}
+
+// Write `context` and the results of `r` as JSON to `path`, or to standard
+// output if `path` is empty.
+inline void write_report(const std::string& path, nlohmann::json context,
+                         const runner& r) {
+  nlohmann::json report;
+  report["context"] = std::move(context);
+  report["benchmarks"] = nlohmann::json::array();
+  for (auto&& result : r.results()) {
+    report["benchmarks"].push_back(to_json(result));
+  }
+
+  if (path.empty()) {
+    std::cout << report.dump(2) << std::endl;
+  } else {
+    std::ofstream f(path);
+    f << report.dump(2) << std::endl;
+  }
+}
+
+} // namespace bench
@@ -16,6 +16,8 @@ int main(int argc, char** argv) {
   // srand48(0);
   // Import graph
   grb::matrix<int> a("../chesapeake/chesapeake.mtx");
+  // Each step multiplies by the transpose, so keep it materialized.
+  a.cache_transpose();
 
   // Create vector to represent our frontier
   grb::vector<int> x(a.shape()[1]);
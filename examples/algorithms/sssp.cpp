@@ -16,6 +16,8 @@ int main(int argc, char** argv) {
   // srand48(0);
   // Import graph
   grb::matrix<int> a("../chesapeake/chesapeake.mtx");
+  // Each step multiplies by the transpose, so keep it materialized.
+  a.cache_transpose();
 
   // Create vector to hold distances to each vertex
   grb::vector<int> dist(a.shape()[1]);
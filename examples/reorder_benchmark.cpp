@@ -0,0 +1,91 @@
+#include <chrono>
+#include <fmt/core.h>
+#include <grb/grb.hpp>
+#include <string>
+
+// Time sparse matrix-vector multiply and breadth-first search on a graph
+// before and after reordering its vertices.
+//
+// Usage: reorder_benchmark [matrix.mtx] [repetitions]
+
+template <typename Fn>
+double time_it(std::size_t repetitions, Fn&& fn) {
+  auto begin = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < repetitions; i++) {
+    fn();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double>(end - begin).count() / repetitions;
+}
+
+template <typename M>
+std::size_t bfs(M&& a, int source) {
+  grb::vector<bool, int> frontier(a.shape()[0]);
+  grb::vector<bool, int> visited(a.shape()[0]);
+  frontier[source] = true;
+  visited[source] = true;
+
+  std::size_t levels = 0;
+  while (frontier.size() > 0) {
+    auto next =
+        grb::multiply(grb::transpose(a), frontier, grb::logical_or{},
+                      grb::logical_and{}, grb::complement_view(visited));
+    for (auto&& [v, _] : next) {
+      visited[v] = true;
+    }
+    frontier = std::move(next);
+    levels++;
+  }
+  return levels;
+}
+
+template <typename M>
+void run(const std::string& name, M&& a, int source, std::size_t repetitions) {
+  grb::vector<float, int> x(a.shape()[1]);
+  for (int i = 0; i < a.shape()[1]; i++) {
+    x[i] = 1;
+  }
+
+  double spmv = time_it(repetitions, [&] { grb::multiply(a, x); });
+  double bfs_time = time_it(repetitions, [&] { bfs(a, source); });
+
+  fmt::print("{:<24} spmv {:10.6f} s   bfs {:10.6f} s\n", name, spmv,
+             bfs_time);
+}
+
+template <typename Method>
+void run_reordered(const std::string& name, grb::matrix<float, int>& a,
+                   Method method, std::size_t repetitions) {
+  auto begin = std::chrono::high_resolution_clock::now();
+  auto [b, permutation] = grb::reorder(a, method);
+  auto end = std::chrono::high_resolution_clock::now();
+
+  // Start BFS from the same vertex as in the original graph.
+  int source = 0;
+  for (std::size_t i = 0; i < permutation.size(); i++) {
+    if (permutation[i] == 0) {
+      source = i;
+    }
+  }
+
+  run(name + " (" +
+          std::to_string(std::chrono::duration<double>(end - begin).count()) +
+          " s)",
+      b, source, repetitions);
+}
+
+int main(int argc, char** argv) {
+  std::string path = argc > 1 ? argv[1] : "chesapeake/chesapeake.mtx";
+  std::size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 10;
+
+  grb::matrix<float, int> a(path);
+  fmt::print("{}: {} x {}, {} elements\n", path, a.shape()[0], a.shape()[1],
+             a.size());
+
+  run("original", a, 0, repetitions);
+  run_reordered("rcm", a, grb::reverse_cuthill_mckee{}, repetitions);
+  run_reordered("degree", a, grb::degree_order{}, repetitions);
+  run_reordered("gorder", a, grb::gorder{}, repetitions);
+
+  return 0;
+}
@@ -5,3 +5,5 @@
 #include <grb/algorithms/multiply.hpp>
 #include <grb/algorithms/permute.hpp>
 #include <grb/algorithms/reduce.hpp>
+#include <grb/algorithms/reorder.hpp>
+#include <grb/algorithms/transpose.hpp>
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <cstddef>
+#include <grb/algorithms/semiring_kernels.hpp>
 #include <grb/detail/detail.hpp>
+#include <grb/detail/mask_bitmap.hpp>
 #include <grb/detail/matrix_traits.hpp>
 #include <grb/detail/monoid_traits.hpp>
+#include <grb/detail/trace.hpp>
+#include <grb/util/workspace.hpp>
+#include <memory>
 
 namespace grb {
 
@@ -29,13 +35,14 @@ auto ewise_intersection(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
   using index_type =
       grb::bigger_integral_t<grb::matrix_index_t<A>, grb::matrix_index_t<B>>;
 
+  grb::detail::trace_scope<> scope("ewise_intersection", a, b);
+  scope.mask(mask);
+
   grb::matrix<c_scalar_type, index_type> c(a.shape());
 
   for (auto&& [index, a_value] : a) {
-    if constexpr (!std::is_same_v<std::remove_cvref_t<M>,
-                                  grb::full_matrix_mask<>>) {
-      auto mask_iter = mask.find(index);
-      if (mask_iter == mask.end() || !bool(grb::get<1>(*mask_iter))) {
+    if constexpr (!grb::is_full_mask_v<M>) {
+      if (!grb::detail::matrix_mask_allows(mask, index)) {
         continue;
       }
     }
@@ -50,6 +57,8 @@ auto ewise_intersection(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
     }
   }
 
+  scope.flops(std::size_t(c.size()));
+  scope.output(c);
   return c;
 }
 
@@ -76,15 +85,16 @@ auto ewise_union(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
   using index_type =
       grb::bigger_integral_t<grb::matrix_index_t<A>, grb::matrix_index_t<B>>;
 
+  grb::detail::trace_scope<> scope("ewise_union", a, b);
+  scope.mask(mask);
+
   grb::matrix<c_scalar_type, index_type> c(a.shape());
 
   size_t num_matched = 0;
 
   for (auto&& [index, a_value] : a) {
-    if constexpr (!std::is_same_v<std::remove_cvref_t<M>,
-                                  grb::full_matrix_mask<>>) {
-      auto mask_iter = mask.find(index);
-      if (mask_iter == mask.end() || !bool(grb::get<1>(*mask_iter))) {
+    if constexpr (!grb::is_full_mask_v<M>) {
+      if (!grb::detail::matrix_mask_allows(mask, index)) {
         continue;
       }
     }
@@ -105,22 +115,27 @@ auto ewise_union(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
 
   if (num_matched < b.size()) {
     for (auto&& [index, b_value] : b) {
-      auto mask_iter = mask.find(index);
-      if (mask_iter == mask.end() || !bool(grb::get<1>(*mask_iter))) {
+      if (!grb::detail::matrix_mask_allows(mask, index)) {
         continue;
       }
       c.insert({index, b_value});
     }
   }
 
+  scope.flops(num_matched);
+  scope.output(c);
   return c;
 }
 
-template <
-    VectorRange A, VectorRange B,
-    BinaryOperator<grb::vector_scalar_t<A>, grb::vector_scalar_t<B>> Combine,
-    MaskVectorRange M = grb::full_vector_mask<>>
-auto ewise_intersection(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
+namespace __detail {
+
+// Element-wise operations on vectors whose result and mask bitmap are
+// allocated with `allocator`.
+
+template <typename A, typename B, typename Combine, typename M,
+          typename Allocator>
+auto ewise_intersection_(A&& a, B&& b, Combine&& combine, M&& mask,
+                         const Allocator& allocator) {
   if (a.shape() != b.shape()) {
     throw grb::invalid_argument(
         "ewise_intersection: Dimensions of vectors are incompatible.");
@@ -139,15 +154,18 @@ auto ewise_intersection(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
   using index_type =
       grb::bigger_integral_t<grb::vector_index_t<A>, grb::vector_index_t<B>>;
 
-  grb::vector<c_scalar_type, index_type> c(a.shape());
+  grb::detail::trace_scope<> scope("ewise_intersection", a, b);
+  scope.mask(mask);
+
+  using c_allocator_type = rebind_alloc_t<Allocator, c_scalar_type>;
+
+  grb::vector<c_scalar_type, index_type, grb::dense, c_allocator_type> c(
+      a.shape(), allocator);
+  grb::detail::vector_mask_bitmap mask_bits(mask, a.shape(), allocator);
 
   for (auto&& [index, a_value] : a) {
-    if constexpr (!std::is_same_v<std::remove_cvref_t<M>,
-                                  grb::full_vector_mask<>>) {
-      auto mask_iter = mask.find(index);
-      if (mask_iter == mask.end() || !bool(grb::get<1>(*mask_iter))) {
-        continue;
-      }
+    if (!mask_bits.test(index)) {
+      continue;
     }
 
     auto iter = b.find(index);
@@ -160,14 +178,15 @@ auto ewise_intersection(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
     }
   }
 
+  scope.flops(std::size_t(c.size()));
+  scope.output(c);
   return c;
 }
 
-template <
-    VectorRange A, VectorRange B,
-    BinaryOperator<grb::vector_scalar_t<A>, grb::vector_scalar_t<B>> Combine,
-    MaskVectorRange M = grb::full_vector_mask<>>
-auto ewise_union(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
+template <typename A, typename B, typename Combine, typename M,
+          typename Allocator>
+auto ewise_union_(A&& a, B&& b, Combine&& combine, M&& mask,
+                  const Allocator& allocator) {
   if (a.shape() != b.shape()) {
     throw grb::invalid_argument("ewise_intersection: Dimensions of vectors (" +
                                 std::to_string(a.shape()) + " and " +
@@ -188,17 +207,20 @@ auto ewise_union(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
   using index_type =
       grb::bigger_integral_t<grb::vector_index_t<A>, grb::vector_index_t<B>>;
 
-  grb::vector<c_scalar_type, index_type> c(a.shape());
+  grb::detail::trace_scope<> scope("ewise_union", a, b);
+  scope.mask(mask);
+
+  using c_allocator_type = rebind_alloc_t<Allocator, c_scalar_type>;
+
+  grb::vector<c_scalar_type, index_type, grb::dense, c_allocator_type> c(
+      a.shape(), allocator);
+  grb::detail::vector_mask_bitmap mask_bits(mask, a.shape(), allocator);
 
   size_t num_matched = 0;
 
   for (auto&& [index, a_value] : a) {
-    if constexpr (!std::is_same_v<std::remove_cvref_t<M>,
-                                  grb::full_vector_mask<>>) {
-      auto mask_iter = mask.find(index);
-      if (mask_iter == mask.end() || !bool(grb::get<1>(*mask_iter))) {
-        continue;
-      }
+    if (!mask_bits.test(index)) {
+      continue;
     }
 
     auto iter = b.find(index);
@@ -217,15 +239,64 @@ auto ewise_union(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
 
   if (num_matched < b.size()) {
     for (auto&& [index, b_value] : b) {
-      auto mask_iter = mask.find(index);
-      if (mask_iter == mask.end() || !bool(grb::get<1>(*mask_iter))) {
+      if (!mask_bits.test(index)) {
         continue;
       }
       c.insert({index, b_value});
     }
   }
 
+  scope.flops(num_matched);
+  scope.output(c);
   return c;
 }
 
+} // namespace __detail
+
+template <
+    VectorRange A, VectorRange B,
+    BinaryOperator<grb::vector_scalar_t<A>, grb::vector_scalar_t<B>> Combine,
+    MaskVectorRange M = grb::full_vector_mask<>>
+auto ewise_intersection(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
+  return __detail::ewise_intersection_(
+      std::forward<A>(a), std::forward<B>(b), std::forward<Combine>(combine),
+      std::forward<M>(mask), grb::allocator<std::byte>());
+}
+
+/// Element-wise operation on two vectors, allocating the result from
+/// `workspace`.  The result is valid until `workspace` is reset.
+template <
+    VectorRange A, VectorRange B,
+    BinaryOperator<grb::vector_scalar_t<A>, grb::vector_scalar_t<B>> Combine,
+    MaskVectorRange M = grb::full_vector_mask<>>
+auto ewise_intersection(grb::workspace& workspace, A&& a, B&& b,
+                        Combine&& combine, M&& mask = M{}) {
+  return __detail::ewise_intersection_(
+      std::forward<A>(a), std::forward<B>(b), std::forward<Combine>(combine),
+      std::forward<M>(mask), grb::workspace_allocator<std::byte>(workspace));
+}
+
+template <
+    VectorRange A, VectorRange B,
+    BinaryOperator<grb::vector_scalar_t<A>, grb::vector_scalar_t<B>> Combine,
+    MaskVectorRange M = grb::full_vector_mask<>>
+auto ewise_union(A&& a, B&& b, Combine&& combine, M&& mask = M{}) {
+  return __detail::ewise_union_(
+      std::forward<A>(a), std::forward<B>(b), std::forward<Combine>(combine),
+      std::forward<M>(mask), grb::allocator<std::byte>());
+}
+
+/// Element-wise operation on two vectors, allocating the result from
+/// `workspace`.  The result is valid until `workspace` is reset.
+template <
+    VectorRange A, VectorRange B,
+    BinaryOperator<grb::vector_scalar_t<A>, grb::vector_scalar_t<B>> Combine,
+    MaskVectorRange M = grb::full_vector_mask<>>
+auto ewise_union(grb::workspace& workspace, A&& a, B&& b, Combine&& combine,
+                 M&& mask = M{}) {
+  return __detail::ewise_union_(
+      std::forward<A>(a), std::forward<B>(b), std::forward<Combine>(combine),
+      std::forward<M>(mask), grb::workspace_allocator<std::byte>(workspace));
+}
+
 } // namespace grb
@@ -1,26 +1,108 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <grb/algorithms/assign.hpp>
+#include <grb/algorithms/semiring_kernels.hpp>
+#include <grb/algorithms/spgemm.hpp>
 #include <grb/containers/views/views.hpp>
+#include <grb/detail/bitmap.hpp>
 #include <grb/detail/concepts.hpp>
+#include <grb/detail/csr_storage.hpp>
 #include <grb/detail/detail.hpp>
+#include <grb/detail/mask_bitmap.hpp>
+#include <grb/detail/trace.hpp>
+#include <grb/util/workspace.hpp>
+#include <memory>
 #include <type_traits>
 #include <utility>
 
 namespace grb {
 
-/// Multiply a matrix times a vector
-template <MatrixRange A, VectorRange B,
-          BinaryOperator<grb::matrix_scalar_t<A>, grb::vector_scalar_t<B>>
-              Combine = grb::multiplies<>,
-          BinaryOperator<grb::combine_result_t<A, B, Combine>,
-                         grb::combine_result_t<A, B, Combine>,
-                         grb::combine_result_t<A, B, Combine>>
-              Reduce = grb::plus<>,
-          MaskVectorRange M = grb::full_vector_mask<>>
-auto multiply(A&& a, B&& b, Reduce&& reduce = Reduce{},
-              Combine&& combine = Combine(), M&& mask = M{}) {
+namespace __detail {
+
+// Matrix-vector multiply, with a dense or sparse `b`, of a matrix read from
+// storage, such as `grb::mapped_csr_matrix`.  Rows are reduced one at a time
+// against a dense copy of `b`, in order, which is the order of the file, and
+// prefetched ahead, so that the matrix is read once and sequentially.
+template <typename A, typename B, typename Reduce, typename Combine,
+          typename M, typename Allocator>
+auto multiply_prefetched_(A&& a, B&& b, Reduce&& reduce, Combine&& combine,
+                          M&& mask, const Allocator& allocator) {
+  using a_scalar_type = grb::matrix_scalar_t<A>;
+  using b_scalar_type = grb::vector_scalar_t<B>;
+  using a_index_type = grb::matrix_index_t<A>;
+  using c_scalar_type = decltype(combine(std::declval<a_scalar_type>(),
+                                         std::declval<b_scalar_type>()));
+  using c_index_type =
+      grb::bigger_integral_t<a_index_type, grb::vector_index_t<B>>;
+  using c_allocator_type = rebind_alloc_t<Allocator, c_scalar_type>;
+
+  std::vector<b_scalar_type, rebind_alloc_t<Allocator, b_scalar_type>>
+      b_values(b.shape(), b_scalar_type(), allocator);
+  grb::detail::bitmap<Allocator> b_present(b.shape(), false, allocator);
+
+  for (auto&& [k, b_v] : b) {
+    b_values[k] = b_v;
+    b_present.set(k);
+  }
+
+  grb::vector<c_scalar_type, c_index_type, grb::dense, c_allocator_type> c(
+      a.shape()[0], allocator);
+  grb::detail::vector_mask_bitmap mask_bits(mask, a.shape()[0], allocator);
+
+  std::size_t i = 0;
+  for (auto&& row : a.rows(a_index_type(0), a_index_type(a.shape()[0]))) {
+    if (mask_bits.test(i)) {
+      c_scalar_type acc{};
+      bool present = false;
+
+      for (auto&& [index, a_v] : row) {
+        auto k = index[1];
+        if (!b_present.test(k)) {
+          continue;
+        }
+
+        c_scalar_type product = combine(a_v, b_values[k]);
+        acc = present ? c_scalar_type(reduce(acc, product)) : product;
+        present = true;
+
+        if constexpr (grb::has_early_exit_v<Reduce, c_scalar_type>) {
+          if (grb::is_terminal<Reduce>(acc)) {
+            break;
+          }
+        }
+      }
+
+      if (present) {
+        c.insert({c_index_type(i), acc});
+      }
+    }
+    i++;
+  }
+
+  return c;
+}
+
+// Matrix-vector multiply whose result and temporaries are allocated with
+// `allocator`.  Semiring kernels that do not accept an allocator are only
+// used with the default allocator.
+template <typename A, typename B, typename Reduce, typename Combine,
+          typename M, typename Allocator>
+auto multiply_vector_(A&& a, B&& b, Reduce&& reduce, Combine&& combine,
+                      M&& mask, const Allocator& allocator) {
+  // The transpose of a matrix that keeps it materialized, as used by
+  // vector-matrix products, is multiplied from the materialized matrix,
+  // whose CSR arrays the kernels below read directly.
+  if constexpr (requires { a.materialized(); }) {
+    if (auto t = a.materialized()) {
+      return multiply_vector_(*t, std::forward<B>(b),
+                              std::forward<Reduce>(reduce),
+                              std::forward<Combine>(combine),
+                              std::forward<M>(mask), allocator);
+    }
+  }
+
   using a_scalar_type = grb::matrix_scalar_t<A>;
   using b_scalar_type = grb::vector_scalar_t<B>;
 
@@ -32,36 +114,168 @@ auto multiply(A&& a, B&& b, Reduce&& reduce = Reduce{},
 
   using c_index_type = grb::bigger_integral_t<a_index_type, b_index_type>;
 
-  grb::vector<c_scalar_type, c_index_type> c(a.shape()[0]);
+  using c_allocator_type = rebind_alloc_t<Allocator, c_scalar_type>;
+
+  grb::detail::trace_scope<> scope("multiply", a, b);
+  scope.mask(mask);
+  scope.flops([&] { return grb::detail::multiply_flops(a, b); });
+
+  if constexpr (PrefetchedCSR<std::remove_cvref_t<A>>) {
+    scope.kernel("prefetched_rows");
+    auto c = multiply_prefetched_(a, b, reduce, combine, mask, allocator);
+    scope.output(c);
+    return c;
+  }
+
+  // Well-known semirings are routed to hand-tuned kernels.
+  if constexpr (grb::has_semiring_kernel_v<Reduce, Combine, c_scalar_type>) {
+    using kernel_type =
+        grb::semiring_kernel<std::remove_cvref_t<Reduce>,
+                             std::remove_cvref_t<Combine>, c_scalar_type>;
+    constexpr bool default_allocator =
+        std::is_same_v<Allocator, grb::allocator<std::byte>>;
+
+    if constexpr (default_allocator || requires {
+                    kernel_type::multiply(a, b, reduce, combine, mask,
+                                          allocator);
+                  }) {
+      if constexpr (requires { kernel_type::name; }) {
+        scope.kernel(kernel_type::name);
+      } else {
+        scope.kernel("semiring_kernel");
+      }
+
+      auto c = [&] {
+        if constexpr (default_allocator) {
+          return kernel_type::multiply(
+              std::forward<A>(a), std::forward<B>(b),
+              std::forward<Reduce>(reduce), std::forward<Combine>(combine),
+              std::forward<M>(mask));
+        } else {
+          return kernel_type::multiply(
+              std::forward<A>(a), std::forward<B>(b),
+              std::forward<Reduce>(reduce), std::forward<Combine>(combine),
+              std::forward<M>(mask), allocator);
+        }
+      }();
+      scope.output(c);
+      return c;
+    }
+  }
+
+  grb::vector<c_scalar_type, c_index_type, grb::dense, c_allocator_type> c(
+      a.shape()[0], allocator);
+  grb::detail::vector_mask_bitmap mask_bits(mask, a.shape()[0], allocator);
+
+  if constexpr (requires { grb::raw_arrays(std::as_const(a)); }) {
+    auto [shape, rowptr, colind, values] = grb::raw_arrays(std::as_const(a));
+
+    for (std::size_t i = 0; i < std::size_t(shape[0]); i++) {
+      if (!mask_bits.test(i)) {
+        continue;
+      }
+
+      c_scalar_type acc{};
+      bool present = false;
+
+      for (auto k = rowptr[i]; k < rowptr[i + 1]; k++) {
+        if constexpr (grb::has_early_exit_v<Reduce, c_scalar_type>) {
+          if (present && grb::is_terminal<Reduce>(acc)) {
+            break;
+          }
+        }
+
+        auto iter = b.find(colind[k]);
+        if (iter != b.end()) {
+          auto&& [_, b_v] = *iter;
+          c_scalar_type combined_v = combine(values[k], b_v);
+          acc = present ? c_scalar_type(reduce(acc, combined_v)) : combined_v;
+          present = true;
+        }
+      }
+
+      if (present) {
+        c.insert({c_index_type(i), acc});
+      }
+    }
+
+    scope.output(c);
+    return c;
+  }
 
   for (auto&& [a_index, a_v] : a) {
     auto&& [i, k] = a_index;
 
+    if (!mask_bits.test(i)) {
+      continue;
+    }
+
+    // Skip rows whose output already holds the reduction's terminal value.
+    if constexpr (grb::has_early_exit_v<Reduce, c_scalar_type>) {
+      auto c_iter = c.find(i);
+      if (c_iter != c.end() && grb::is_terminal<Reduce>(c_scalar_type(
+                                   grb::get<1>(*c_iter)))) {
+        continue;
+      }
+    }
+
     auto iter = b.find(k);
 
     if (iter != b.end()) {
       auto&& [_, b_v] = *iter;
 
-      auto iter = mask.find(i);
-
-      if (iter != mask.end()) {
-        auto&& [_, value] = *iter;
-        if (bool(value)) {
-          auto combined_v = combine(a_v, b_v);
-          auto&& [insert_iter, success] = c.insert({i, combined_v});
-          if (!success) {
-            auto&& [_, c_ref] = *insert_iter;
-            c_scalar_type c_v = c_ref;
-            c_ref = reduce(c_v, combined_v);
-          }
-        }
+      auto combined_v = combine(a_v, b_v);
+      auto&& [insert_iter, success] = c.insert({i, combined_v});
+      if (!success) {
+        auto&& [_, c_ref] = *insert_iter;
+        c_scalar_type c_v = c_ref;
+        c_ref = reduce(c_v, combined_v);
       }
     }
   }
 
+  scope.output(c);
   return c;
 }
 
+} // namespace __detail
+
+/// Multiply a matrix times a vector
+template <MatrixRange A, VectorRange B,
+          BinaryOperator<grb::matrix_scalar_t<A>, grb::vector_scalar_t<B>>
+              Combine = grb::multiplies<>,
+          BinaryOperator<grb::combine_result_t<A, B, Combine>,
+                         grb::combine_result_t<A, B, Combine>,
+                         grb::combine_result_t<A, B, Combine>>
+              Reduce = grb::plus<>,
+          MaskVectorRange M = grb::full_vector_mask<>>
+auto multiply(A&& a, B&& b, Reduce&& reduce = Reduce{},
+              Combine&& combine = Combine(), M&& mask = M{}) {
+  return __detail::multiply_vector_(
+      std::forward<A>(a), std::forward<B>(b), std::forward<Reduce>(reduce),
+      std::forward<Combine>(combine), std::forward<M>(mask),
+      grb::allocator<std::byte>());
+}
+
+/// Multiply a matrix times a vector, allocating the result and temporaries
+/// from `workspace`.  The result is valid until `workspace` is reset.
+template <MatrixRange A, VectorRange B,
+          BinaryOperator<grb::matrix_scalar_t<A>, grb::vector_scalar_t<B>>
+              Combine = grb::multiplies<>,
+          BinaryOperator<grb::combine_result_t<A, B, Combine>,
+                         grb::combine_result_t<A, B, Combine>,
+                         grb::combine_result_t<A, B, Combine>>
+              Reduce = grb::plus<>,
+          MaskVectorRange M = grb::full_vector_mask<>>
+auto multiply(grb::workspace& workspace, A&& a, B&& b,
+              Reduce&& reduce = Reduce{}, Combine&& combine = Combine(),
+              M&& mask = M{}) {
+  return __detail::multiply_vector_(
+      std::forward<A>(a), std::forward<B>(b), std::forward<Reduce>(reduce),
+      std::forward<Combine>(combine), std::forward<M>(mask),
+      grb::workspace_allocator<std::byte>(workspace));
+}
+
 /// Multiply two matrices
 template <MatrixRange A, MatrixRange B,
           BinaryOperator<grb::matrix_scalar_t<A>, grb::matrix_scalar_t<B>>
@@ -85,36 +299,80 @@ auto multiply(A&& a, B&& b, Reduce&& reduce = Reduce{},
 
   using c_index_type = grb::bigger_integral_t<a_index_type, b_index_type>;
 
+  if (a.shape()[1] != b.shape()[0]) {
+    throw grb::invalid_argument(
+        "multiply: Dimensions of matrices are incompatible.");
+  }
+
+  grb::detail::trace_scope<> scope("multiply", a, b);
+  scope.mask(mask);
+  scope.flops([&] { return grb::detail::multiply_flops(a, b); });
+
+  // Both operands are read by row from their CSR arrays, copying operands
+  // that are stored otherwise.  The plan picks the accumulator that fits in
+  // the memory budget, and rows are batched if it does not fit beside the
+  // output, or `grb::out_of_memory` is thrown.
+  auto&& a_csr = __detail::csr_operand<c_index_type>(a);
+  auto&& b_csr = __detail::csr_operand<c_index_type>(b);
+  auto plan = __detail::plan_spgemm<c_scalar_type>(a_csr, b_csr);
+  scope.kernel(__detail::spgemm_strategy_name(plan.strategy));
+
   grb::matrix<c_scalar_type, c_index_type> c(
       grb::index<c_index_type>(a.shape()[0], b.shape()[1]));
+  __detail::spgemm_csr(a_csr, b_csr, __detail::storage_of(c), reduce, combine,
+                       mask, plan);
 
-  for (auto&& [a_index, a_v] : a) {
-    auto&& [i, k] = a_index;
-
-    for (c_index_type j = 0; j < b.shape()[1]; j++) {
-      auto iter = b.find(grb::index<b_index_type>(k, j));
+  scope.output(c);
+  return c;
+}
 
-      if (iter != b.end()) {
-        auto&& [b_index, b_v] = *iter;
+/// Bound on the storage of each panel of rows computed by panelled
+/// matrix-matrix `grb::multiply`.
+struct row_panels {
+  /// Bytes of CSR storage of each panel.  A row larger than this is a
+  /// panel of its own.
+  std::size_t max_bytes;
+};
+
+/// Multiply two matrices one panel of consecutive rows at a time, for
+/// products too large to hold in memory.  For each panel, in order of rows,
+/// calls `sink(first_row, panel)`, where `panel` is a `grb::matrix` holding
+/// rows `[first_row, first_row + panel.shape()[0])` of the product,
+/// renumbered from 0, in at most `panels.max_bytes` bytes.  The sink may
+/// write the panel out, for example with `grb::save_binary`, reduce it, or
+/// move from it.  Besides one panel and `b`, only the number of elements of
+/// each row of the product is held in memory.
+template <MatrixRange A, MatrixRange B, typename Sink,
+          BinaryOperator<grb::matrix_scalar_t<A>, grb::matrix_scalar_t<B>>
+              Combine = grb::multiplies<>,
+          BinaryOperator<grb::combine_result_t<A, B, Combine>,
+                         grb::combine_result_t<A, B, Combine>,
+                         grb::combine_result_t<A, B, Combine>>
+              Reduce = grb::plus<>,
+          MaskMatrixRange M = grb::full_matrix_mask<>>
+void multiply(grb::row_panels panels, A&& a, B&& b, Sink&& sink,
+              Reduce&& reduce = Reduce{}, Combine&& combine = Combine{},
+              M&& mask = grb::full_matrix_mask()) {
+  using c_scalar_type = grb::combine_result_t<A, B, Combine>;
+  using c_index_type =
+      grb::bigger_integral_t<grb::matrix_index_t<A>, grb::matrix_index_t<B>>;
 
-        if constexpr (std::is_same_v<std::decay_t<M>,
-                                     grb::full_matrix_mask<>>) {
-          c[grb::index<c_index_type>(i, j)] =
-              reduce(c[grb::index<c_index_type>(i, j)], combine(a_v, b_v));
-        } else {
-          auto iter = mask.find({i, j});
-          if (iter != mask.end()) {
-            auto&& [_, value] = *iter;
-            if (bool(value)) {
-              c[{i, j}] = reduce(c[{i, j}], combine(a_v, b_v));
-            }
-          }
-        }
-      }
-    }
+  if (a.shape()[1] != b.shape()[0]) {
+    throw grb::invalid_argument(
+        "multiply: Dimensions of matrices are incompatible.");
   }
 
-  return c;
+  grb::detail::trace_scope<> scope("multiply", a, b);
+  scope.mask(mask);
+  scope.flops([&] { return grb::detail::multiply_flops(a, b); });
+
+  auto&& a_csr = __detail::csr_operand<c_index_type>(a);
+  auto&& b_csr = __detail::csr_operand<c_index_type>(b);
+  auto plan = __detail::plan_spgemm<c_scalar_type>(a_csr, b_csr);
+  scope.kernel(__detail::spgemm_strategy_name(plan.strategy));
+
+  __detail::spgemm_panels<c_scalar_type, c_index_type>(
+      a_csr, b_csr, reduce, combine, mask, plan, panels.max_bytes, sink);
 }
 
 template <VectorRange A, VectorRange B,
@@ -139,6 +397,12 @@ auto multiply(A&& a, B&& b, Reduce&& reduce = Reduce{},
                             static_cast<b_value_type>(b_value));
 
       rv = reduce(rv, result);
+
+      if constexpr (grb::has_early_exit_v<Reduce, combine_type>) {
+        if (grb::is_terminal<Reduce>(rv)) {
+          break;
+        }
+      }
     }
   }
   return rv;
@@ -159,6 +423,24 @@ auto multiply(A&& a, B&& b, Reduce&& reduce = Reduce{},
                   std::forward<M>(mask));
 }
 
+/// Multiply a vector times a matrix, allocating the result and temporaries
+/// from `workspace`.
+template <VectorRange A, MatrixRange B,
+          BinaryOperator<grb::vector_scalar_t<A>, grb::matrix_scalar_t<B>>
+              Combine = grb::multiplies<>,
+          BinaryOperator<grb::combine_result_t<A, B, Combine>,
+                         grb::combine_result_t<A, B, Combine>,
+                         grb::combine_result_t<A, B, Combine>>
+              Reduce = grb::plus<>,
+          MaskVectorRange M = grb::full_vector_mask<>>
+auto multiply(grb::workspace& workspace, A&& a, B&& b,
+              Reduce&& reduce = Reduce{}, Combine&& combine = Combine(),
+              M&& mask = M{}) {
+  return multiply(workspace, grb::transpose(std::forward<B>(b)),
+                  std::forward<A>(a), std::forward<Reduce>(reduce),
+                  std::forward<Combine>(combine), std::forward<M>(mask));
+}
+
 namespace {
 
 template <typename C, typename A, typename B, typename Combine, typename Reduce,
@@ -1,83 +1,213 @@
 #pragma once
 
+#include <algorithm>
 #include <grb/containers/matrix.hpp>
+#include <grb/detail/csr_storage.hpp>
+#include <grb/detail/parallel.hpp>
+#include <grb/detail/trace.hpp>
+#include <grb/exceptions/exception.hpp>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace grb {
 
-template <grb::MatrixRange M, std::ranges::random_access_range P>
-  requires(std::integral<std::ranges::range_value_t<P>>)
-auto permute(M&& m, P&& permutation) {
-  using T = grb::matrix_scalar_t<M>;
-  using I = std::ranges::range_value_t<P>;
-  using I2 = grb::matrix_index_t<M>;
-
-  grb::matrix<T, I2> o({permutation.size(), permutation.size()});
-
-  std::vector<std::vector<I>> proj(std::max(m.shape()[0], m.shape()[1]));
+namespace __detail {
 
-  for (std::size_t i = 0; i < proj.size(); i++) {
-    proj[i].push_back({});
+// Inverse of `permutation`, which maps each new index to an old index in
+// `[0, n)`, if it is a bijection onto `[0, n)`.
+template <typename I, typename P>
+std::optional<std::vector<I>> invert_permutation(P&& permutation,
+                                                 std::size_t n) {
+  if (std::size_t(std::ranges::size(permutation)) != n) {
+    return std::nullopt;
   }
 
-  for (std::size_t i = 0; i < permutation.size(); i++) {
-    proj[permutation[i]].push_back(i);
+  std::vector<I> inverse(n, I(n));
+  for (std::size_t i = 0; i < n; i++) {
+    std::size_t old = permutation[i];
+    if (old >= n || inverse[old] != I(n)) {
+      return std::nullopt;
+    }
+    inverse[old] = I(i);
   }
+  return inverse;
+}
 
-  for (auto&& [idx, v] : m) {
-    auto&& [i, j] = idx;
-
-    for (auto&& i_ : proj[i]) {
-      for (auto&& j_ : proj[j]) {
-        o.insert({{I2(i_), I2(j_)}, v});
-      }
+template <typename P>
+void check_permutation(P&& permutation, std::size_t n) {
+  for (auto&& old : permutation) {
+    if (std::size_t(old) >= n) {
+      throw grb::invalid_argument("permute: permutation index " +
+                                  std::to_string(old) +
+                                  " is out of bounds for dimension " +
+                                  std::to_string(n) + ".");
     }
   }
-
-  return o;
 }
 
-template <grb::MatrixRange M, std::ranges::random_access_range R,
-          std::ranges::random_access_range C>
-  requires(std::integral<std::ranges::range_value_t<R>> &&
-           std::integral<std::ranges::range_value_t<C>>)
-auto permute(M&& m, R&& row_permutation, C&& column_permutation) {
-  using T = grb::matrix_scalar_t<M>;
-  using I = std::ranges::range_value_t<R>;
-  using I2 = grb::matrix_index_t<M>;
+// Permute the CSR matrix `a` directly into the CSR matrix `o`: row `i` of
+// `o` is row `row_permutation[i]` of `a`, with each column `j` relabeled
+// to `column_inverse[j]`.  Row lengths are scattered into the new row
+// pointers, then rows are copied, relabeled and sorted in parallel.
+template <typename A, typename O, typename R, typename I>
+void permute_csr(const A& a, O& o, R&& row_permutation,
+                 const std::vector<I>& column_inverse) {
+  using T = std::remove_cvref_t<decltype(*o.values_data())>;
+
+  std::size_t m = std::ranges::size(row_permutation);
+  const I* rowptr = a.rowptr_data();
+  const I* colind = a.colind_data();
+  auto values = a.values_data();
+
+  // Rows past the end of `a`, allowed when permuting a non-square matrix
+  // symmetrically, are empty.
+  auto row_range = [&](std::size_t old) {
+    if (old < std::size_t(a.shape()[0])) {
+      return std::pair<I, I>(rowptr[old], rowptr[old + 1]);
+    } else {
+      return std::pair<I, I>(0, 0);
+    }
+  };
 
-  grb::matrix<T, I2> o({row_permutation.size(), column_permutation.size()});
+  std::size_t nnz = 0;
+  for (std::size_t i = 0; i < m; i++) {
+    auto [begin, end] = row_range(row_permutation[i]);
+    nnz += end - begin;
+  }
 
-  std::vector<std::vector<I>> row_proj(m.shape()[0]);
-  std::vector<std::vector<I>> col_proj(m.shape()[1]);
+  o.resize_storage(nnz);
+  I* o_rowptr = o.rowptr_data();
+  I* o_colind = o.colind_data();
+  T* o_values = o.values_data();
 
-  for (std::size_t i = 0; i < row_proj.size(); i++) {
-    row_proj[i].push_back({});
+  o_rowptr[0] = 0;
+  for (std::size_t i = 0; i < m; i++) {
+    auto [begin, end] = row_range(row_permutation[i]);
+    o_rowptr[i + 1] = o_rowptr[i] + (end - begin);
   }
 
-  for (std::size_t i = 0; i < col_proj.size(); i++) {
-    col_proj[i].push_back({});
-  }
+  std::size_t nthreads = grb::detail::num_threads(nnz);
+  grb::detail::parallel_for(
+      m, nthreads, [&](std::size_t, std::size_t first, std::size_t last) {
+        std::vector<std::pair<I, T>> row;
+        for (std::size_t i = first; i < last; i++) {
+          auto [begin, end] = row_range(row_permutation[i]);
+
+          row.clear();
+          for (I k = begin; k < end; k++) {
+            row.emplace_back(column_inverse[colind[k]], values[k]);
+          }
+          std::sort(row.begin(), row.end(), [](auto&& x, auto&& y) {
+            return x.first < y.first;
+          });
+
+          I dest = o_rowptr[i];
+          for (auto&& [j, v] : row) {
+            o_colind[dest] = j;
+            o_values[dest] = v;
+            ++dest;
+          }
+        }
+      });
+}
 
-  for (std::size_t i = 0; i < row_permutation.size(); i++) {
-    row_proj[row_permutation[i]].push_back(i);
-  }
+// Permute `a` element by element: element (i, j) of `a` appears at each
+// (i', j') with `row_permutation[i'] == i` and `column_permutation[j'] ==
+// j`.  Handles permutations that repeat or drop indices.
+template <typename A, typename O, typename R, typename C>
+void permute_elements(A&& a, O& o, R&& row_permutation,
+                      C&& column_permutation) {
+  using T = grb::matrix_scalar_t<O>;
+  using I = grb::matrix_index_t<O>;
+
+  auto project = [](auto&& permutation, std::size_t n) {
+    std::vector<std::vector<I>> proj(n);
+    for (std::size_t i = 0; i < std::ranges::size(permutation); i++) {
+      proj[permutation[i]].push_back(I(i));
+    }
+    return proj;
+  };
 
-  for (std::size_t i = 0; i < column_permutation.size(); i++) {
-    col_proj[column_permutation[i]].push_back(i);
-  }
+  std::size_t n = std::max(a.shape()[0], a.shape()[1]);
+  auto row_proj = project(row_permutation, n);
+  auto col_proj = project(column_permutation, n);
 
-  for (auto&& [idx, v] : m) {
+  std::vector<grb::matrix_entry<T, I>> entries;
+  for (auto&& [idx, v] : a) {
     auto&& [i, j] = idx;
 
     for (auto&& i_ : row_proj[i]) {
       for (auto&& j_ : col_proj[j]) {
-        o.insert({{I2(i_), I2(j_)}, v});
+        entries.push_back({{i_, j_}, v});
       }
     }
   }
 
+  o.insert(entries.begin(), entries.end());
+}
+
+template <typename M, typename R, typename C>
+auto permute_impl_(M&& m, R&& row_permutation, C&& column_permutation,
+                   std::size_t max_row, std::size_t max_column) {
+  using T = grb::matrix_scalar_t<M>;
+  using I = grb::matrix_index_t<M>;
+
+  check_permutation(row_permutation, max_row);
+  check_permutation(column_permutation, max_column);
+
+  grb::detail::trace_scope<> scope("permute", m);
+
+  grb::matrix<T, I> o({I(std::ranges::size(row_permutation)),
+                       I(std::ranges::size(column_permutation))});
+
+  auto&& m_storage = storage_of(std::as_const(m));
+  auto&& o_storage = storage_of(o);
+
+  if constexpr (CSRStorage<std::remove_cvref_t<decltype(m_storage)>> &&
+                CSRStorage<std::remove_cvref_t<decltype(o_storage)>>) {
+    // Rows may be repeated or dropped, but each column must map to exactly
+    // one new column.
+    auto column_inverse =
+        invert_permutation<I>(column_permutation, m.shape()[1]);
+    if (column_inverse) {
+      scope.kernel("csr");
+      permute_csr(m_storage, o_storage, row_permutation, *column_inverse);
+      scope.output(o);
+      return o;
+    }
+  }
+
+  permute_elements(m, o, row_permutation, column_permutation);
+  scope.output(o);
   return o;
 }
 
+} // namespace __detail
+
+/// Return the matrix `o` with `o[i, j] = m[permutation[i], permutation[j]]`,
+/// of dimension `permutation.size()` x `permutation.size()`.  When `m` is
+/// stored in CSR and `permutation` is a bijection, the result is built
+/// directly in CSR in O(nnz log degree).
+template <grb::MatrixRange M, std::ranges::random_access_range P>
+  requires(std::integral<std::ranges::range_value_t<P>>)
+auto permute(M&& m, P&& permutation) {
+  std::size_t n = std::max(m.shape()[0], m.shape()[1]);
+  return __detail::permute_impl_(std::forward<M>(m), permutation, permutation,
+                                 n, n);
+}
+
+/// Return the matrix `o` with
+/// `o[i, j] = m[row_permutation[i], column_permutation[j]]`.
+template <grb::MatrixRange M, std::ranges::random_access_range R,
+          std::ranges::random_access_range C>
+  requires(std::integral<std::ranges::range_value_t<R>> &&
+           std::integral<std::ranges::range_value_t<C>>)
+auto permute(M&& m, R&& row_permutation, C&& column_permutation) {
+  return __detail::permute_impl_(std::forward<M>(m), row_permutation,
+                                 column_permutation, m.shape()[0],
+                                 m.shape()[1]);
+}
+
 } // namespace grb
@@ -1,31 +1,99 @@
 #pragma once
 
+#include <cstddef>
+#include <grb/algorithms/semiring_kernels.hpp>
+#include <grb/containers/backend/csr_row.hpp>
 #include <grb/containers/views/views.hpp>
 #include <grb/detail/concepts.hpp>
 #include <grb/detail/detail.hpp>
+#include <grb/detail/mask_bitmap.hpp>
+#include <grb/detail/parallel.hpp>
+#include <grb/detail/trace.hpp>
+#include <grb/util/workspace.hpp>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace grb {
 
-template <MatrixRange A,
-          BinaryOperator<grb::matrix_scalar_t<A>, grb::matrix_scalar_t<A>,
-                         grb::matrix_scalar_t<A>>
-              Reduce = grb::plus<>,
-          MaskVectorRange M = grb::full_vector_mask<>>
-auto reduce(A&& a, Reduce&& reduce = Reduce{}, M&& mask = M{}) {
+namespace __detail {
+
+// Row reduction whose result and mask bitmap are allocated with
+// `allocator`.
+template <typename A, typename Reduce, typename M, typename Allocator>
+auto reduce_(A&& a, Reduce&& reduce, M&& mask, const Allocator& allocator) {
   using T = grb::matrix_scalar_t<A>;
   using I = grb::matrix_index_t<A>;
 
-  grb::vector<T, I> v(grb::shape(a)[0]);
+  grb::detail::trace_scope<> scope("reduce", a);
+  scope.mask(mask);
+  scope.flops([&] { return std::size_t(a.size()); });
+
+  grb::vector<T, I, grb::dense, rebind_alloc_t<Allocator, T>> v(
+      grb::shape(a)[0], allocator);
+  grb::detail::vector_mask_bitmap mask_bits(mask, grb::shape(a)[0],
+                                            allocator);
+
+  // Rows of matrices stored as arrays are reduced independently, split by
+  // elements between threads.
+  if constexpr (requires { grb::raw_arrays(std::as_const(a)); }) {
+    auto [shape, rowptr, colind, values] = grb::raw_arrays(std::as_const(a));
+
+    struct row_value {
+      T value;
+      bool present;
+    };
+    std::vector<row_value, rebind_alloc_t<Allocator, row_value>> row_values(
+        shape[0], row_value{T(), false}, allocator);
+    auto parts = partition_rows(rowptr.data(), shape[0],
+                                grb::detail::num_threads(values.size()));
+
+    grb::detail::parallel_invoke(parts.size(), [&](std::size_t t) {
+      auto [first, last] = parts[t];
+      for (std::size_t i = first; i < std::size_t(last); i++) {
+        if (rowptr[i] == rowptr[i + 1] || !mask_bits.test(i)) {
+          continue;
+        }
+
+        T value = values[rowptr[i]];
+        for (auto k = rowptr[i] + 1; k < rowptr[i + 1]; k++) {
+          if constexpr (grb::has_early_exit_v<Reduce, T>) {
+            if (grb::is_terminal<Reduce>(value)) {
+              break;
+            }
+          }
+          value = reduce(T(values[k]), value);
+        }
+        row_values[i] = {value, true};
+      }
+    });
+
+    for (std::size_t i = 0; i < row_values.size(); i++) {
+      if (row_values[i].present) {
+        v.insert({I(i), row_values[i].value});
+      }
+    }
+
+    scope.output(v);
+    return v;
+  }
 
   for (auto&& [idx, a_v] : a) {
     T value = a_v;
     auto&& [row, col] = idx;
 
-    if (mask.find(row) != mask.end()) {
+    if (mask_bits.test(row)) {
       auto iter = v.find(row);
 
       if (iter != v.end()) {
         auto&& [_, v_v] = *iter;
+
+        if constexpr (grb::has_early_exit_v<Reduce, T>) {
+          if (grb::is_terminal<Reduce>(T(v_v))) {
+            continue;
+          }
+        }
+
         value = reduce(value, v_v);
       }
 
@@ -33,7 +101,34 @@ auto reduce(A&& a, Reduce&& reduce = Reduce{}, M&& mask = M{}) {
     }
   }
 
+  scope.output(v);
   return v;
 }
 
+} // namespace __detail
+
+template <MatrixRange A,
+          BinaryOperator<grb::matrix_scalar_t<A>, grb::matrix_scalar_t<A>,
+                         grb::matrix_scalar_t<A>>
+              Reduce = grb::plus<>,
+          MaskVectorRange M = grb::full_vector_mask<>>
+auto reduce(A&& a, Reduce&& reduce = Reduce{}, M&& mask = M{}) {
+  return __detail::reduce_(std::forward<A>(a), std::forward<Reduce>(reduce),
+                           std::forward<M>(mask), grb::allocator<std::byte>());
+}
+
+/// Reduce the rows of `a`, allocating the result from `workspace`.  The
+/// result is valid until `workspace` is reset.
+template <MatrixRange A,
+          BinaryOperator<grb::matrix_scalar_t<A>, grb::matrix_scalar_t<A>,
+                         grb::matrix_scalar_t<A>>
+              Reduce = grb::plus<>,
+          MaskVectorRange M = grb::full_vector_mask<>>
+auto reduce(grb::workspace& workspace, A&& a, Reduce&& reduce = Reduce{},
+            M&& mask = M{}) {
+  return __detail::reduce_(std::forward<A>(a), std::forward<Reduce>(reduce),
+                           std::forward<M>(mask),
+                           grb::workspace_allocator<std::byte>(workspace));
+}
+
 } // namespace grb
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <grb/algorithms/permute.hpp>
+#include <grb/detail/concepts.hpp>
+#include <grb/detail/matrix_traits.hpp>
+#include <grb/exceptions/exception.hpp>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+/// Reverse Cuthill-McKee ordering, which numbers vertices in breadth-first
+/// order from a peripheral vertex, visiting neighbors by increasing degree,
+/// and then reverses the numbering.  Reduces the bandwidth of the matrix.
+struct reverse_cuthill_mckee {};
+
+/// Order vertices by decreasing degree, so that high-degree vertices share
+/// cache lines.
+struct degree_order {};
+
+/// Greedy ordering after Gorder (Wei et al., SIGMOD 2016): each vertex
+/// placed next is the one sharing the most edges and common neighbors with
+/// the last `window` vertices placed.
+struct gorder {
+  std::size_t window = 5;
+};
+
+namespace __detail {
+
+// Symmetrized sparsity pattern of a square matrix, without self loops, in
+// CSR form.
+template <typename I>
+struct adjacency {
+  std::vector<I> rowptr;
+  std::vector<I> colind;
+
+  std::size_t size() const noexcept {
+    return rowptr.size() - 1;
+  }
+
+  std::size_t degree(std::size_t v) const noexcept {
+    return rowptr[v + 1] - rowptr[v];
+  }
+};
+
+template <typename I, typename A>
+adjacency<I> symmetric_adjacency(A&& a) {
+  if (a.shape()[0] != a.shape()[1]) {
+    throw grb::invalid_argument("reorder: matrix must be square.");
+  }
+
+  std::size_t n = a.shape()[0];
+  adjacency<I> adj;
+  adj.rowptr.assign(n + 1, 0);
+
+  for (auto&& [index, _] : a) {
+    auto&& [i, j] = index;
+    if (i != j) {
+      adj.rowptr[i + 1]++;
+      adj.rowptr[j + 1]++;
+    }
+  }
+  for (std::size_t v = 0; v < n; v++) {
+    adj.rowptr[v + 1] += adj.rowptr[v];
+  }
+
+  adj.colind.resize(adj.rowptr[n]);
+  std::vector<I> next(adj.rowptr.begin(), adj.rowptr.end() - 1);
+  for (auto&& [index, _] : a) {
+    auto&& [i, j] = index;
+    if (i != j) {
+      adj.colind[next[i]++] = I(j);
+      adj.colind[next[j]++] = I(i);
+    }
+  }
+
+  // Sort and remove the duplicates created by symmetric elements.
+  I out = 0;
+  I first = 0;
+  for (std::size_t v = 0; v < n; v++) {
+    I last = adj.rowptr[v + 1];
+    std::sort(adj.colind.begin() + first, adj.colind.begin() + last);
+    auto end = std::unique(adj.colind.begin() + first,
+                           adj.colind.begin() + last);
+    out = std::copy(adj.colind.begin() + first, end,
+                    adj.colind.begin() + out) -
+          adj.colind.begin();
+    first = last;
+    adj.rowptr[v + 1] = out;
+  }
+  adj.colind.resize(out);
+
+  return adj;
+}
+
+// Breadth-first search from `root` over unvisited vertices, appending
+// vertices to `order` and visiting neighbors by increasing degree.
+template <typename I>
+void cuthill_mckee_bfs(const adjacency<I>& adj, I root,
+                       std::vector<bool>& visited, std::vector<I>& order) {
+  std::size_t head = order.size();
+  order.push_back(root);
+  visited[root] = true;
+
+  std::vector<I> neighbors;
+  while (head < order.size()) {
+    I v = order[head++];
+
+    neighbors.clear();
+    for (I k = adj.rowptr[v]; k < adj.rowptr[v + 1]; k++) {
+      I u = adj.colind[k];
+      if (!visited[u]) {
+        visited[u] = true;
+        neighbors.push_back(u);
+      }
+    }
+    std::stable_sort(neighbors.begin(), neighbors.end(), [&](I x, I y) {
+      return adj.degree(x) < adj.degree(y);
+    });
+    order.insert(order.end(), neighbors.begin(), neighbors.end());
+  }
+}
+
+// Find a pseudo-peripheral vertex in `root`'s component by repeatedly
+// moving to a minimum-degree vertex of the last breadth-first level while
+// the eccentricity grows.  `level` is scratch space of `adj.size()`
+// elements, all equal to `unvisited`, and is left that way.
+template <typename I>
+I pseudo_peripheral_vertex(const adjacency<I>& adj, I root,
+                           std::vector<I>& level, I unvisited) {
+  std::vector<I> queue;
+  I eccentricity = 0;
+
+  for (std::size_t iteration = 0; iteration < 8; iteration++) {
+    queue.assign(1, root);
+    level[root] = 0;
+
+    for (std::size_t head = 0; head < queue.size(); head++) {
+      I v = queue[head];
+      for (I k = adj.rowptr[v]; k < adj.rowptr[v + 1]; k++) {
+        I u = adj.colind[k];
+        if (level[u] == unvisited) {
+          level[u] = level[v] + 1;
+          queue.push_back(u);
+        }
+      }
+    }
+
+    I last_level = level[queue.back()];
+    I next = queue.back();
+    for (auto&& v : queue) {
+      if (level[v] == last_level && adj.degree(v) < adj.degree(next)) {
+        next = v;
+      }
+      level[v] = unvisited;
+    }
+
+    if (iteration > 0 && last_level <= eccentricity) {
+      break;
+    }
+    eccentricity = last_level;
+    root = next;
+  }
+
+  return root;
+}
+
+template <typename I>
+std::vector<I> ordering(const adjacency<I>& adj, reverse_cuthill_mckee) {
+  std::size_t n = adj.size();
+  std::vector<I> order;
+  order.reserve(n);
+  std::vector<bool> visited(n, false);
+
+  // Start each component from its minimum-degree vertex.
+  std::vector<I> by_degree(n);
+  for (std::size_t v = 0; v < n; v++) {
+    by_degree[v] = I(v);
+  }
+  std::stable_sort(by_degree.begin(), by_degree.end(), [&](I x, I y) {
+    return adj.degree(x) < adj.degree(y);
+  });
+
+  I unvisited = I(n);
+  std::vector<I> level(n, unvisited);
+
+  for (auto&& v : by_degree) {
+    if (!visited[v]) {
+      I root = pseudo_peripheral_vertex(adj, v, level, unvisited);
+      cuthill_mckee_bfs(adj, root, visited, order);
+    }
+  }
+
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+template <typename I>
+std::vector<I> ordering(const adjacency<I>& adj, degree_order) {
+  std::vector<I> order(adj.size());
+  for (std::size_t v = 0; v < order.size(); v++) {
+    order[v] = I(v);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](I x, I y) {
+    return adj.degree(x) > adj.degree(y);
+  });
+  return order;
+}
+
+template <typename I>
+std::vector<I> ordering(const adjacency<I>& adj, gorder method) {
+  std::size_t n = adj.size();
+  std::size_t window = std::max<std::size_t>(method.window, 1);
+
+  // Common neighbors through hubs are ignored, as in Gorder, to bound the
+  // cost of each update.
+  std::size_t hub_degree = std::max<std::size_t>(std::sqrt(double(n)), 16);
+
+  std::vector<long> score(n, 0);
+  std::vector<bool> placed(n, false);
+
+  // Max-heap of (score, degree, vertex), with stale entries skipped when
+  // popped.
+  using entry = std::tuple<long, std::size_t, I>;
+  std::priority_queue<entry> heap;
+  for (std::size_t v = 0; v < n; v++) {
+    heap.emplace(0, adj.degree(v), I(v));
+  }
+
+  // Add `delta` to the score of every unplaced vertex adjacent to `v` or
+  // sharing a neighbor with it.
+  auto update = [&](I v, long delta) {
+    auto bump = [&](I u) {
+      if (!placed[u]) {
+        score[u] += delta;
+        if (delta > 0) {
+          heap.emplace(score[u], adj.degree(u), u);
+        }
+      }
+    };
+    for (I k = adj.rowptr[v]; k < adj.rowptr[v + 1]; k++) {
+      I u = adj.colind[k];
+      bump(u);
+      if (adj.degree(u) <= hub_degree) {
+        for (I l = adj.rowptr[u]; l < adj.rowptr[u + 1]; l++) {
+          if (adj.colind[l] != v) {
+            bump(adj.colind[l]);
+          }
+        }
+      }
+    }
+  };
+
+  std::vector<I> order;
+  order.reserve(n);
+
+  while (order.size() < n) {
+    auto [s, degree, v] = heap.top();
+    heap.pop();
+    if (placed[v]) {
+      continue;
+    }
+    if (s != score[v]) {
+      // Increases push a fresh entry, but decreases do not, so re-queue
+      // entries whose score has dropped.
+      if (s > score[v]) {
+        heap.emplace(score[v], degree, v);
+      }
+      continue;
+    }
+
+    placed[v] = true;
+    order.push_back(v);
+    update(v, 1);
+    if (order.size() > window) {
+      update(order[order.size() - window - 1], -1);
+    }
+  }
+
+  return order;
+}
+
+} // namespace __detail
+
+/// Return a permutation of the vertices of the square matrix `a` that
+/// improves locality, computed by `method`.  `permutation[i]` is the vertex
+/// of `a` placed at position `i`, as taken by `grb::permute`.  Edge
+/// directions are ignored.
+template <MatrixRange A, typename Method = reverse_cuthill_mckee>
+auto reorder_permutation(A&& a, Method method = Method{}) {
+  using I = grb::matrix_index_t<A>;
+  auto adj = __detail::symmetric_adjacency<I>(std::forward<A>(a));
+  return __detail::ordering(adj, method);
+}
+
+/// Reorder the vertices of the square matrix `a` with `method`.  Returns
+/// the pair of the permuted matrix, `grb::permute(a, permutation)`, and
+/// `permutation`, which maps the vertex at position `i` of the result back
+/// to vertex `permutation[i]` of `a`.
+template <MatrixRange A, typename Method = reverse_cuthill_mckee>
+auto reorder(A&& a, Method method = Method{}) {
+  auto permutation = reorder_permutation(a, method);
+  auto b = grb::permute(std::forward<A>(a), permutation);
+  return std::pair(std::move(b), std::move(permutation));
+}
+
+} // namespace grb
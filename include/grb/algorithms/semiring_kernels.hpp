@@ -0,0 +1,301 @@
+#pragma once
+
+#include <cstddef>
+#include <grb/containers/functional/functional.hpp>
+#include <grb/detail/bitmap.hpp>
+#include <grb/detail/concepts.hpp>
+#include <grb/detail/detail.hpp>
+#include <grb/detail/mask_bitmap.hpp>
+#include <grb/detail/memory.hpp>
+#include <grb/detail/monoid_traits.hpp>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+/// Whether the binary operator `Fn` is implemented by `Impl`, for example
+/// `grb::is_op_v<grb::plus<int>, grb::plus_impl_>`.
+template <typename Fn, typename Impl>
+inline constexpr bool is_op_v = requires {
+  requires std::is_same_v<typename std::remove_cvref_t<Fn>::impl_type, Impl>;
+};
+
+/// Hand-tuned matrix-vector multiply kernel for the semiring formed by
+/// `Reduce` and `Combine` on output values of type `T`.
+///
+/// `grb::multiply` uses the kernel whenever `specialized` is `true`, and its
+/// generic implementation otherwise.  To register a kernel, specialize this
+/// template with `specialized = true` and a static member
+/// `multiply(a, b, reduce, combine, mask)` returning the same
+/// `grb::vector<T, I>` as the generic implementation.  Kernels that also
+/// accept an allocator as a sixth argument, and allocate their result and
+/// temporaries with it, are used by the `grb::workspace` overloads of
+/// `grb::multiply`.
+template <typename Reduce, typename Combine, typename T>
+struct semiring_kernel {
+  static constexpr bool specialized = false;
+};
+
+template <typename Reduce, typename Combine, typename T>
+inline constexpr bool has_semiring_kernel_v =
+    semiring_kernel<std::remove_cvref_t<Reduce>, std::remove_cvref_t<Combine>,
+                    T>::specialized;
+
+/// Kernel registered for a semiring object such as `grb::plus_times`.
+template <typename Semiring, typename T>
+using semiring_kernel_t =
+    semiring_kernel<typename Semiring::reduce_type,
+                    typename Semiring::combine_type, T>;
+
+namespace __detail {
+
+template <typename Reduce, typename Combine>
+inline constexpr bool is_dense_semiring_v =
+    (is_op_v<Reduce, plus_impl_> || is_op_v<Reduce, min_impl_> ||
+     is_op_v<Reduce, max_impl_>) &&
+    (is_op_v<Combine, plus_impl_> || is_op_v<Combine, multiplies_impl_>);
+
+template <typename Reduce, typename Combine>
+inline constexpr bool is_lor_land_semiring_v =
+    is_op_v<Reduce, logical_or_impl_> && is_op_v<Combine, logical_and_impl_>;
+
+template <typename Reduce, typename Combine>
+inline constexpr bool is_any_pair_semiring_v =
+    is_any_op_v<Reduce> && is_op_v<Combine, pair_impl_>;
+
+template <typename Allocator, typename T>
+using rebind_alloc_t =
+    typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+// Multiply by accumulating into a dense array of partial results, after
+// copying `b` into a dense array, so that the inner loop is plain
+// array arithmetic with no iterator construction or inserts.  Used for
+// arithmetic semirings such as plus-times, min-plus and max-times.
+struct dense_semiring_kernel {
+  static constexpr bool specialized = true;
+  static constexpr const char* name = "dense_semiring";
+
+  template <MatrixRange A, VectorRange B, typename Reduce, typename Combine,
+            MaskVectorRange M, typename Allocator = grb::allocator<std::byte>>
+  static auto multiply(A&& a, B&& b, Reduce&& reduce, Combine&& combine,
+                       M&& mask, const Allocator& allocator = Allocator()) {
+    using a_scalar_type = grb::matrix_scalar_t<A>;
+    using b_scalar_type = grb::vector_scalar_t<B>;
+    using c_scalar_type = decltype(combine(std::declval<a_scalar_type>(),
+                                           std::declval<b_scalar_type>()));
+    using c_index_type = grb::bigger_integral_t<grb::matrix_index_t<A>,
+                                                grb::vector_index_t<B>>;
+    using reduce_type = std::remove_cvref_t<Reduce>;
+    using c_allocator_type = rebind_alloc_t<Allocator, c_scalar_type>;
+
+    std::vector<b_scalar_type, rebind_alloc_t<Allocator, b_scalar_type>>
+        b_values(b.shape(), b_scalar_type(), allocator);
+    grb::detail::bitmap<Allocator> b_present(b.shape(), false, allocator);
+
+    for (auto&& [k, b_v] : b) {
+      b_values[k] = b_v;
+      b_present.set(k);
+    }
+
+    std::vector<c_scalar_type, c_allocator_type> acc(
+        a.shape()[0],
+        grb::monoid_traits<reduce_type, c_scalar_type>::identity(),
+        allocator);
+    grb::detail::bitmap<Allocator> c_present(a.shape()[0], false, allocator);
+
+    // Rows the mask does not allow are never computed.
+    grb::detail::vector_mask_bitmap mask_bits(mask, a.shape()[0], allocator);
+
+    if constexpr (requires { grb::raw_arrays(std::as_const(a)); }) {
+      auto [shape, rowptr, colind, values] =
+          grb::raw_arrays(std::as_const(a));
+
+      for (std::size_t i = 0; i < std::size_t(shape[0]); i++) {
+        if (!mask_bits.test(i)) {
+          continue;
+        }
+
+        c_scalar_type acc_i = acc[i];
+        bool present = false;
+
+        for (auto k = rowptr[i]; k < rowptr[i + 1]; k++) {
+          if (!b_present.test(colind[k])) {
+            continue;
+          }
+
+          acc_i = reduce(acc_i, combine(values[k], b_values[colind[k]]));
+          present = true;
+
+          if constexpr (grb::has_early_exit_v<reduce_type, c_scalar_type>) {
+            if (grb::is_terminal<reduce_type>(acc_i)) {
+              break;
+            }
+          }
+        }
+
+        if (present) {
+          acc[i] = acc_i;
+          c_present.set(i);
+        }
+      }
+    } else {
+      for (auto&& [a_index, a_v] : a) {
+        auto&& [i, k] = a_index;
+
+        if (!b_present.test(k) || !mask_bits.test(i)) {
+          continue;
+        }
+
+        if constexpr (grb::has_early_exit_v<reduce_type, c_scalar_type>) {
+          if (c_present.test(i) && grb::is_terminal<reduce_type>(acc[i])) {
+            continue;
+          }
+        }
+
+        acc[i] = reduce(acc[i], combine(a_v, b_values[k]));
+        c_present.set(i);
+      }
+    }
+
+    grb::vector<c_scalar_type, c_index_type, grb::dense, c_allocator_type> c(
+        a.shape()[0], allocator);
+
+    for (std::size_t i = c_present.find_next(0); i < c_present.size();
+         i = c_present.find_next(i + 1)) {
+      c.insert({c_index_type(i), acc[i]});
+    }
+
+    return c;
+  }
+};
+
+// Multiply boolean or-and and any-pair semirings with bitmaps: each output
+// row is a single bit, and rows stop accumulating as soon as they are
+// true.
+template <bool Valued>
+struct bitmap_semiring_kernel {
+  static constexpr bool specialized = true;
+  static constexpr const char* name = "bitmap_semiring";
+
+  // Each row's value follows from the bitmaps alone, so `reduce` and
+  // `combine` are never called.
+  template <MatrixRange A, VectorRange B, typename Reduce, typename Combine,
+            MaskVectorRange M, typename Allocator = grb::allocator<std::byte>>
+  static auto multiply(A&& a, B&& b, Reduce&&, Combine&&, M&& mask,
+                       const Allocator& allocator = Allocator()) {
+    using a_scalar_type = grb::matrix_scalar_t<A>;
+    using b_scalar_type = grb::vector_scalar_t<B>;
+    using c_scalar_type = std::invoke_result_t<Combine&, a_scalar_type,
+                                               b_scalar_type>;
+    using c_index_type = grb::bigger_integral_t<grb::matrix_index_t<A>,
+                                                grb::vector_index_t<B>>;
+
+    using c_allocator_type = rebind_alloc_t<Allocator, c_scalar_type>;
+
+    grb::detail::bitmap<Allocator> b_present(b.shape(), false, allocator);
+    grb::detail::bitmap<Allocator> b_true(b.shape(), false, allocator);
+
+    for (auto&& [k, b_v] : b) {
+      b_present.set(k);
+      if constexpr (Valued) {
+        b_true.assign(k, bool(b_v));
+      }
+    }
+
+    grb::detail::bitmap<Allocator> c_present(a.shape()[0], false, allocator);
+    grb::detail::bitmap<Allocator> c_true(a.shape()[0], false, allocator);
+
+    // Rows the mask does not allow are never computed.
+    grb::detail::vector_mask_bitmap mask_bits(mask, a.shape()[0], allocator);
+
+    if constexpr (requires { grb::raw_arrays(std::as_const(a)); }) {
+      auto [shape, rowptr, colind, values] =
+          grb::raw_arrays(std::as_const(a));
+
+      for (std::size_t i = 0; i < std::size_t(shape[0]); i++) {
+        if (!mask_bits.test(i)) {
+          continue;
+        }
+
+        for (auto k = rowptr[i]; k < rowptr[i + 1]; k++) {
+          if (b_present.test(colind[k])) {
+            c_present.set(i);
+            if constexpr (Valued) {
+              if (bool(values[k]) && b_true.test(colind[k])) {
+                c_true.set(i);
+                break;
+              }
+            } else {
+              break;
+            }
+          }
+        }
+      }
+    } else {
+      for (auto&& [a_index, a_v] : a) {
+        auto&& [i, k] = a_index;
+
+        if (!mask_bits.test(i)) {
+          continue;
+        }
+
+        if constexpr (Valued) {
+          if (c_true.test(i)) {
+            continue;
+          }
+        } else {
+          if (c_present.test(i)) {
+            continue;
+          }
+        }
+
+        if (b_present.test(k)) {
+          c_present.set(i);
+          if constexpr (Valued) {
+            if (bool(a_v) && b_true.test(k)) {
+              c_true.set(i);
+            }
+          }
+        }
+      }
+    }
+
+    grb::vector<c_scalar_type, c_index_type, grb::dense, c_allocator_type> c(
+        a.shape()[0], allocator);
+
+    for (std::size_t i = c_present.find_next(0); i < c_present.size();
+         i = c_present.find_next(i + 1)) {
+      if constexpr (Valued) {
+        c.insert({c_index_type(i), c_scalar_type(c_true.test(i))});
+      } else {
+        c.insert({c_index_type(i), c_scalar_type(1)});
+      }
+    }
+
+    return c;
+  }
+};
+
+} // namespace __detail
+
+template <typename Reduce, typename Combine, typename T>
+  requires(std::is_arithmetic_v<T> && grb::is_monoid_v<Reduce, T> &&
+           __detail::is_dense_semiring_v<Reduce, Combine>)
+struct semiring_kernel<Reduce, Combine, T>
+    : __detail::dense_semiring_kernel {};
+
+template <typename Reduce, typename Combine, typename T>
+  requires(std::is_arithmetic_v<T> &&
+           __detail::is_lor_land_semiring_v<Reduce, Combine>)
+struct semiring_kernel<Reduce, Combine, T>
+    : __detail::bitmap_semiring_kernel<true> {};
+
+template <typename Reduce, typename Combine, typename T>
+  requires(std::is_arithmetic_v<T> &&
+           __detail::is_any_pair_semiring_v<Reduce, Combine>)
+struct semiring_kernel<Reduce, Combine, T>
+    : __detail::bitmap_semiring_kernel<false> {};
+
+} // namespace grb
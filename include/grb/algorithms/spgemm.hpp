@@ -0,0 +1,466 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <grb/containers/matrix.hpp>
+#include <grb/detail/cpos.hpp>
+#include <grb/detail/csr_storage.hpp>
+#include <grb/detail/mask_bitmap.hpp>
+#include <grb/detail/mask_traits.hpp>
+#include <grb/detail/matrix_traits.hpp>
+#include <grb/detail/memory.hpp>
+#include <grb/detail/monoid_traits.hpp>
+#include <grb/detail/parallel.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+namespace __detail {
+
+// How a row-wise SpGEMM accumulates the products of each row of C.
+enum class spgemm_strategy {
+  // Scatter the products into a dense array of `n` partial results per
+  // thread.  Fastest, but each thread needs O(n) scratch memory.
+  dense_accumulator,
+
+  // Collect the products of a row and sort them by column.  Each thread
+  // needs scratch memory proportional to the products of the largest row.
+  sort_accumulator
+};
+
+inline const char* spgemm_strategy_name(spgemm_strategy strategy) {
+  return strategy == spgemm_strategy::dense_accumulator ? "dense_accumulator"
+                                                        : "sort_accumulator";
+}
+
+// The memory plan of a row-wise SpGEMM.
+struct spgemm_plan {
+  spgemm_strategy strategy = spgemm_strategy::dense_accumulator;
+  std::size_t nthreads = 1;
+
+  // `row_products[i]` is the number of products of rows `[0, i)`, used to
+  // split rows between threads by work.
+  std::vector<std::size_t> row_products;
+  std::size_t max_row_products = 0;
+
+  // Scratch memory of all threads, in bytes.
+  std::size_t scratch_bytes = 0;
+};
+
+// Scratch bytes per thread of `strategy` for an output with `n` columns,
+// values of type `T` and index type `I`.
+template <typename T, typename I>
+std::size_t spgemm_thread_bytes(spgemm_strategy strategy, std::size_t n,
+                                std::size_t max_row_products) {
+  std::size_t row_nnz = std::min(n, max_row_products);
+  if (strategy == spgemm_strategy::dense_accumulator) {
+    return n * (sizeof(T) + sizeof(std::size_t)) + row_nnz * sizeof(I);
+  } else {
+    return max_row_products * sizeof(std::pair<I, T>);
+  }
+}
+
+// Choose for `plan` the fastest of `preferred` strategies whose scratch
+// memory for one thread fits in `available` bytes, with as many threads, up
+// to `wanted`, as fit, for an output with `n` columns and rows of at most
+// `plan.max_row_products` products.  Returns the scratch bytes of one thread
+// of the cheapest strategy if none fits, and 0 otherwise.
+template <typename T, typename I>
+std::size_t choose_spgemm_strategy(spgemm_plan& plan,
+                                   const spgemm_strategy (&preferred)[2],
+                                   std::size_t n, std::size_t wanted,
+                                   std::size_t available) {
+  std::size_t min_bytes = grb::unlimited_memory;
+  for (auto strategy : preferred) {
+    std::size_t thread_bytes = std::max<std::size_t>(
+        spgemm_thread_bytes<T, I>(strategy, n, plan.max_row_products), 1);
+    min_bytes = std::min(min_bytes, thread_bytes);
+    if (available / thread_bytes >= 1) {
+      plan.strategy = strategy;
+      plan.nthreads = std::min(wanted, available / thread_bytes);
+      plan.scratch_bytes = plan.nthreads * thread_bytes;
+      return 0;
+    }
+  }
+  return min_bytes;
+}
+
+// The strategies to try for `products` products into `n` columns, fastest
+// first.  The dense accumulator is initialized once per thread, which only
+// pays off when there are at least as many products as columns.
+inline void spgemm_preferred(spgemm_strategy (&preferred)[2], std::size_t n,
+                             std::size_t products) {
+  preferred[0] = spgemm_strategy::dense_accumulator;
+  preferred[1] = spgemm_strategy::sort_accumulator;
+  if (n > products) {
+    std::swap(preferred[0], preferred[1]);
+  }
+}
+
+// Plan the product of the CSR matrices `a` and `b` into values of type `T`:
+// count the products of each row, then choose the fastest strategy whose
+// scratch memory, for at least one thread, fits in the memory budget, and
+// as many threads as fit.  Throws `grb::out_of_memory` if no strategy fits.
+template <typename T, typename A, typename B>
+spgemm_plan plan_spgemm(const A& a, const B& b) {
+  using I = std::remove_cvref_t<decltype(*a.rowptr_data())>;
+
+  std::size_t m = a.shape()[0];
+  std::size_t n = b.shape()[1];
+  const I* a_rowptr = a.rowptr_data();
+  const I* a_colind = a.colind_data();
+  const I* b_rowptr = b.rowptr_data();
+
+  spgemm_plan plan;
+  plan.row_products.resize(m + 1);
+  plan.row_products[0] = 0;
+  for (std::size_t i = 0; i < m; i++) {
+    std::size_t products = 0;
+    for (I k = a_rowptr[i]; k < a_rowptr[i + 1]; k++) {
+      products += b_rowptr[a_colind[k] + 1] - b_rowptr[a_colind[k]];
+    }
+    plan.row_products[i + 1] = plan.row_products[i] + products;
+    plan.max_row_products = std::max(plan.max_row_products, products);
+  }
+  std::size_t products = plan.row_products[m];
+
+  spgemm_strategy preferred[2];
+  spgemm_preferred(preferred, n, products);
+
+  std::size_t rowptr_bytes = (m + 1) * sizeof(I);
+  std::size_t available = grb::detail::available_memory();
+  std::size_t wanted = std::clamp<std::size_t>(
+      grb::detail::num_threads(products), 1, std::max<std::size_t>(m, 1));
+
+  if (available >= rowptr_bytes) {
+    std::size_t min_bytes = choose_spgemm_strategy<T, I>(
+        plan, preferred, n, wanted, available - rowptr_bytes);
+    if (min_bytes != 0) {
+      grb::detail::require_memory(rowptr_bytes + min_bytes, "multiply");
+    }
+  } else {
+    grb::detail::require_memory(rowptr_bytes, "multiply");
+  }
+  return plan;
+}
+
+// One pass of a row-wise SpGEMM over rows `[first, last)` of the product of
+// the CSR matrices `a` and `b`, split between `plan.nthreads` threads by
+// their products.  Row `i` of the product is row `i - first` of the CSR
+// arrays `rowptr`, `colind` and `values`.  With `Numeric`, the elements of
+// each row are written from `rowptr[i - first]` on, in order of columns;
+// otherwise they are only counted into `rowptr[i - first + 1]`.  Only
+// elements allowed by `mask` are kept.  The products of each element are
+// reduced in the order of `a`'s columns, starting from the first.
+template <bool Numeric, typename A, typename B, typename Reduce,
+          typename Combine, typename M, typename I, typename T>
+void spgemm_pass(const A& a, const B& b, Reduce&& reduce, Combine&& combine,
+                 M&& mask, const spgemm_plan& plan, std::size_t first,
+                 std::size_t last, I* rowptr, I* colind, T* values) {
+  std::size_t n = b.shape()[1];
+  const I* a_rowptr = a.rowptr_data();
+  const I* a_colind = a.colind_data();
+  auto a_values = a.values_data();
+  const I* b_rowptr = b.rowptr_data();
+  const I* b_colind = b.colind_data();
+  auto b_values = b.values_data();
+
+  std::size_t nthreads = plan.nthreads;
+  std::vector<std::size_t> row_first(nthreads + 1);
+  std::size_t first_products = plan.row_products[first];
+  std::size_t products = plan.row_products[last] - first_products;
+  for (std::size_t t = 0; t < nthreads; t++) {
+    std::size_t target = first_products + products * t / nthreads;
+    row_first[t] = std::lower_bound(plan.row_products.begin() + first,
+                                    plan.row_products.begin() + last,
+                                    target) -
+                   plan.row_products.begin();
+  }
+  row_first[nthreads] = last;
+
+  auto allows = [&](std::size_t i, std::size_t j) {
+    if constexpr (grb::is_full_mask_v<M>) {
+      return true;
+    } else {
+      return grb::detail::matrix_mask_allows(mask, {I(i), I(j)});
+    }
+  };
+
+  auto accumulate = [&](T& acc, const T& product) {
+    if constexpr (grb::has_early_exit_v<Reduce, T>) {
+      if (grb::is_terminal<Reduce>(acc)) {
+        return;
+      }
+    }
+    acc = reduce(acc, product);
+  };
+
+  // Thread `t` computes rows `[row_first[t], row_first[t + 1])`.
+  auto multiply_rows = [&](std::size_t t) {
+    if (plan.strategy == spgemm_strategy::dense_accumulator) {
+      // `stamp[j]` is `2 * i + 2` once row `i` has an allowed element in
+      // column `j`, and `2 * i + 3` once it has a masked-out one.
+      std::vector<std::size_t, grb::allocator<std::size_t>> stamp(n, 0);
+      std::vector<T, grb::allocator<T>> acc(Numeric ? n : 0);
+      std::vector<I, grb::allocator<I>> columns;
+      columns.reserve(std::min(n, plan.max_row_products));
+
+      for (std::size_t i = row_first[t]; i < row_first[t + 1]; i++) {
+        columns.clear();
+        for (I ak = a_rowptr[i]; ak < a_rowptr[i + 1]; ak++) {
+          I k = a_colind[ak];
+          for (I bk = b_rowptr[k]; bk < b_rowptr[k + 1]; bk++) {
+            I j = b_colind[bk];
+            if (stamp[j] == 2 * i + 3) {
+              continue;
+            }
+            if (stamp[j] != 2 * i + 2) {
+              if (!allows(i, j)) {
+                stamp[j] = 2 * i + 3;
+                continue;
+              }
+              stamp[j] = 2 * i + 2;
+              columns.push_back(j);
+              if constexpr (Numeric) {
+                acc[j] = combine(a_values[ak], b_values[bk]);
+              }
+            } else if constexpr (Numeric) {
+              accumulate(acc[j], combine(a_values[ak], b_values[bk]));
+            }
+          }
+        }
+
+        if constexpr (Numeric) {
+          std::sort(columns.begin(), columns.end());
+          I dest = rowptr[i - first];
+          for (auto&& j : columns) {
+            colind[dest] = j;
+            values[dest] = acc[j];
+            dest++;
+          }
+        } else {
+          rowptr[i - first + 1] = I(columns.size());
+        }
+      }
+    } else {
+      std::vector<std::pair<I, T>, grb::allocator<std::pair<I, T>>> products;
+      products.reserve(plan.max_row_products);
+
+      for (std::size_t i = row_first[t]; i < row_first[t + 1]; i++) {
+        products.clear();
+        for (I ak = a_rowptr[i]; ak < a_rowptr[i + 1]; ak++) {
+          I k = a_colind[ak];
+          for (I bk = b_rowptr[k]; bk < b_rowptr[k + 1]; bk++) {
+            if constexpr (Numeric) {
+              products.emplace_back(b_colind[bk],
+                                    combine(a_values[ak], b_values[bk]));
+            } else {
+              products.emplace_back(b_colind[bk], T());
+            }
+          }
+        }
+
+        // A stable sort keeps each column's products in the order of a's
+        // columns.
+        std::stable_sort(
+            products.begin(), products.end(),
+            [](auto&& x, auto&& y) { return x.first < y.first; });
+
+        I dest = Numeric ? rowptr[i - first] : I(0);
+        for (std::size_t p = 0; p < products.size();) {
+          std::size_t q = p + 1;
+          while (q < products.size() &&
+                 products[q].first == products[p].first) {
+            q++;
+          }
+          if (allows(i, products[p].first)) {
+            if constexpr (Numeric) {
+              T value = products[p].second;
+              for (std::size_t r = p + 1; r < q; r++) {
+                accumulate(value, products[r].second);
+              }
+              colind[dest] = products[p].first;
+              values[dest] = value;
+            }
+            dest++;
+          }
+          p = q;
+        }
+
+        if constexpr (!Numeric) {
+          rowptr[i - first + 1] = dest;
+        }
+      }
+    }
+  };
+
+  grb::detail::parallel_invoke(nthreads, multiply_rows);
+}
+
+// Number of row batches of a SpGEMM whose output and planned scratch memory
+// do not fit in the memory budget together.
+inline constexpr std::size_t spgemm_row_batches = 16;
+
+// Compute the product of the CSR matrices `a` and `b` over the semiring
+// (`reduce`, `combine`) into the CSR storage `c`, of shape `a.shape()[0]` x
+// `b.shape()[1]`, following `plan`.  Only elements allowed by `mask` are
+// stored.  A symbolic pass counts the elements of each row first, so that
+// `c` is allocated once at its exact size.  The output and the scratch
+// memory of the numeric pass are live together, so their sum is checked
+// against the memory budget before allocating.  If it does not fit, the
+// numeric pass runs over batches of rows with equal products, each planned
+// for its own largest row in the memory left beside the output, and `plan`
+// is left holding the plan of the last batch.  Throws `grb::out_of_memory`
+// if the output and one thread of some batch do not fit.
+template <typename A, typename B, typename C, typename Reduce,
+          typename Combine, typename M>
+void spgemm_csr(const A& a, const B& b, C& c, Reduce&& reduce,
+                Combine&& combine, M&& mask, spgemm_plan& plan) {
+  using T = typename C::scalar_type;
+  using I = typename C::index_type;
+
+  std::size_t m = a.shape()[0];
+  std::size_t n = b.shape()[1];
+  I* rowptr = c.rowptr_data();
+  rowptr[0] = 0;
+  spgemm_pass<false>(a, b, reduce, combine, mask, plan, 0, m, rowptr,
+                     static_cast<I*>(nullptr), static_cast<T*>(nullptr));
+  for (std::size_t i = 0; i < m; i++) {
+    rowptr[i + 1] += rowptr[i];
+  }
+
+  std::size_t nnz = rowptr[m];
+  std::size_t output_bytes = nnz * (sizeof(I) + sizeof(T));
+  std::size_t available = grb::detail::available_memory();
+  if (output_bytes <= available &&
+      plan.scratch_bytes <= available - output_bytes) {
+    c.resize_storage(nnz);
+    spgemm_pass<true>(a, b, reduce, combine, mask, plan, 0, m,
+                      c.rowptr_data(), c.colind_data(), c.values_data());
+    return;
+  }
+
+  // Split the rows into batches of equal products, and find the scratch
+  // memory of one thread of the cheapest strategy for each batch.
+  std::size_t products = plan.row_products[m];
+  std::vector<std::size_t> batch_first(spgemm_row_batches + 1, m);
+  std::vector<std::size_t> batch_max(spgemm_row_batches, 0);
+  std::size_t peak_bytes = 0;
+  for (std::size_t k = 0; k < spgemm_row_batches; k++) {
+    batch_first[k] = std::lower_bound(plan.row_products.begin(),
+                                      plan.row_products.begin() + m,
+                                      products * k / spgemm_row_batches) -
+                     plan.row_products.begin();
+  }
+  for (std::size_t k = 0; k < spgemm_row_batches; k++) {
+    for (std::size_t i = batch_first[k]; i < batch_first[k + 1]; i++) {
+      batch_max[k] = std::max(batch_max[k], plan.row_products[i + 1] -
+                                                plan.row_products[i]);
+    }
+    std::size_t min_bytes = grb::unlimited_memory;
+    for (auto strategy : {spgemm_strategy::dense_accumulator,
+                          spgemm_strategy::sort_accumulator}) {
+      min_bytes = std::min(min_bytes,
+                           std::max<std::size_t>(spgemm_thread_bytes<T, I>(
+                                                     strategy, n, batch_max[k]),
+                                                 1));
+    }
+    peak_bytes = std::max(peak_bytes, min_bytes);
+  }
+  grb::detail::require_memory(output_bytes + peak_bytes, "multiply");
+  c.resize_storage(nnz);
+
+  for (std::size_t k = 0; k < spgemm_row_batches; k++) {
+    std::size_t first = batch_first[k];
+    std::size_t last = batch_first[k + 1];
+    if (first == last) {
+      continue;
+    }
+
+    std::size_t batch_products =
+        plan.row_products[last] - plan.row_products[first];
+    spgemm_strategy preferred[2];
+    spgemm_preferred(preferred, n, batch_products);
+    std::size_t wanted = std::clamp<std::size_t>(
+        grb::detail::num_threads(batch_products), 1, last - first);
+    plan.max_row_products = batch_max[k];
+    std::size_t min_bytes = choose_spgemm_strategy<T, I>(
+        plan, preferred, n, wanted, grb::detail::available_memory());
+    if (min_bytes != 0) {
+      grb::detail::require_memory(min_bytes, "multiply");
+    }
+
+    spgemm_pass<true>(a, b, reduce, combine, mask, plan, first, last,
+                      c.rowptr_data() + first, c.colind_data(),
+                      c.values_data());
+  }
+}
+
+// Compute the product of the CSR matrices `a` and `b` like `spgemm_csr`, but
+// one panel of consecutive rows at a time, calling `sink(first, panel)` with
+// each panel as a `grb::matrix<T, I>` holding rows `[first, first +
+// panel.shape()[0])` of the product.  Panels are as tall as fits in
+// `max_bytes` of CSR storage, and at least one row.  Besides one panel, only
+// the element count of each row is kept.
+template <typename T, typename I, typename A, typename B, typename Reduce,
+          typename Combine, typename M, typename Sink>
+void spgemm_panels(const A& a, const B& b, Reduce&& reduce, Combine&& combine,
+                   M&& mask, const spgemm_plan& plan, std::size_t max_bytes,
+                   Sink&& sink) {
+  std::size_t m = a.shape()[0];
+  std::size_t n = b.shape()[1];
+
+  std::vector<I, grb::allocator<I>> counts(m + 1, 0);
+  spgemm_pass<false>(a, b, reduce, combine, mask, plan, 0, m, counts.data(),
+                     static_cast<I*>(nullptr), static_cast<T*>(nullptr));
+
+  auto row_bytes = [&](std::size_t i) {
+    return sizeof(I) + std::size_t(counts[i + 1]) * (sizeof(I) + sizeof(T));
+  };
+
+  for (std::size_t first = 0; first < m;) {
+    std::size_t last = first + 1;
+    std::size_t bytes = sizeof(I) + row_bytes(first);
+    while (last < m && bytes + row_bytes(last) <= max_bytes) {
+      bytes += row_bytes(last);
+      last++;
+    }
+
+    // The panel and the scratch memory of the numeric pass are live
+    // together.
+    grb::detail::require_memory(bytes + plan.scratch_bytes, "multiply");
+    grb::matrix<T, I> panel(grb::index<I>(last - first, n));
+    auto&& csr = storage_of(panel);
+    I* rowptr = csr.rowptr_data();
+    rowptr[0] = 0;
+    for (std::size_t i = first; i < last; i++) {
+      rowptr[i - first + 1] = rowptr[i - first] + counts[i + 1];
+    }
+    csr.resize_storage(rowptr[last - first]);
+
+    spgemm_pass<true>(a, b, reduce, combine, mask, plan, first, last,
+                      csr.rowptr_data(), csr.colind_data(), csr.values_data());
+    sink(first, panel);
+    first = last;
+  }
+}
+
+// The CSR arrays of the matrix `x`, borrowed if `x` keeps its elements in
+// CSR arrays with index type `I`, as CSR-backed matrices and
+// `csr_matrix_view`s over external buffers do, and otherwise copied.
+template <typename I, typename X>
+decltype(auto) csr_operand(X&& x) {
+  auto&& storage = storage_of(std::as_const(x));
+  if constexpr (requires { grb::raw_arrays(storage); } &&
+                std::is_same_v<grb::matrix_index_t<X>, I>) {
+    return std::as_const(storage);
+  } else {
+    return csr_from_elements<grb::matrix_scalar_t<X>, I>(x);
+  }
+}
+
+} // namespace __detail
+
+} // namespace grb
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <grb/containers/matrix.hpp>
+#include <grb/detail/concepts.hpp>
+#include <grb/detail/csr_storage.hpp>
+#include <grb/detail/matrix_traits.hpp>
+#include <grb/detail/parallel.hpp>
+#include <grb/detail/trace.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+namespace __detail {
+
+template <typename A>
+struct transpose_result {
+  using type = grb::matrix<grb::matrix_scalar_t<A>, grb::matrix_index_t<A>>;
+};
+
+template <typename T, typename I, typename Hint, typename Allocator>
+struct transpose_result<grb::matrix<T, I, Hint, Allocator>> {
+  using type = grb::matrix<T, I, Hint, Allocator>;
+};
+
+// Transpose the `m` x `n` CSR matrix (`rowptr`, `colind`, `values`) into
+// the CSR arrays of its `n` x `m` transpose with a counting sort by column.
+// Each thread counts and then scatters the columns of a block of rows, so
+// that rows stay sorted within each column of the result.
+template <typename T, typename I, typename U>
+void transpose_csr(std::size_t m, std::size_t n, const I* rowptr,
+                   const I* colind, const T* values, I* t_rowptr, I* t_colind,
+                   U* t_values) {
+  std::size_t nnz = rowptr[m];
+  std::size_t nthreads =
+      std::min(grb::detail::num_threads(nnz), std::max<std::size_t>(m, 1));
+
+  // Rows [row_first[t], row_first[t + 1]) go to thread `t`, balanced by
+  // number of elements.
+  std::vector<std::size_t> row_first(nthreads + 1);
+  for (std::size_t t = 0; t <= nthreads; t++) {
+    std::size_t target = nnz * t / nthreads;
+    row_first[t] = std::lower_bound(rowptr, rowptr + m, I(target)) - rowptr;
+  }
+  row_first[nthreads] = m;
+
+  // offsets[t][j] counts, then locates, thread t's elements in column j.
+  std::vector<std::vector<I>> offsets(nthreads);
+
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    offsets[t].assign(n, 0);
+    for (std::size_t i = row_first[t]; i < row_first[t + 1]; i++) {
+      for (I k = rowptr[i]; k < rowptr[i + 1]; k++) {
+        offsets[t][colind[k]]++;
+      }
+    }
+  });
+
+  grb::detail::parallel_for(
+      n, nthreads, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t j = first; j < last; j++) {
+          I count = 0;
+          for (std::size_t t = 0; t < nthreads; t++) {
+            I thread_count = offsets[t][j];
+            offsets[t][j] = count;
+            count += thread_count;
+          }
+          t_rowptr[j + 1] = count;
+        }
+      });
+
+  t_rowptr[0] = 0;
+  for (std::size_t j = 0; j < n; j++) {
+    t_rowptr[j + 1] += t_rowptr[j];
+  }
+
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    auto&& offset = offsets[t];
+    for (std::size_t i = row_first[t]; i < row_first[t + 1]; i++) {
+      for (I k = rowptr[i]; k < rowptr[i + 1]; k++) {
+        I j = colind[k];
+        I dest = t_rowptr[j] + offset[j]++;
+        t_colind[dest] = I(i);
+        t_values[dest] = values[k];
+      }
+    }
+  });
+}
+
+} // namespace __detail
+
+/// Return a new matrix holding the transpose of `a`.  Unlike
+/// `grb::transpose`, which returns a view that swaps indices, the result
+/// stores Aᵀ in its own backend, so its rows can be read directly.  When
+/// both `a` and the result are stored in CSR, the transpose is computed with
+/// a parallel counting sort, reading `a`'s arrays in place; this includes a
+/// `csr_matrix_view` over external arrays.
+template <MatrixRange A>
+auto transpose_materialize(A&& a) {
+  using result_type =
+      typename __detail::transpose_result<std::remove_cvref_t<A>>::type;
+  using T = typename result_type::scalar_type;
+  using I = typename result_type::index_type;
+
+  grb::detail::trace_scope<> scope("transpose", a);
+
+  result_type t({I(a.shape()[1]), I(a.shape()[0])});
+
+  auto&& a_storage = __detail::storage_of(std::as_const(a));
+  auto&& t_storage = __detail::storage_of(t);
+
+  using t_storage_type = std::remove_cvref_t<decltype(t_storage)>;
+
+  if constexpr (__detail::CSRStorage<t_storage_type> &&
+                requires { grb::raw_arrays(a_storage); } &&
+                std::is_same_v<grb::matrix_index_t<A>, I>) {
+    scope.kernel("csr");
+    t_storage.resize_storage(a.size());
+    __detail::transpose_csr(
+        a.shape()[0], a.shape()[1], a_storage.rowptr_data(),
+        a_storage.colind_data(), a_storage.values_data(),
+        t_storage.rowptr_data(), t_storage.colind_data(),
+        t_storage.values_data());
+  } else if constexpr (__detail::CSRStorage<t_storage_type>) {
+    // Counting sort by column straight from `a`'s elements.
+    scope.kernel("counting_sort");
+    std::size_t n = a.shape()[1];
+    t_storage.resize_storage(a.size());
+    I* t_rowptr = t_storage.rowptr_data();
+    std::fill(t_rowptr, t_rowptr + n + 1, I(0));
+
+    for (auto&& [index, _] : a) {
+      auto&& [i, j] = index;
+      t_rowptr[j + 1]++;
+    }
+    for (std::size_t j = 0; j < n; j++) {
+      t_rowptr[j + 1] += t_rowptr[j];
+    }
+
+    std::vector<I> next(t_rowptr, t_rowptr + n);
+    for (auto&& [index, value] : a) {
+      auto&& [i, j] = index;
+      I dest = next[j]++;
+      t_storage.colind_data()[dest] = I(i);
+      t_storage.values_data()[dest] = value;
+    }
+
+    // Backends that do not iterate in row order may leave the rows of the
+    // result unsorted.
+    for (std::size_t j = 0; j < n; j++) {
+      I* first = t_storage.colind_data() + t_rowptr[j];
+      I* last = t_storage.colind_data() + t_rowptr[j + 1];
+      if (!std::is_sorted(first, last)) {
+        std::vector<std::pair<I, T>> row;
+        for (I k = t_rowptr[j]; k < t_rowptr[j + 1]; k++) {
+          row.emplace_back(t_storage.colind_data()[k],
+                           t_storage.values_data()[k]);
+        }
+        std::sort(row.begin(), row.end(), [](auto&& x, auto&& y) {
+          return x.first < y.first;
+        });
+        for (std::size_t k = 0; k < row.size(); k++) {
+          t_storage.colind_data()[t_rowptr[j] + k] = row[k].first;
+          t_storage.values_data()[t_rowptr[j] + k] = row[k].second;
+        }
+      }
+    }
+  } else {
+    std::vector<grb::matrix_entry<T, I>> entries;
+    entries.reserve(a.size());
+    for (auto&& [index, value] : a) {
+      auto&& [i, j] = index;
+      entries.push_back({{I(j), I(i)}, value});
+    }
+    t.insert(entries.begin(), entries.end());
+  }
+
+  scope.output(t);
+  return t;
+}
+
+} // namespace grb
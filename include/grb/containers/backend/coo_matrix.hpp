@@ -3,10 +3,11 @@
 #include <algorithm>
 #include <vector>
 #include <grb/containers/matrix_entry.hpp>
+#include <grb/detail/memory.hpp>
 
 namespace grb {
 
-template <typename T, typename I, typename Allocator = std::allocator<T>>
+template <typename T, typename I, typename Allocator = grb::allocator<T>>
 class coo_matrix {
 public:
   using value_type = grb::matrix_entry<T, I>;
@@ -34,6 +35,12 @@ public:
 
   coo_matrix(grb::index<I> shape) : shape_(shape) {}
 
+  coo_matrix(grb::index<I> shape, const Allocator& allocator)
+      : shape_(shape), tuples_(backend_allocator_type(allocator)) {}
+
+  coo_matrix(const Allocator& allocator)
+      : tuples_(backend_allocator_type(allocator)) {}
+
   grb::index<I> shape() const noexcept {
     return shape_;
   }
@@ -173,6 +180,10 @@ public:
     return tuples_.size() * sizeof(value_type);
   }
 
+  allocator_type get_allocator() const noexcept {
+    return allocator_type(tuples_.get_allocator());
+  }
+
 private:
   grb::index<I> shape_;
   backend_type tuples_;
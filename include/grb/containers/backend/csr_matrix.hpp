@@ -4,17 +4,21 @@
 #include <climits>
 #include <grb/containers/backend/coo_matrix.hpp>
 #include <grb/containers/backend/csr_matrix_iterator.hpp>
+#include <grb/containers/backend/csr_row.hpp>
 #include <grb/containers/matrix_entry.hpp>
+#include <grb/detail/huge_pages.hpp>
+#include <grb/detail/memory.hpp>
 #include <grb/experimental/sycl_tools/vector.hpp>
 #include <grb/util/index.hpp>
 #include <grb/util/matrix_io.hpp>
 #include <limits>
+#include <ranges>
 #include <vector>
 
 namespace grb {
 
 template <typename T, std::integral I = std::size_t,
-          typename Allocator = std::allocator<T>>
+          typename Allocator = grb::allocator<T>>
 class csr_matrix {
 private:
   template <typename... Args>
@@ -119,6 +123,81 @@ public:
     }
   }
 
+  /// Resize the matrix's storage to hold exactly `nnz` elements, whose row
+  /// pointers, column indices and values are then written directly through
+  /// `rowptr_data()`, `colind_data()` and `values_data()`.  Column indices
+  /// must be sorted within each row.
+  void resize_storage(size_type nnz) {
+    nnz_ = nnz;
+    rowptr_.resize(m_ + 1);
+    colind_.resize(nnz);
+    values_.resize(nnz);
+  }
+
+  index_type* rowptr_data() noexcept {
+    return rowptr_.data();
+  }
+
+  const index_type* rowptr_data() const noexcept {
+    return rowptr_.data();
+  }
+
+  index_type* colind_data() noexcept {
+    return colind_.data();
+  }
+
+  const index_type* colind_data() const noexcept {
+    return colind_.data();
+  }
+
+  auto values_data() noexcept {
+    return values_.data();
+  }
+
+  auto values_data() const noexcept {
+    return values_.data();
+  }
+
+  /// Row `i`, as spans of its column indices and values.
+  grb::csr_row<T, I> row(index_type i) noexcept {
+    return {i,
+            {colind_.data() + rowptr_[i], colind_.data() + rowptr_[i + 1]},
+            {values_.data() + rowptr_[i], values_.data() + rowptr_[i + 1]}};
+  }
+
+  grb::csr_row<const T, I> row(index_type i) const noexcept {
+    return {i,
+            {colind_.data() + rowptr_[i], colind_.data() + rowptr_[i + 1]},
+            {values_.data() + rowptr_[i], values_.data() + rowptr_[i + 1]}};
+  }
+
+  /// Rows `[first, last)`, as a range of `row(i)`.
+  auto rows(index_type first, index_type last) noexcept {
+    return std::views::iota(first, last) |
+           std::views::transform([this](index_type i) { return row(i); });
+  }
+
+  auto rows(index_type first, index_type last) const noexcept {
+    return std::views::iota(first, last) |
+           std::views::transform([this](index_type i) { return row(i); });
+  }
+
+  /// All rows, as a range of `row(i)`.
+  auto rows() noexcept {
+    return rows(0, m_);
+  }
+
+  auto rows() const noexcept {
+    return rows(0, m_);
+  }
+
+  /// Split the rows into `n` consecutive ranges `{first, last}` holding
+  /// about the same number of elements, for example to process them with
+  /// `n` threads through `rows(first, last)`.
+  std::vector<grb::index<I>> partition(std::size_t n) const {
+    return __detail::partition_rows(rowptr_.data(), m_, n);
+  }
+
   csr_matrix(grb::index<I> shape);
   csr_matrix(grb::index<I> shape, const Allocator& allocator);
 
@@ -141,6 +220,15 @@ public:
     return size_bytes;
   }
 
+  /// Bytes of the storage counted by `nbytes()` that are currently backed by
+  /// huge pages, as with `grb::huge_page_allocator`.
+  std::size_t huge_page_nbytes() const {
+    return grb::detail::huge_page_backed_bytes(
+        {{rowptr_.data(), rowptr_.size() * sizeof(index_type)},
+         {colind_.data(), colind_.size() * sizeof(index_type)},
+         {values_.data(), values_.size() * sizeof(scalar_type)}});
+  }
+
   csr_matrix(csr_matrix&& other)
       : rowptr_(std::move(other.rowptr_)), colind_(std::move(other.colind_)),
         values_(std::move(other.values_)), m_(other.m_), n_(other.n_),
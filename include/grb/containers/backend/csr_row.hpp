@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <grb/util/index.hpp>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace grb {
+
+/// Row `index` of a CSR matrix: the column indices of its elements, sorted,
+/// and their values, as contiguous spans into the matrix's storage.  `T` is
+/// const for rows of a const matrix.
+template <typename T, typename I>
+struct csr_row {
+  using scalar_type = std::remove_const_t<T>;
+  using index_type = I;
+
+  I index;
+  std::span<const I> columns;
+  std::span<T> values;
+
+  std::size_t size() const noexcept {
+    return columns.size();
+  }
+
+  bool empty() const noexcept {
+    return columns.empty();
+  }
+};
+
+namespace __detail {
+
+// Split rows `[0, m)` of a CSR matrix with row pointers `rowptr` into
+// `nparts` consecutive ranges `{first, last}` holding about the same number
+// of elements.  Ranges may be empty, for example when a single row holds
+// most elements.
+template <typename I>
+std::vector<grb::index<I>> partition_rows(const I* rowptr, std::size_t m,
+                                          std::size_t nparts) {
+  nparts = std::max<std::size_t>(nparts, 1);
+  std::size_t nnz = rowptr[m];
+
+  std::vector<grb::index<I>> parts;
+  parts.reserve(nparts);
+  I first = 0;
+  for (std::size_t p = 1; p <= nparts; p++) {
+    I last = I(m);
+    if (p < nparts) {
+      std::size_t target = nnz * p / nparts;
+      last = I(std::lower_bound(rowptr + first, rowptr + m, I(target)) -
+               rowptr);
+    }
+    parts.push_back({first, last});
+    first = last;
+  }
+  return parts;
+}
+
+} // namespace __detail
+
+} // namespace grb
@@ -2,6 +2,7 @@
 
 #include <grb/containers/backend/dense_vector_iterator.hpp>
 #include <grb/containers/vector_entry.hpp>
+#include <grb/detail/bitmap.hpp>
 #include <numeric>
 #include <vector>
 
@@ -21,19 +22,18 @@ public:
 
   using allocator_type = Allocator;
 
-  using bool_allocator_type = typename std::allocator_traits<
-      allocator_type>::template rebind_alloc<bool>;
+  using flags_type = grb::detail::bitmap<allocator_type>;
 
   using iterator = dense_vector_iterator<
       T, index_type, typename std::vector<T, allocator_type>::iterator,
       typename std::vector<T, allocator_type>::const_iterator,
-      typename std::vector<bool, bool_allocator_type>::const_iterator>;
+      const flags_type*>;
 
   using const_iterator = dense_vector_iterator<
       std::add_const_t<T>, index_type,
       typename std::vector<T, allocator_type>::iterator,
       typename std::vector<T, allocator_type>::const_iterator,
-      typename std::vector<bool, bool_allocator_type>::const_iterator>;
+      const flags_type*>;
 
   using reference = grb::vector_ref<T, index_type>;
   using const_reference = grb::vector_ref<std::add_const_t<T>, index_type>;
@@ -63,9 +63,9 @@ public:
   }
 
   scalar_reference operator[](I index) noexcept {
-    if (!flags_[index]) {
+    if (!flags_.test(index)) {
       data_[index] = T();
-      flags_[index] = true;
+      flags_.set(index);
       nnz_++;
     }
     return data_[index];
@@ -89,11 +89,11 @@ public:
 
   std::pair<iterator, bool> insert(const value_type& value) {
     auto&& [idx, v] = value;
-    if (flags_[idx]) {
+    if (flags_.test(idx)) {
       return {iterator(data_, flags_, idx), false};
     } else {
       nnz_++;
-      flags_[idx] = true;
+      flags_.set(idx);
       data_[idx] = v;
       return {iterator(data_, flags_, idx), true};
     }
@@ -101,19 +101,19 @@ public:
 
   template <typename M>
   std::pair<iterator, bool> insert_or_assign(key_type k, M&& obj) {
-    if (flags_[k]) {
+    if (flags_.test(k)) {
       data_[k] = std::forward<M>(obj);
       return {iterator(data_, flags_, k), false};
     } else {
       nnz_++;
-      flags_[k] = true;
+      flags_.set(k);
       data_[k] = std::forward<M>(obj);
       return {iterator(data_, flags_, k), true};
     }
   }
 
   iterator find(key_type key) noexcept {
-    if (flags_[key]) {
+    if (flags_.test(key)) {
       return iterator(data_, flags_, key);
     } else {
       return end();
@@ -121,7 +121,7 @@ public:
   }
 
   const_iterator find(key_type key) const noexcept {
-    if (flags_[key]) {
+    if (flags_.test(key)) {
       return const_iterator(data_, flags_, key);
     } else {
       return end();
@@ -133,10 +133,24 @@ public:
     data_.resize(shape);
     flags_.resize(shape, false);
     if (smaller) {
-      nnz_ = std::reduce(flags_.begin(), flags_.end(), size_t(0));
+      nnz_ = flags_.count();
     }
   }
 
+  /// Bitmap recording which indices hold a stored value.
+  const flags_type& flags() const noexcept {
+    return flags_;
+  }
+
+  /// Dense array of values, only meaningful where `flags()` is set.
+  const std::vector<T, allocator_type>& values() const noexcept {
+    return data_;
+  }
+
+  allocator_type get_allocator() const noexcept {
+    return data_.get_allocator();
+  }
+
   dense_vector() = default;
 
   dense_vector(const Allocator& allocator)
@@ -165,7 +179,7 @@ private:
   friend const_iterator;
 
   std::vector<T, allocator_type> data_;
-  std::vector<bool, bool_allocator_type> flags_;
+  flags_type flags_;
   size_t nnz_ = 0;
 };
 
@@ -44,10 +44,9 @@ public:
 
   using iterator_category = std::forward_iterator_tag;
 
-  template <std::ranges::random_access_range R1,
-            std::ranges::random_access_range R2>
-  dense_vector_iterator(R1&& data, R2&& flags, index_type index)
-      : data_(data), flags_(flags), index_(index) {
+  template <std::ranges::random_access_range R, typename Flags>
+  dense_vector_iterator(R&& data, const Flags& flags, index_type index)
+      : data_(data), flags_(&flags), index_(index) {
     fast_forward();
   }
 
@@ -64,9 +63,7 @@ public:
   }
 
   void fast_forward() noexcept {
-    while (!flags_[index_] && index_ < flags_.size()) {
-      index_++;
-    }
+    index_ = index_type(flags_->find_next(index_));
   }
 
   void increment() noexcept {
@@ -130,7 +127,7 @@ public:
 
 private:
   grb::detail::spanner<backend_iterator> data_;
-  grb::detail::spanner<BIter> flags_;
+  BIter flags_;
 
   index_type index_;
 };
@@ -3,6 +3,7 @@
 #include <climits>
 #include <grb/containers/backend/dia_matrix_iterator.hpp>
 #include <grb/containers/matrix_entry.hpp>
+#include <grb/detail/memory.hpp>
 #include <grb/util/index.hpp>
 #include <grb/util/matrix_io.hpp>
 #include <limits>
@@ -12,7 +13,7 @@
 namespace grb {
 
 template <typename T, std::integral I = std::size_t,
-          typename Allocator = std::allocator<T>>
+          typename Allocator = grb::allocator<T>>
 class dia_matrix {
 public:
   using scalar_type = T;
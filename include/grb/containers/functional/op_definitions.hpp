@@ -27,6 +27,8 @@ public:
 template <typename Fn, typename T = void, typename U = T, typename V = void>
 class binary_op_impl_ {
 public:
+  using impl_type = Fn;
+
   constexpr V operator()(const T& lhs, const U& rhs) const {
     return Fn{}(lhs, rhs);
   }
@@ -37,11 +39,24 @@ public:
   {
     return Fn::template identity<X>();
   }
+
+  template <typename X>
+  static constexpr X terminal()
+    requires(has_terminal_template_v<Fn, X>)
+  {
+    return Fn::template terminal<X>();
+  }
+
+  static constexpr bool commutative = grb::is_commutative_v<Fn>;
+  static constexpr bool idempotent = grb::is_idempotent_v<Fn>;
+  static constexpr bool any = grb::is_any_op_v<Fn>;
 };
 
 template <typename Fn, typename T, typename U>
 class binary_op_impl_<Fn, T, U, void> {
 public:
+  using impl_type = Fn;
+
   constexpr auto operator()(const T& lhs, const U& rhs) const {
     return Fn{}(lhs, rhs);
   }
@@ -51,11 +66,23 @@ public:
   {
     return Fn::template identity<T>();
   }
+
+  static constexpr T terminal()
+    requires(std::is_same_v<T, U> && has_terminal_template_v<Fn, T>)
+  {
+    return Fn::template terminal<T>();
+  }
+
+  static constexpr bool commutative = grb::is_commutative_v<Fn>;
+  static constexpr bool idempotent = grb::is_idempotent_v<Fn>;
+  static constexpr bool any = grb::is_any_op_v<Fn>;
 };
 
 template <typename Fn>
 class binary_op_impl_<Fn, void, void, void> {
 public:
+  using impl_type = Fn;
+
   template <typename T, typename U>
   constexpr auto operator()(T&& lhs, U&& rhs) const {
     return Fn{}(lhs, rhs);
@@ -67,6 +94,17 @@ public:
   {
     return Fn::template identity<T>();
   }
+
+  template <typename T>
+  static constexpr T terminal()
+    requires(has_terminal_template_v<Fn, T>)
+  {
+    return Fn::template terminal<T>();
+  }
+
+  static constexpr bool commutative = grb::is_commutative_v<Fn>;
+  static constexpr bool idempotent = grb::is_idempotent_v<Fn>;
+  static constexpr bool any = grb::is_any_op_v<Fn>;
 };
 
 class plus_impl_ {
@@ -80,6 +118,8 @@ public:
   static constexpr T identity() {
     return T(0);
   }
+
+  static constexpr bool commutative = true;
 };
 
 /// Binary Operator to perform subtraction. Uses the `-` operator.
@@ -101,6 +141,17 @@ struct multiplies_impl_ {
   static constexpr T identity() {
     return T(1);
   }
+
+  // Only integral products are annihilated by zero; for floating point
+  // types `0 * inf` is NaN.
+  template <typename T>
+  static constexpr T terminal()
+    requires(std::is_integral_v<T>)
+  {
+    return T(0);
+  }
+
+  static constexpr bool commutative = true;
 };
 
 /// Binary Operator to perform division. Uses the `/` operator.
@@ -149,11 +200,22 @@ struct max_impl_ {
 
   template <typename T>
   static constexpr T identity()
-    requires(std::numeric_limits<T>::is_specialized())
+    requires(std::numeric_limits<T>::is_specialized)
   {
     return std::min(std::numeric_limits<T>::lowest(),
                     -std::numeric_limits<T>::infinity());
   }
+
+  template <typename T>
+  static constexpr T terminal()
+    requires(std::numeric_limits<T>::is_specialized)
+  {
+    return std::max(std::numeric_limits<T>::max(),
+                    std::numeric_limits<T>::infinity());
+  }
+
+  static constexpr bool commutative = true;
+  static constexpr bool idempotent = true;
 };
 
 /// Binary Operator to perform min, returning the lesser of the two values,
@@ -185,11 +247,22 @@ struct min_impl_ {
 
   template <typename T>
   static constexpr T identity()
-    requires(std::numeric_limits<T>::is_specialized())
+    requires(std::numeric_limits<T>::is_specialized)
   {
     return std::max(std::numeric_limits<T>::max(),
                     std::numeric_limits<T>::infinity());
   }
+
+  template <typename T>
+  static constexpr T terminal()
+    requires(std::numeric_limits<T>::is_specialized)
+  {
+    return std::min(std::numeric_limits<T>::lowest(),
+                    -std::numeric_limits<T>::infinity());
+  }
+
+  static constexpr bool commutative = true;
+  static constexpr bool idempotent = true;
 };
 
 /// Binary Operator to perform modulus, uses the `%` operator.
@@ -200,6 +273,17 @@ struct modulus_impl_ {
   }
 };
 
+/// Binary Operator returning one regardless of its operands, used to
+/// compute structure-only products such as the "any-pair" semiring.
+struct pair_impl_ {
+  template <typename T, typename U>
+  constexpr auto operator()(const T&, const U&) const {
+    return std::common_type_t<T, U>(1);
+  }
+
+  static constexpr bool commutative = true;
+};
+
 /// The binary operator `grb::plus`, which forms a monoid
 /// on integral types.
 /*
@@ -231,6 +315,9 @@ struct min : public binary_op_impl_<min_impl_, T, U, V> {};
 template <typename T = void, typename U = T, typename V = void>
 struct modulus : public binary_op_impl_<modulus_impl_, T, U, V> {};
 
+template <typename T = void, typename U = T, typename V = void>
+struct pair : public binary_op_impl_<pair_impl_, T, U, V> {};
+
 // Unary operators
 
 struct negate_impl_ {
@@ -265,6 +352,14 @@ struct logical_and_impl_ {
   static constexpr T identity() {
     return T(true);
   }
+
+  template <typename T>
+  static constexpr T terminal() {
+    return T(false);
+  }
+
+  static constexpr bool commutative = true;
+  static constexpr bool idempotent = true;
 };
 
 struct logical_or_impl_ {
@@ -277,6 +372,14 @@ struct logical_or_impl_ {
   static constexpr T identity() {
     return T(false);
   }
+
+  template <typename T>
+  static constexpr T terminal() {
+    return T(true);
+  }
+
+  static constexpr bool commutative = true;
+  static constexpr bool idempotent = true;
 };
 
 struct logical_xor_impl_ {
@@ -289,6 +392,8 @@ struct logical_xor_impl_ {
   static constexpr T identity() {
     return T(false);
   }
+
+  static constexpr bool commutative = true;
 };
 
 struct logical_xnor_impl_ {
@@ -296,6 +401,8 @@ struct logical_xnor_impl_ {
   constexpr auto operator()(const T& a, const U& b) const {
     return !((a || b) && !(a && b));
   }
+
+  static constexpr bool commutative = true;
 };
 
 template <typename T = void, typename U = T, typename V = void>
@@ -310,11 +417,19 @@ struct logical_xor : binary_op_impl_<logical_xor_impl_, T, U, V> {};
 template <typename T = void, typename U = T, typename V = void>
 struct logical_xnor : binary_op_impl_<logical_xnor_impl_, T, U, V> {};
 
+// `take_left` is an "any" operator when used as a reduction: every operand
+// is an acceptable result, so a reduction may keep whichever value it sees
+// first.  `take_right` is not, since reductions over it are relied on to
+// keep the last value.
+
 template <typename T = void>
 struct take_left {
   T operator()(const T& left, const T& right) const {
     return left;
   }
+
+  static constexpr bool idempotent = true;
+  static constexpr bool any = true;
 };
 
 template <>
@@ -323,6 +438,9 @@ struct take_left<void> {
   T operator()(const T& left, const U& right) const {
     return left;
   }
+
+  static constexpr bool idempotent = true;
+  static constexpr bool any = true;
 };
 
 template <typename T = void>
@@ -330,6 +448,8 @@ struct take_right {
   T operator()(const T& left, const T& right) const {
     return right;
   }
+
+  static constexpr bool idempotent = true;
 };
 
 template <>
@@ -338,6 +458,8 @@ struct take_right<void> {
   U operator()(const T& left, const U& right) const {
     return right;
   }
+
+  static constexpr bool idempotent = true;
 };
 
 struct lower_triangle {
@@ -43,6 +43,9 @@ using max_times = max_multiplies;
 
 using plus_min = standard_semiring<grb::plus<>, grb::min<>>;
 
+// Structure-only semiring: any stored product counts, with value one.
+using any_pair = standard_semiring<grb::take_left<>, grb::pair<>>;
+
 // Logical semirings
 
 using lor_land = standard_semiring<grb::logical_or<>, grb::logical_and<>>;
@@ -5,8 +5,17 @@
 #include <grb/containers/backend/csr_matrix.hpp>
 #include <grb/containers/backend/dia_matrix.hpp>
 
+#include <grb/containers/functional/op_definitions.hpp>
 #include <grb/containers/matrix_entry.hpp>
+#include <grb/detail/csr_storage.hpp>
+#include <grb/detail/matrix_build.hpp>
+#include <grb/detail/memory.hpp>
+#include <grb/detail/shared_cache.hpp>
 #include <grb/util/matrix_hints.hpp>
+#include <grb/util/matrix_io.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace grb {
 
@@ -18,7 +27,7 @@ namespace grb {
 ///    `grb::dense`.
 /// 4. `Allocator` is the C++ allocator used to allocate memory.
 template <typename T, std::integral I = std::size_t,
-          typename Hint = grb::sparse, typename Allocator = std::allocator<T>>
+          typename Hint = grb::sparse, typename Allocator = grb::allocator<T>>
 class matrix {
 public:
   /// Type of scalar elements stored in the matrix.
@@ -74,16 +83,12 @@ public:
   /// Construct a matrix from the Matrix Market file stored at location
   /// `file_path`.
   matrix(std::string file_path) {
-    auto tuples = grb::mmread<T, I>(file_path);
-    reshape(tuples.shape());
-    insert(tuples.begin(), tuples.end());
+    read_matrix_market_(file_path);
   }
 
   matrix(std::string file_path, const Allocator& allocator)
       : backend_(allocator) {
-    auto tuples = grb::mmread<T, I>(file_path);
-    reshape(tuples.shape());
-    insert(tuples.begin(), tuples.end());
+    read_matrix_market_(file_path);
   }
 
   /// Dimensions of the matrix
@@ -103,6 +108,7 @@ public:
 
   /// Iterator to the beginning
   iterator begin() noexcept {
+    invalidate_transpose();
     return backend_.begin();
   }
 
@@ -113,6 +119,7 @@ public:
 
   /// Iterator to the end
   iterator end() noexcept {
+    invalidate_transpose();
     return backend_.end();
   }
 
@@ -124,11 +131,71 @@ public:
   /// Insert elements in the range [first, last).
   template <typename InputIt>
   void insert(InputIt first, InputIt last) {
+    invalidate_transpose();
     backend_.insert(first, last);
   }
 
+  /// Replace the contents of the matrix with the elements `{{i, j}, value}`
+  /// in `[first, last)`, which may be in any order and may repeat indices.
+  /// The values of elements with the same index are combined with `dup`, in
+  /// the order they appear.  Elements are sorted with a parallel radix sort
+  /// on their indices and written directly into the backend, so this is
+  /// much faster than `insert` for large unsorted ranges.  Throws
+  /// `grb::out_of_range`, leaving the matrix unchanged, if an index is
+  /// outside the matrix's shape.
+  template <std::forward_iterator InputIt, typename Dup = grb::plus<>>
+  void build(InputIt first, InputIt last, Dup&& dup = Dup()) {
+    if constexpr (__detail::CSRStorage<backend_type>) {
+      std::size_t m = shape()[0];
+      I* rowptr = nullptr;
+      I* colind = nullptr;
+      T* values = nullptr;
+
+      __detail::build_elements<T, I>(
+          first, last, shape(), dup,
+          [&](std::size_t nnz) {
+            invalidate_transpose();
+            backend_.resize_storage(nnz);
+            rowptr = backend_.rowptr_data();
+            colind = backend_.colind_data();
+            values = backend_.values_data();
+            std::fill(rowptr, rowptr + m + 1, I(0));
+          },
+          [&](std::size_t k, I i, I j, T&& value) {
+            colind[k] = j;
+            values[k] = std::move(value);
+            std::atomic_ref<I>(rowptr[i + 1])
+                .fetch_add(1, std::memory_order_relaxed);
+          });
+
+      for (std::size_t i = 0; i < m; i++) {
+        rowptr[i + 1] += rowptr[i];
+      }
+    } else {
+      std::vector<value_type> elements;
+      __detail::build_elements<T, I>(
+          first, last, shape(), dup,
+          [&](std::size_t nnz) { elements.resize(nnz); },
+          [&](std::size_t k, I i, I j, T&& value) {
+            elements[k] = value_type({i, j}, std::move(value));
+          });
+
+      backend_type backend(shape(), backend_.get_allocator());
+      if constexpr (requires {
+                      backend.assign_tuples(elements.begin(), elements.end());
+                    }) {
+        backend.assign_tuples(elements.begin(), elements.end());
+      } else {
+        backend.insert(elements.begin(), elements.end());
+      }
+      invalidate_transpose();
+      backend_ = std::move(backend);
+    }
+  }
+
   void clear() {
     matrix other(shape());
+    other.cache_transpose_ = cache_transpose_;
     *this = std::move(other);
   }
 
@@ -140,15 +207,18 @@ public:
   /// containing an iterator to the element that prevented
   /// inserting, along with the boolean value `false`.
   std::pair<iterator, bool> insert(const value_type& value) {
+    invalidate_transpose();
     return backend_.insert(std::move(value));
   }
 
   template <class M>
   std::pair<iterator, bool> insert_or_assign(key_type k, M&& obj) {
+    invalidate_transpose();
     return backend_.insert_or_assign(k, std::forward<M>(obj));
   }
 
   iterator find(key_type key) noexcept {
+    invalidate_transpose();
     return backend_.find(key);
   }
 
@@ -159,6 +229,7 @@ public:
   /// Reshape the matrix dimensions to be `shape[0]` x `shape[1]`.
   /// Any elements outside the new shape will be deleted.
   void reshape(grb::index<I> shape) {
+    invalidate_transpose();
     return backend_.reshape(shape);
   }
 
@@ -168,6 +239,104 @@ public:
     return value;
   }
 
+  /// Row `i` of a CSR-backed matrix, as spans of its column indices and
+  /// values.
+  auto row(I i) noexcept
+    requires __detail::CSRStorage<backend_type>
+  {
+    invalidate_transpose();
+    return backend_.row(i);
+  }
+
+  auto row(I i) const noexcept
+    requires __detail::CSRStorage<backend_type>
+  {
+    return backend_.row(i);
+  }
+
+  /// Rows `[first, last)` of a CSR-backed matrix, as a range of `row(i)`.
+  auto rows(I first, I last) noexcept
+    requires __detail::CSRStorage<backend_type>
+  {
+    invalidate_transpose();
+    return backend_.rows(first, last);
+  }
+
+  auto rows(I first, I last) const noexcept
+    requires __detail::CSRStorage<backend_type>
+  {
+    return backend_.rows(first, last);
+  }
+
+  /// All rows of a CSR-backed matrix, as a range of `row(i)`.
+  auto rows() noexcept
+    requires __detail::CSRStorage<backend_type>
+  {
+    invalidate_transpose();
+    return backend_.rows();
+  }
+
+  auto rows() const noexcept
+    requires __detail::CSRStorage<backend_type>
+  {
+    return backend_.rows();
+  }
+
+  /// Split the rows of a CSR-backed matrix into `n` consecutive ranges
+  /// `{first, last}` holding about the same number of elements.
+  std::vector<grb::index<I>> partition(std::size_t n) const
+    requires __detail::CSRStorage<backend_type>
+  {
+    return backend_.partition(n);
+  }
+
+  /// Keep a materialized transpose of the matrix, so that
+  /// `grb::transpose(matrix)` reads it in row order instead of swapping
+  /// indices on the fly, and matrix-vector products with the transpose run
+  /// on its CSR arrays.  The transpose is built on first use, once even if
+  /// several threads ask for it, and discarded by every modification and
+  /// by every non-const accessor that allows one: `insert`,
+  /// `insert_or_assign`, `operator[]`, `reshape`, `clear`, assignment, and
+  /// the non-const `begin`, `end`, `find`, `row`, `rows` and `backend`.
+  /// Read a matrix through a const reference to keep its transpose.
+  void cache_transpose(bool enable = true) {
+    cache_transpose_ = enable;
+    if (!enable) {
+      transpose_.reset();
+    }
+  }
+
+  /// Whether the matrix keeps a materialized transpose.
+  bool caches_transpose() const noexcept {
+    return cache_transpose_;
+  }
+
+  /// The cached transpose of the matrix, built if it is out of date, or
+  /// `nullptr` if caching is disabled.  The transpose stays alive as long
+  /// as the returned pointer, even after the matrix discards it.
+  std::shared_ptr<const matrix> cached_transpose() const {
+    if (!cache_transpose_) {
+      return nullptr;
+    }
+    return transpose_.get([&] { return transpose_materialize(*this); });
+  }
+
+  /// Discard the cached transpose, if any.
+  void invalidate_transpose() noexcept {
+    if (cache_transpose_) {
+      transpose_.reset();
+    }
+  }
+
+  const backend_type& backend() const noexcept {
+    return backend_;
+  }
+
+  backend_type& backend() noexcept {
+    invalidate_transpose();
+    return backend_;
+  }
+
   matrix() = default;
   matrix(const Allocator& allocator) : backend_(allocator) {}
 
@@ -177,7 +346,21 @@ public:
   matrix& operator=(matrix&&) = default;
 
 private:
+  // CSR backends are filled directly from the parsed file; others insert
+  // the file's elements.
+  void read_matrix_market_(const std::string& file_path) {
+    if constexpr (__detail::CSRStorage<backend_type>) {
+      grb::mmread_csr<T, I>(file_path, backend_);
+    } else {
+      auto tuples = grb::mmread<T, I>(file_path);
+      reshape(tuples.shape());
+      insert(tuples.begin(), tuples.end());
+    }
+  }
+
   backend_type backend_;
+  bool cache_transpose_ = false;
+  grb::detail::shared_cache<matrix> transpose_;
 };
 
 } // namespace grb
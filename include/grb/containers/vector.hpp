@@ -2,13 +2,14 @@
 #pragma once
 
 #include <grb/containers/backend/dense_vector.hpp>
+#include <grb/detail/memory.hpp>
 #include <grb/grb.hpp>
 #include <numeric>
 
 namespace grb {
 
 template <typename T, std::integral I = std::size_t, typename Hint = grb::dense,
-          typename Allocator = std::allocator<T>>
+          typename Allocator = grb::allocator<T>>
 class vector {
 public:
   /// Type of scalar values stored in the matrix
@@ -107,8 +108,12 @@ public:
     return backend_.insert_or_assign(k, std::forward<M>(obj));
   }
 
+  allocator_type get_allocator() const noexcept {
+    return backend_.get_allocator();
+  }
+
   void clear() {
-    vector other(shape());
+    vector other(shape(), get_allocator());
     *this = std::move(other);
   }
 
@@ -116,6 +121,11 @@ public:
     backend_.reshape(shape);
   }
 
+  /// The backend data structure storing the vector's elements.
+  const backend_type& backend() const noexcept {
+    return backend_;
+  }
+
   vector() = default;
   vector(const Allocator& allocator) : backend_(allocator) {}
 
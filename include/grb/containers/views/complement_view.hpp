@@ -1,13 +1,62 @@
-
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <grb/detail/iterator_adaptor.hpp>
+#include <grb/detail/mask_traits.hpp>
+#include <grb/detail/shared_cache.hpp>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace grb {
 
-/*
-   TODO: there are a ton of optimizations that could be applied here.
-*/
+namespace __detail {
+
+// Access to the live presence bitmap of vectors that store one, such as
+// `grb::vector`, and of their structure views.  Indices whose flag is unset
+// are in the complement, and so, for valued vectors, are elements holding
+// `false`.  Complement iterators skip set flags a word at a time.
+template <typename V>
+struct complement_vector_bitmap {
+  static constexpr bool available = false;
+  using bitmap_type = void;
+};
+
+template <grb::detail::BitmapVector V>
+struct complement_vector_bitmap<V> {
+  static constexpr bool available = true;
+  static constexpr bool valued = true;
+  using bitmap_type =
+      std::remove_cvref_t<decltype(std::declval<const V&>().backend().flags())>;
+
+  static const bitmap_type& flags(const V& vector) noexcept {
+    return vector.backend().flags();
+  }
+
+  static bool holds_false(const V& vector, std::size_t i) {
+    return !static_cast<bool>(vector.backend().values()[i]);
+  }
+};
+
+template <grb::detail::BitmapStructureMask V>
+struct complement_vector_bitmap<V> {
+  static constexpr bool available = true;
+  static constexpr bool valued = false;
+  using bitmap_type = std::remove_cvref_t<
+      decltype(std::declval<const V&>().base().backend().flags())>;
+
+  static const bitmap_type& flags(const V& vector) noexcept {
+    return vector.base().backend().flags();
+  }
+
+  static bool holds_false(const V&, std::size_t) {
+    return false;
+  }
+};
+
+} // namespace __detail
 
 template <grb::VectorRange V>
 class complement_vector_view_accessor {
@@ -25,6 +74,9 @@ public:
 
   using iterator_category = std::forward_iterator_tag;
 
+  using bitmap_type =
+      typename __detail::complement_vector_bitmap<V>::bitmap_type;
+
   complement_vector_view_accessor() noexcept = default;
   ~complement_vector_view_accessor() noexcept = default;
   complement_vector_view_accessor(
@@ -32,8 +84,9 @@ public:
   complement_vector_view_accessor&
   operator=(const complement_vector_view_accessor&) noexcept = default;
 
-  complement_vector_view_accessor(const V& vector, index_type index)
-      : vector_(&vector), index_(index) {
+  complement_vector_view_accessor(const V& vector, const bitmap_type* excluded,
+                                  index_type index)
+      : vector_(&vector), excluded_(excluded), index_(index) {
     fast_forward();
   }
 
@@ -50,8 +103,48 @@ public:
   }
 
   void fast_forward() {
-    while (index_ < vector_->shape() && !index_present()) {
-      ++index_;
+    using bitmap = __detail::complement_vector_bitmap<V>;
+    if constexpr (bitmap::available) {
+      using word_type = std::remove_cvref_t<decltype(*excluded_->data())>;
+      constexpr std::size_t word_bits = 64;
+      std::size_t n = vector_->shape();
+      if (std::size_t(index_) >= n) {
+        index_ = index_type(n);
+        return;
+      }
+
+      // Skip words whose indices all hold elements converting to `true`.
+      // Within a word, unset flags are in the complement, and, for valued
+      // vectors, so is the first set flag before them holding `false`.
+      const word_type* words = excluded_->data();
+      std::size_t w = std::size_t(index_) / word_bits;
+      word_type from = ~word_type(0) << (std::size_t(index_) % word_bits);
+      for (; w < excluded_->word_count(); ++w, from = ~word_type(0)) {
+        word_type unset = ~words[w] & from;
+        if constexpr (bitmap::valued) {
+          word_type set = words[w] & from;
+          if (unset != 0) {
+            set &= (unset & -unset) - 1;
+          }
+          for (; set != 0; set &= set - 1) {
+            std::size_t i = w * word_bits + std::countr_zero(set);
+            if (bitmap::holds_false(*vector_, i)) {
+              index_ = index_type(i);
+              return;
+            }
+          }
+        }
+        if (unset != 0) {
+          index_ = index_type(std::min<std::size_t>(
+              w * word_bits + std::countr_zero(unset), n));
+          return;
+        }
+      }
+      index_ = index_type(n);
+    } else {
+      while (index_ < vector_->shape() && !index_present()) {
+        ++index_;
+      }
     }
   }
 
@@ -75,6 +168,7 @@ public:
 
 private:
   const V* vector_;
+  const bitmap_type* excluded_;
   index_type index_;
 };
 
@@ -85,6 +179,12 @@ using complement_vector_view_iterator =
 template <typename V>
 class complement_view;
 
+/// View of the indices of `V` not holding an element that converts to
+/// `true`.  The view reads `V` as it is when the view is used, not when it
+/// is created.  For vectors stored with a presence bitmap, such as
+/// `grb::vector`, and their structure views, `find` takes constant time,
+/// as does `size` for structure views, and iteration scans the bitmap 64
+/// indices at a time, testing only the values of stored elements.
 template <grb::VectorRange V>
 class complement_view<V> {
 public:
@@ -101,21 +201,34 @@ public:
   complement_view(const V& vector) : vector_(vector) {}
 
   std::size_t size() const {
-    std::size_t vec_size = shape() - vector_.size();
-    for (auto&& [_, value] : vector_) {
-      if (!static_cast<bool>(value)) {
-        vec_size++;
+    if constexpr (bitmap_type::available && !bitmap_type::valued) {
+      return shape() - vector_.size();
+    } else if constexpr (bitmap_type::available) {
+      // Count the elements holding `true`, visiting only set flags.
+      auto&& flags = bitmap_type::flags(vector_);
+      std::size_t excluded = 0;
+      for (std::size_t i = flags.find_next(0); i < flags.size();
+           i = flags.find_next(i + 1)) {
+        excluded += !bitmap_type::holds_false(vector_, i);
       }
+      return shape() - excluded;
+    } else {
+      std::size_t vec_size = shape() - vector_.size();
+      for (auto&& [_, value] : vector_) {
+        if (!static_cast<bool>(value)) {
+          vec_size++;
+        }
+      }
+      return vec_size;
     }
-    return vec_size;
   }
 
   iterator begin() const {
-    return iterator(vector_, 0);
+    return iterator(vector_, excluded(), 0);
   }
 
   iterator end() const {
-    return iterator(vector_, shape());
+    return iterator(vector_, excluded(), shape());
   }
 
   auto shape() const {
@@ -123,16 +236,39 @@ public:
   }
 
   iterator find(key_type key) const {
-    auto iter = vector_.find(key);
-
-    if (iter == vector_.end() || !static_cast<bool>(grb::get<1>(*iter))) {
-      return iterator(vector_, key);
+    if constexpr (bitmap_type::available) {
+      if (key < shape() && (!bitmap_type::flags(vector_).test(key) ||
+                            bitmap_type::holds_false(vector_, key))) {
+        return iterator(vector_, excluded(), key);
+      } else {
+        return end();
+      }
     } else {
-      return end();
+      auto iter = vector_.find(key);
+
+      if (iter == vector_.end() || !static_cast<bool>(grb::get<1>(*iter))) {
+        return iterator(vector_, excluded(), key);
+      } else {
+        return end();
+      }
     }
   }
 
+  const V& base() const noexcept {
+    return vector_;
+  }
+
 private:
+  using bitmap_type = __detail::complement_vector_bitmap<V>;
+
+  auto excluded() const noexcept {
+    if constexpr (bitmap_type::available) {
+      return &bitmap_type::flags(vector_);
+    } else {
+      return nullptr;
+    }
+  }
+
   const V& vector_;
 };
 
@@ -160,38 +296,50 @@ public:
   complement_matrix_view_accessor&
   operator=(const complement_matrix_view_accessor&) noexcept = default;
 
-  complement_matrix_view_accessor(const M& matrix, index_type i, index_type j)
-      : matrix_(&matrix), i_(i), j_(j) {
-    fast_forward();
-  }
-
-  // Return whether the current index is present in the complement view.
-  bool index_present() const {
-    auto iter = matrix_->find(index());
-    if (iter == matrix_->end()) {
-      return true;
-    } else if (!static_cast<bool>(grb::get<1>(*iter))) {
-      return true;
-    } else {
-      return false;
+  // `excluded` holds the sorted, row-major linearized indices of the
+  // elements of `matrix` that are not in the complement, gathered by the
+  // view.  Without it, as for iterators returned by `find`,
+  // each index is looked up in `matrix` as the iterator advances.
+  complement_matrix_view_accessor(
+      const M& matrix,
+      std::shared_ptr<const std::vector<std::size_t>> excluded,
+      std::size_t linear_index)
+      : matrix_(&matrix), excluded_(std::move(excluded)),
+        linear_index_(linear_index) {
+    if (excluded_) {
+      next_excluded_ = std::lower_bound(excluded_->begin(), excluded_->end(),
+                                        linear_index) -
+                       excluded_->begin();
     }
+    fast_forward();
   }
 
   void fast_forward() {
-    while (linearized(index()) < linearized(matrix_->shape()) &&
-           !index_present()) {
-      increment();
+    if (excluded_) {
+      std::size_t n = excluded_->size();
+      while (next_excluded_ < n &&
+             (*excluded_)[next_excluded_] <= linear_index_) {
+        if ((*excluded_)[next_excluded_] == linear_index_) {
+          ++linear_index_;
+        }
+        ++next_excluded_;
+      }
+    } else {
+      std::size_t end = std::size_t(matrix_->shape()[0]) * matrix_->shape()[1];
+      while (linear_index_ < end && excluded_at(index())) {
+        ++linear_index_;
+      }
     }
   }
 
-  complement_matrix_view_accessor& operator++() noexcept {
-    increment();
+  complement_matrix_view_accessor& operator++() {
+    ++linear_index_;
     fast_forward();
     return *this;
   }
 
   bool operator==(const complement_matrix_view_accessor& other) const noexcept {
-    return matrix_ == other.matrix_ && index() == other.index();
+    return matrix_ == other.matrix_ && linear_index_ == other.linear_index_;
   }
 
   bool operator!=(const complement_matrix_view_accessor& other) const noexcept {
@@ -203,32 +351,34 @@ public:
   }
 
 private:
-  void increment() noexcept {
-    if (j_ > matrix_->shape()[1] - 1) {
-      i_++;
-      j_ = 0;
-    } else {
-      j_++;
-    }
-  }
-
-  auto index() const noexcept {
-    return key_type(i_, j_);
+  key_type index() const noexcept {
+    std::size_t n = matrix_->shape()[1];
+    return key_type(index_type(linear_index_ / n),
+                    index_type(linear_index_ % n));
   }
 
-  auto linearized(key_type idx) const noexcept {
-    return idx[0] * idx[1];
+  bool excluded_at(key_type key) const {
+    auto iter = matrix_->find(key);
+    return iter != matrix_->end() && static_cast<bool>(grb::get<1>(*iter));
   }
 
 private:
   const M* matrix_;
-  index_type i_, j_;
+  std::shared_ptr<const std::vector<std::size_t>> excluded_;
+  std::size_t linear_index_;
+  std::size_t next_excluded_ = 0;
 };
 
 template <grb::MatrixRange M>
 using complement_matrix_view_iterator =
     grb::detail::iterator_adaptor<complement_matrix_view_accessor<M>>;
 
+/// View of the indices of `M` not holding an element that converts to
+/// `true`.  `find` reads `M` as it is when it is called.  Iteration, and
+/// `size` for valued matrices, use the sorted excluded indices, gathered
+/// from `M` once, the first time the view needs them, and then stepped over
+/// without lookups; create a new view to iterate `M` after modifying it.
+/// For structure views, `size` takes constant time.
 template <grb::MatrixRange M>
 class complement_view<M> {
 public:
@@ -245,21 +395,20 @@ public:
   complement_view(const M& matrix) : matrix_(matrix) {}
 
   std::size_t size() const {
-    std::size_t matrix_size = shape()[0] * shape()[1] - matrix_.size();
-    for (auto&& [_, value] : matrix_) {
-      if (!static_cast<bool>(value)) {
-        matrix_size++;
-      }
+    std::size_t dim = std::size_t(shape()[0]) * shape()[1];
+    if constexpr (grb::is_structural_mask_v<M>) {
+      return dim - matrix_.size();
+    } else {
+      return dim - excluded()->size();
     }
-    return matrix_size;
   }
 
   iterator begin() const {
-    return iterator(matrix_, 0, 0);
+    return iterator(matrix_, excluded(), 0);
   }
 
   iterator end() const {
-    return iterator(matrix_, shape()[0], shape()[1]);
+    return iterator(matrix_, nullptr, std::size_t(shape()[0]) * shape()[1]);
   }
 
   auto shape() const {
@@ -267,17 +416,44 @@ public:
   }
 
   iterator find(key_type key) const {
+    if (key[0] >= shape()[0] || key[1] >= shape()[1]) {
+      return end();
+    }
     auto iter = matrix_.find(key);
-
-    if (iter == matrix_.end() || !static_cast<bool>(grb::get<1>(*iter))) {
-      return iterator(matrix_, key[0], key[1]);
-    } else {
+    if (iter != matrix_.end() && static_cast<bool>(grb::get<1>(*iter))) {
       return end();
     }
+    return iterator(matrix_, nullptr, linearized(key));
+  }
+
+  const M& base() const noexcept {
+    return matrix_;
   }
 
 private:
+  std::size_t linearized(key_type key) const noexcept {
+    return std::size_t(key[0]) * shape()[1] + key[1];
+  }
+
+  std::shared_ptr<const std::vector<std::size_t>> excluded() const {
+    return excluded_.get([&] {
+      std::vector<std::size_t> excluded;
+      excluded.reserve(matrix_.size());
+      for (auto&& [index, value] : matrix_) {
+        if (static_cast<bool>(value)) {
+          excluded.push_back(linearized(index));
+        }
+      }
+      // Backends such as CSR already iterate in row-major order.
+      if (!std::is_sorted(excluded.begin(), excluded.end())) {
+        std::sort(excluded.begin(), excluded.end());
+      }
+      return excluded;
+    });
+  }
+
   const M& matrix_;
+  grb::detail::shared_cache<std::vector<std::size_t>> excluded_;
 };
 
 template <grb::MatrixRange M>
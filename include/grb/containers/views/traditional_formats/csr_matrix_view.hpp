@@ -1,9 +1,12 @@
 #pragma once
 
+#include <grb/containers/backend/csr_row.hpp>
 #include <grb/containers/matrix_entry.hpp>
 #include <grb/detail/iterator_adaptor.hpp>
 #include <grb/util/index.hpp>
 #include <iterator>
+#include <type_traits>
+#include <vector>
 
 namespace grb {
 
@@ -166,7 +169,8 @@ public:
   // That is:
   // Advance `row_` until idx_ >= rowptr_[row_] && idx_ < rowptr_[row_+1]
   void fast_forward_row() noexcept {
-    while (row_ < row_dim_ - 1 && idx_ >= rowptr_[row_ + 1]) {
+    while (size_type(row_) + 1 < size_type(row_dim_) &&
+           idx_ >= size_type(rowptr_[row_ + 1])) {
       row_++;
     }
   }
@@ -176,7 +180,7 @@ public:
   // That is:
   // Retreat `row_` until idx_ >= rowptr_[row_] && idx_ < rowptr_[row_+1]
   void fast_backward_row() noexcept {
-    while (idx_ < rowptr_[row_]) {
+    while (idx_ < size_type(rowptr_[row_])) {
       row_--;
     }
   }
@@ -252,11 +256,11 @@ public:
   }
 
   iterator begin() const {
-    return iterator(values_, rowptr_, colind_, 0, 0, shape()[1]);
+    return iterator(values_, rowptr_, colind_, 0, 0, shape()[0]);
   }
 
   iterator end() const {
-    return iterator(values_, rowptr_, colind_, nnz_, shape()[1], shape()[1]);
+    return iterator(values_, rowptr_, colind_, nnz_, shape()[0], shape()[0]);
   }
 
   auto values_data() const {
@@ -275,7 +279,7 @@ public:
     index_type i = key[0];
     for (index_type j_ptr = rowptr_[i]; j_ptr < rowptr_[i + 1]; j_ptr++) {
       if (colind_[j_ptr] == key[1]) {
-        return iterator(values_, rowptr_, colind_, j_ptr, i, shape()[1]);
+        return iterator(values_, rowptr_, colind_, j_ptr, i, shape()[0]);
       }
     }
     return end();
@@ -288,6 +292,14 @@ public:
                                size);
   }
 
+  /// Split the rows into `n` consecutive ranges `{first, last}` holding
+  /// about the same number of elements, as `csr_matrix::partition` does.
+  std::vector<grb::index<I>> partition(std::size_t n) const
+    requires std::is_pointer_v<IIter>
+  {
+    return __detail::partition_rows(rowptr_, shape()[0], n);
+  }
+
   auto rows() const {
     auto row_indices =
         std::ranges::views::iota(index_type(0), index_type(shape()[0]));
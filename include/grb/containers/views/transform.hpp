@@ -62,11 +62,21 @@ public:
 
 inline constexpr auto transform = transform_fn_{};
 
+// Value of every element in a `structure` view.  Being a named type lets
+// kernels recognize structure views as structural masks.
+struct structure_value_ {
+  constexpr bool operator()(auto&&) const noexcept {
+    return true;
+  }
+};
+
+/// View of the structure of `c`: every stored element of `c`, with the
+/// value `true`.  Used as a mask, it selects elements by presence alone.
 template <typename ContainerType>
   requires(std::ranges::viewable_range<ContainerType>)
 auto structure(ContainerType&& c) {
-  auto always_true = [](auto&&) -> bool { return true; };
-  return grb::views::transform(std::forward<ContainerType>(c), always_true);
+  return grb::views::transform(std::forward<ContainerType>(c),
+                               structure_value_{});
 }
 
 } // namespace views
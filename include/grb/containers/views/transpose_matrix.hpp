@@ -5,6 +5,7 @@
 #include <grb/detail/iterator_adaptor.hpp>
 #include <grb/util/index.hpp>
 
+#include <memory>
 #include <ranges>
 
 namespace grb {
@@ -34,7 +35,10 @@ public:
   transpose_matrix_accessor&
   operator=(const transpose_matrix_accessor&) noexcept = default;
 
-  transpose_matrix_accessor(Iterator iter) : iter_(iter) {}
+  // If `transposed`, `iter` already refers to the elements of the
+  // transpose, whose indices are then not swapped.
+  transpose_matrix_accessor(Iterator iter, bool transposed = false)
+      : iter_(iter), transposed_(transposed) {}
 
   transpose_matrix_accessor& operator++() noexcept {
     iter_++;
@@ -54,7 +58,11 @@ public:
 
   reference operator*() const noexcept {
     auto&& [index, value] = *iter_;
-    return reference({index[1], index[0]}, value);
+    if (transposed_) {
+      return reference({index[0], index[1]}, value);
+    } else {
+      return reference({index[1], index[0]}, value);
+    }
   }
 
   difference_type
@@ -66,6 +74,7 @@ public:
 
 private:
   Iterator iter_;
+  bool transposed_ = false;
 };
 
 template <typename Iterator>
@@ -91,6 +100,10 @@ public:
 
   using key_type = typename matrix_type::key_type;
 
+  // Like other views, the view is live: it reads the current contents of
+  // `matrix`, and modifying `matrix` invalidates its iterators.  Matrices
+  // that keep a materialized transpose, such as `grb::matrix` with
+  // `cache_transpose()` enabled, are read through their current transpose.
   transpose_matrix_view(const MatrixType& matrix) : matrix_(matrix) {}
 
   grb::index<index_type> shape() const noexcept {
@@ -101,18 +114,37 @@ public:
     return matrix_.size();
   }
 
-  iterator begin() const noexcept {
+  iterator begin() const {
+    if (auto t = materialized()) {
+      return iterator(t->begin(), true);
+    }
     return iterator(matrix_.begin());
   }
 
-  iterator end() const noexcept {
+  iterator end() const {
+    if (auto t = materialized()) {
+      return iterator(t->end(), true);
+    }
     return iterator(matrix_.end());
   }
 
-  iterator find(key_type key) const noexcept {
+  iterator find(key_type key) const {
+    if (auto t = materialized()) {
+      return iterator(t->find(key), true);
+    }
     return iterator(matrix_.find({key[1], key[0]}));
   }
 
+  // The materialized transpose of the matrix, holding the view's elements
+  // in row order, or `nullptr` if the matrix does not keep one.
+  std::shared_ptr<const matrix_type> materialized() const {
+    if constexpr (requires { matrix_.cached_transpose(); }) {
+      return matrix_.cached_transpose();
+    } else {
+      return nullptr;
+    }
+  }
+
 private:
   const MatrixType& matrix_;
 };
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <grb/detail/cpos.hpp>
 #include <ranges>
+#include <type_traits>
+#include <utility>
 
 namespace grb {
 
@@ -19,6 +22,20 @@ inline constexpr auto indices =
 inline constexpr auto values =
     std::ranges::views::transform([](auto&& e) { return grb::get<1>(e); });
 
+/// The values of the container `r`: the span of its value array for lvalue
+/// matrices with `grb::raw_arrays`, and `r | grb::views::values` otherwise.
+inline constexpr struct stored_values_fn_ {
+  template <std::ranges::viewable_range R>
+  auto operator()(R&& r) const {
+    if constexpr (std::is_lvalue_reference_v<R> &&
+                  requires { grb::raw_arrays(r); }) {
+      return grb::raw_arrays(r).values;
+    } else {
+      return std::forward<R>(r) | values;
+    }
+  }
+} stored_values{};
+
 } // namespace views
 
 } // namespace grb
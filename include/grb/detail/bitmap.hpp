@@ -0,0 +1,162 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace grb {
+
+namespace detail {
+
+// A fixed-size set of bits packed into 64-bit words.  Unlike
+// `std::vector<bool>`, the underlying words are exposed so that kernels can
+// test, combine and scan 64 indices at a time.
+template <typename Allocator = std::allocator<std::uint64_t>>
+class bitmap {
+public:
+  using word_type = std::uint64_t;
+  using size_type = std::size_t;
+  using allocator_type = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<word_type>;
+
+  static constexpr size_type word_bits = 64;
+
+  bitmap() = default;
+
+  explicit bitmap(const allocator_type& allocator) : words_(allocator) {}
+
+  explicit bitmap(size_type size, bool value = false,
+                  const allocator_type& allocator = allocator_type())
+      : words_(num_words(size), value ? ~word_type(0) : word_type(0),
+               allocator),
+        size_(size) {
+    clear_tail();
+  }
+
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  allocator_type get_allocator() const noexcept {
+    return words_.get_allocator();
+  }
+
+  bool test(size_type i) const noexcept {
+    return (words_[i / word_bits] >> (i % word_bits)) & word_type(1);
+  }
+
+  void set(size_type i) noexcept {
+    words_[i / word_bits] |= word_type(1) << (i % word_bits);
+  }
+
+  void reset(size_type i) noexcept {
+    words_[i / word_bits] &= ~(word_type(1) << (i % word_bits));
+  }
+
+  void assign(size_type i, bool value) noexcept {
+    if (value) {
+      set(i);
+    } else {
+      reset(i);
+    }
+  }
+
+  // Number of set bits.
+  size_type count() const noexcept {
+    size_type n = 0;
+    for (auto&& word : words_) {
+      n += std::popcount(word);
+    }
+    return n;
+  }
+
+  // Index of the first set bit at or after `i`, or `size()` if there is
+  // none.  Skips over clear words 64 bits at a time.
+  size_type find_next(size_type i) const noexcept {
+    if (i >= size_) {
+      return size_;
+    }
+
+    size_type w = i / word_bits;
+    word_type word = words_[w] & (~word_type(0) << (i % word_bits));
+
+    while (word == 0) {
+      if (++w == words_.size()) {
+        return size_;
+      }
+      word = words_[w];
+    }
+
+    return w * word_bits + std::countr_zero(word);
+  }
+
+  // Index of the first clear bit at or after `i`, or `size()` if there is
+  // none.  Skips over full words 64 bits at a time.
+  size_type find_next_unset(size_type i) const noexcept {
+    if (i >= size_) {
+      return size_;
+    }
+
+    size_type w = i / word_bits;
+    word_type word = ~words_[w] & (~word_type(0) << (i % word_bits));
+
+    while (word == 0) {
+      if (++w == words_.size()) {
+        return size_;
+      }
+      word = ~words_[w];
+    }
+
+    size_type idx = w * word_bits + std::countr_zero(word);
+    return idx < size_ ? idx : size_;
+  }
+
+  void resize(size_type size, bool value = false) {
+    size_type old_size = size_;
+    words_.resize(num_words(size), value ? ~word_type(0) : word_type(0));
+    size_ = size;
+    if (value && old_size < size) {
+      // Bits past the old size in its last word were kept clear.
+      for (size_type i = old_size; i < size && i % word_bits != 0; i++) {
+        set(i);
+      }
+    }
+    clear_tail();
+  }
+
+  word_type* data() noexcept {
+    return words_.data();
+  }
+
+  const word_type* data() const noexcept {
+    return words_.data();
+  }
+
+  // Number of words holding the bitmap's bits.  Bits past `size()` in the
+  // last word are always clear.
+  size_type word_count() const noexcept {
+    return words_.size();
+  }
+
+  static constexpr size_type num_words(size_type size) noexcept {
+    return (size + word_bits - 1) / word_bits;
+  }
+
+  bool operator==(const bitmap&) const noexcept = default;
+
+private:
+  void clear_tail() noexcept {
+    if (size_ % word_bits != 0) {
+      words_.back() &= (word_type(1) << (size_ % word_bits)) - 1;
+    }
+  }
+
+  std::vector<word_type, allocator_type> words_;
+  size_type size_ = 0;
+};
+
+} // namespace detail
+
+} // namespace grb
@@ -2,14 +2,19 @@
 
 #include <any>
 #include <concepts>
+#include <cstddef>
 #include <grb/detail/matrix_traits.hpp>
 #include <grb/detail/tag_invoke.hpp>
 #include <ranges>
+#include <span>
 #include <type_traits>
 #include <utility>
 
 namespace grb {
 
+template <std::integral T>
+class index;
+
 // Helper concepts for CPOs.
 
 namespace {
@@ -50,8 +55,33 @@ concept has_insert_or_assign_method = requires(T t, M obj) {
   };
 };
 
+template <typename T>
+concept has_csr_arrays = requires(T& t) {
+  t.shape();
+  requires std::is_pointer_v<decltype(t.rowptr_data())>;
+  requires std::is_pointer_v<decltype(t.colind_data())>;
+  requires std::is_pointer_v<decltype(t.values_data())>;
+};
+
+template <typename T>
+concept has_csr_backend = requires(T& t) {
+  requires has_csr_arrays<std::remove_reference_t<decltype(t.backend())>>;
+};
+
 } // namespace
 
+/// The arrays of a CSR matrix, returned by `grb::raw_arrays`: `rowptr`, the
+/// `shape[0] + 1` offsets of the rows' elements, and `colind` and `values`,
+/// the column index and value of each element, sorted by column within each
+/// row.  `T` is const for read-only matrices.
+template <typename T, typename I>
+struct csr_arrays {
+  grb::index<I> shape;
+  std::span<const I> rowptr;
+  std::span<const I> colind;
+  std::span<T> values;
+};
+
 inline constexpr struct shape_fn_ {
   template <typename T>
   auto operator()(T&& x) const
@@ -135,4 +165,36 @@ inline constexpr struct insert_or_assign_fn_ {
   }
 } insert_or_assign{};
 
+/// Bulk access to the storage of matrices that keep their elements in
+/// arrays, such as CSR-backed `grb::matrix`, `grb::csr_matrix` and
+/// `grb::csr_matrix_view`: a `grb::csr_arrays` of spans over the storage of
+/// `x`, which must outlive them.  Loops over the spans compile to plain
+/// array accesses, unlike iteration, which goes through proxy references.
+/// Algorithms use it whenever `grb::raw_arrays(x)` is valid.
+inline constexpr struct raw_arrays_fn_ {
+  template <typename T>
+  auto operator()(T& x) const
+    requires(grb::is_tag_invocable_v<raw_arrays_fn_, T&> ||
+             has_csr_backend<T> || has_csr_arrays<T>)
+  {
+    if constexpr (grb::is_tag_invocable_v<raw_arrays_fn_, T&>) {
+      return grb::tag_invoke(*this, x);
+    } else if constexpr (has_csr_backend<T>) {
+      return (*this)(x.backend());
+    } else if constexpr (has_csr_arrays<T>) {
+      using I = std::remove_cvref_t<decltype(*x.rowptr_data())>;
+      using V = std::remove_reference_t<decltype(*x.values_data())>;
+
+      auto shape = x.shape();
+      auto rowptr = x.rowptr_data();
+      std::size_t nnz = rowptr[shape[0]];
+      return grb::csr_arrays<V, I>{
+          grb::index<I>(shape[0], shape[1]),
+          {rowptr, std::size_t(shape[0]) + 1},
+          {x.colind_data(), nnz},
+          {x.values_data(), nnz}};
+    }
+  }
+} raw_arrays{};
+
 } // namespace grb
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <grb/containers/backend/csr_matrix.hpp>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+namespace __detail {
+
+// Matrices, such as `grb::csr_matrix`, whose CSR arrays can be read and
+// written directly.
+template <typename M>
+concept CSRStorage = requires(M& m) {
+  m.rowptr_data();
+  m.colind_data();
+  m.values_data();
+  m.resize_storage(std::size_t(0));
+};
+
+// Read-only CSR matrices read from storage, such as
+// `grb::mapped_csr_matrix`, whose `rows(first, last)` prefetches rows ahead
+// of a traversal in row order.
+template <typename M>
+concept PrefetchedCSR = requires(const M& m, typename M::index_type i) {
+  m.rowptr_data();
+  m.colind_data();
+  m.values_data();
+  m.prefetch(i, i);
+  m.rows(i, i);
+};
+
+// The storage holding the elements of `m`: its backend, for containers such
+// as `grb::matrix`, or `m` itself.
+template <typename M>
+decltype(auto) storage_of(M& m) {
+  if constexpr (requires { m.backend(); }) {
+    return m.backend();
+  } else {
+    return (m);
+  }
+}
+
+// Copy the elements of `matrix`, in any order, into a new CSR matrix with a
+// counting sort by row.
+template <typename T, typename I, typename M>
+grb::csr_matrix<T, I> csr_from_elements(M&& matrix) {
+  std::size_t m = matrix.shape()[0];
+  std::size_t n = matrix.shape()[1];
+
+  grb::csr_matrix<T, I> csr({I(m), I(n)});
+  csr.resize_storage(matrix.size());
+  I* rowptr = csr.rowptr_data();
+  I* colind = csr.colind_data();
+  T* values = csr.values_data();
+  std::fill(rowptr, rowptr + m + 1, I(0));
+
+  for (auto&& [index, _] : matrix) {
+    auto&& [i, j] = index;
+    rowptr[i + 1]++;
+  }
+  for (std::size_t i = 0; i < m; i++) {
+    rowptr[i + 1] += rowptr[i];
+  }
+
+  std::vector<I> next(rowptr, rowptr + m);
+  for (auto&& [index, value] : matrix) {
+    auto&& [i, j] = index;
+    I dest = next[i]++;
+    colind[dest] = I(j);
+    values[dest] = value;
+  }
+
+  // Backends that do not iterate in row order may leave rows unsorted.
+  std::vector<std::pair<I, T>> row;
+  for (std::size_t i = 0; i < m; i++) {
+    if (!std::is_sorted(colind + rowptr[i], colind + rowptr[i + 1])) {
+      row.clear();
+      for (I k = rowptr[i]; k < rowptr[i + 1]; k++) {
+        row.emplace_back(colind[k], values[k]);
+      }
+      std::sort(row.begin(), row.end(), [](auto&& x, auto&& y) {
+        return x.first < y.first;
+      });
+      for (std::size_t k = 0; k < row.size(); k++) {
+        colind[rowptr[i] + k] = row[k].first;
+        values[rowptr[i] + k] = row[k].second;
+      }
+    }
+  }
+
+  return csr;
+}
+
+} // namespace __detail
+
+} // namespace grb
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <initializer_list>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#if defined(__linux__)
+#define GRB_HAS_HUGE_PAGES 1
+#include <sys/mman.h>
+#endif
+
+namespace grb {
+
+namespace detail {
+
+// Size of a huge page on x86-64 and AArch64 with 4 KiB base pages, and the
+// alignment of huge-page allocations.
+inline constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+// Bytes currently mapped for huge-page allocations, and the part of them
+// backed by explicitly reserved (hugetlb) pages.
+inline std::atomic<std::size_t> huge_page_mapped_bytes = 0;
+inline std::atomic<std::size_t> huge_page_hugetlb_bytes = 0;
+
+// Addresses of the mappings backed by reserved huge pages, which must be
+// unmapped as such and cannot be remapped.
+class hugetlb_registry {
+public:
+  static hugetlb_registry& instance() {
+    static hugetlb_registry registry;
+    return registry;
+  }
+
+  void insert(void* data) {
+    std::lock_guard lock(mutex_);
+    mappings_.insert(data);
+  }
+
+  bool erase(void* data) {
+    std::lock_guard lock(mutex_);
+    return mappings_.erase(data) > 0;
+  }
+
+  bool contains(void* data) const {
+    std::lock_guard lock(mutex_);
+    return mappings_.contains(data);
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_set<void*> mappings_;
+};
+
+inline std::size_t round_to_huge_pages(std::size_t bytes) {
+  return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+
+#ifdef GRB_HAS_HUGE_PAGES
+
+// Map `bytes` bytes, a multiple of `huge_page_size`, aligned to a huge page
+// with protection `prot`, by over-allocating by one huge page and trimming
+// both ends.  Returns `nullptr` if no memory can be mapped.
+inline void* map_aligned_pages(std::size_t bytes, int prot) {
+  std::size_t padded = bytes + huge_page_size;
+  void* raw =
+      ::mmap(nullptr, padded, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    return nullptr;
+  }
+
+  auto first = reinterpret_cast<std::uintptr_t>(raw);
+  auto aligned = (first + huge_page_size - 1) / huge_page_size * huge_page_size;
+  if (aligned > first) {
+    ::munmap(raw, aligned - first);
+  }
+  if (first + padded > aligned + bytes) {
+    ::munmap(reinterpret_cast<void*>(aligned + bytes),
+             first + padded - (aligned + bytes));
+  }
+  return reinterpret_cast<void*>(aligned);
+}
+
+// Map `bytes` bytes, a multiple of `huge_page_size`, aligned to a huge page.
+// With `hugetlb`, reserved huge pages are tried first; otherwise, or if none
+// are available, the mapping is advised to use transparent huge pages.
+// Returns `nullptr` if no memory can be mapped.
+inline void* map_huge_pages(std::size_t bytes, bool hugetlb) {
+#ifdef MAP_HUGETLB
+  if (hugetlb) {
+    void* data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      hugetlb_registry::instance().insert(data);
+      huge_page_mapped_bytes += bytes;
+      huge_page_hugetlb_bytes += bytes;
+      return data;
+    }
+  }
+#endif
+
+  void* data = map_aligned_pages(bytes, PROT_READ | PROT_WRITE);
+  if (data == nullptr) {
+    return nullptr;
+  }
+#ifdef MADV_HUGEPAGE
+  ::madvise(data, bytes, MADV_HUGEPAGE);
+#endif
+  huge_page_mapped_bytes += bytes;
+  return data;
+}
+
+inline void unmap_huge_pages(void* data, std::size_t bytes) {
+  ::munmap(data, bytes);
+  huge_page_mapped_bytes -= bytes;
+  if (hugetlb_registry::instance().erase(data)) {
+    huge_page_hugetlb_bytes -= bytes;
+  }
+}
+
+// Grow or shrink the mapping `data` from `old_bytes` to `new_bytes` without
+// copying.  A mapping that cannot grow in place is moved into a new
+// reservation aligned to a huge page.  Returns `nullptr` if the mapping
+// cannot be remapped, as for reserved huge pages.
+inline void* remap_huge_pages(void* data, std::size_t old_bytes,
+                              std::size_t new_bytes) {
+#if defined(MREMAP_MAYMOVE) && defined(MREMAP_FIXED)
+  if (hugetlb_registry::instance().contains(data)) {
+    return nullptr;
+  }
+  void* moved = ::mremap(data, old_bytes, new_bytes, 0);
+  if (moved == MAP_FAILED) {
+    // `mremap` replaces the inaccessible reservation with the moved pages.
+    void* target = map_aligned_pages(new_bytes, PROT_NONE);
+    if (target == nullptr) {
+      return nullptr;
+    }
+    moved = ::mremap(data, old_bytes, new_bytes,
+                     MREMAP_MAYMOVE | MREMAP_FIXED, target);
+    if (moved == MAP_FAILED) {
+      ::munmap(target, new_bytes);
+      return nullptr;
+    }
+  }
+#ifdef MADV_HUGEPAGE
+  ::madvise(moved, new_bytes, MADV_HUGEPAGE);
+#endif
+  huge_page_mapped_bytes += new_bytes;
+  huge_page_mapped_bytes -= old_bytes;
+  return moved;
+#else
+  return nullptr;
+#endif
+}
+
+#endif
+
+// Bytes of the address ranges `ranges`, given as pointer and size, that are
+// currently backed by huge pages, transparent or reserved, according to
+// `/proc/self/smaps`.  Mappings are only reported as a whole, so the huge
+// pages of a mapping are attributed to the ranges in proportion to their
+// overlap with it.  Always 0 where `/proc/self/smaps` does not exist.
+inline std::size_t huge_page_backed_bytes(
+    std::initializer_list<std::pair<const void*, std::size_t>> ranges) {
+  std::ifstream smaps("/proc/self/smaps");
+  if (!smaps.is_open()) {
+    return 0;
+  }
+
+  std::uintptr_t vma_first = 0;
+  std::uintptr_t vma_last = 0;
+  std::size_t overlap = 0;
+  double backed = 0;
+
+  for (std::string line; std::getline(smaps, line);) {
+    auto colon = line.find(':');
+    auto dash = line.find('-');
+    if (dash != std::string::npos && (colon == std::string::npos ||
+                                      dash < colon)) {
+      // A mapping header, "first-last perms offset dev inode path".
+      vma_first = std::stoull(line.substr(0, dash), nullptr, 16);
+      vma_last = std::stoull(line.substr(dash + 1), nullptr, 16);
+      overlap = 0;
+      for (auto&& [data, bytes] : ranges) {
+        auto first = std::max(reinterpret_cast<std::uintptr_t>(data),
+                              vma_first);
+        auto last = std::min(reinterpret_cast<std::uintptr_t>(data) + bytes,
+                             vma_last);
+        overlap += last > first ? last - first : 0;
+      }
+      continue;
+    }
+
+    if (overlap == 0 || colon == std::string::npos) {
+      continue;
+    }
+
+    auto field = line.substr(0, colon);
+    if (field == "AnonHugePages" || field == "Private_Hugetlb" ||
+        field == "Shared_Hugetlb") {
+      std::size_t kb = 0;
+      std::istringstream(line.substr(colon + 1)) >> kb;
+      backed += double(kb) * 1024 * overlap / (vma_last - vma_first);
+    }
+  }
+
+  return std::size_t(backed);
+}
+
+} // namespace detail
+
+} // namespace grb
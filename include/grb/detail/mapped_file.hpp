@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GRB_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace grb {
+
+namespace detail {
+
+// Read-only view of a whole file.  The file is memory-mapped where mmap is
+// available, so that pages are read on demand and shared with the page
+// cache, and read into memory otherwise.
+class mapped_file {
+public:
+  explicit mapped_file(const std::string& path) {
+#ifdef GRB_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("mapped_file: cannot open " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("mapped_file: cannot stat " + path);
+    }
+    size_ = st.st_size;
+
+    if (size_ > 0) {
+      void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("mapped_file: cannot map " + path);
+      }
+      data_ = static_cast<const char*>(data);
+      mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+      throw std::runtime_error("mapped_file: cannot open " + path);
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(f),
+                   std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  mapped_file(mapped_file&& other) noexcept {
+    swap(other);
+  }
+
+  mapped_file& operator=(mapped_file&& other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~mapped_file() {
+#ifdef GRB_HAS_MMAP
+    if (mapped_) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+  }
+
+  // Hint that the file will be read sequentially.
+  void advise_sequential() const noexcept {
+#ifdef GRB_HAS_MMAP
+    if (mapped_) {
+      ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    }
+#endif
+  }
+
+  // Ask the kernel to read the pages of `[data, data + bytes)`, a range of
+  // the file, in the background.
+  void advise_willneed(const void* data, std::size_t bytes) const noexcept {
+#ifdef GRB_HAS_MMAP
+    if (mapped_ && bytes > 0) {
+      static const std::size_t page = std::size_t(::sysconf(_SC_PAGESIZE));
+      auto first = reinterpret_cast<std::uintptr_t>(data) / page * page;
+      auto last = reinterpret_cast<std::uintptr_t>(data) + bytes;
+      ::madvise(reinterpret_cast<void*>(first), last - first, MADV_WILLNEED);
+    }
+#endif
+  }
+
+  const char* data() const noexcept {
+    return data_;
+  }
+
+  std::size_t size() const noexcept {
+    return size_;
+  }
+
+  std::string_view view() const noexcept {
+    return std::string_view(data_, size_);
+  }
+
+private:
+  void swap(mapped_file& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(mapped_, other.mapped_);
+    std::swap(buffer_, other.buffer_);
+  }
+
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<char> buffer_;
+};
+
+} // namespace detail
+
+} // namespace grb
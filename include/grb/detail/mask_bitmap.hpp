@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <grb/containers/views/complement_view.hpp>
+#include <grb/detail/bitmap.hpp>
+#include <grb/detail/get.hpp>
+#include <grb/detail/mask_traits.hpp>
+#include <type_traits>
+
+namespace grb {
+
+namespace detail {
+
+template <typename M>
+struct is_complement_view : std::false_type {};
+
+template <typename V>
+struct is_complement_view<grb::complement_view<V>> : std::true_type {};
+
+template <typename M>
+inline constexpr bool is_complement_view_v =
+    is_complement_view<std::remove_cvref_t<M>>::value;
+
+// A vector mask evaluated once, up front, into a bitmap of the indices it
+// allows, so that kernels test the mask with a single bit test instead of
+// a `find` per element.  Structural masks over a `grb::vector` reuse the
+// vector's own presence bitmap without copying it.  Bitmaps are allocated
+// with `Allocator`.
+template <typename Allocator = std::allocator<std::uint64_t>>
+class vector_mask_bitmap {
+public:
+  using bitmap_type = grb::detail::bitmap<Allocator>;
+  using word_type = typename bitmap_type::word_type;
+  using size_type = std::size_t;
+
+  // Evaluate `mask` for the indices `[0, shape)`.
+  template <typename M>
+  vector_mask_bitmap(const M& mask, size_type shape,
+                     const Allocator& allocator = Allocator())
+      : owned_(allocator) {
+    using mask_type = std::remove_cvref_t<M>;
+
+    if constexpr (is_full_mask_v<mask_type>) {
+      full_ = true;
+      size_ = std::min<size_type>(mask.shape(), shape);
+    } else if constexpr (BitmapStructureMask<mask_type>) {
+      auto&& flags = mask.base().backend().flags();
+      words_ = flags.data();
+      size_ = std::min<size_type>(flags.size(), shape);
+    } else {
+      owned_.resize(shape);
+      evaluate_(mask, owned_);
+      words_ = owned_.data();
+      size_ = shape;
+    }
+  }
+
+  vector_mask_bitmap(const vector_mask_bitmap&) = delete;
+  vector_mask_bitmap& operator=(const vector_mask_bitmap&) = delete;
+
+  bool test(size_type i) const noexcept {
+    if (i >= size_) {
+      return false;
+    }
+    return full_ ||
+           ((words_[i / bitmap_type::word_bits] >>
+             (i % bitmap_type::word_bits)) &
+            word_type(1));
+  }
+
+private:
+  // Set in `bits` the indices allowed by `mask`.
+  template <typename M>
+  static void evaluate_(const M& mask, bitmap_type& bits) {
+    using mask_type = std::remove_cvref_t<M>;
+    size_type n = std::min<size_type>(mask.shape(), bits.size());
+
+    if constexpr (is_full_mask_v<mask_type>) {
+      for (size_type i = 0; i < n; i++) {
+        bits.set(i);
+      }
+    } else if constexpr (is_complement_view_v<mask_type>) {
+      bitmap_type base_bits(n, false, bits.get_allocator());
+      evaluate_(mask.base(), base_bits);
+      for (size_type i = base_bits.find_next_unset(0); i < n;
+           i = base_bits.find_next_unset(i + 1)) {
+        bits.set(i);
+      }
+    } else if constexpr (is_structural_mask_v<mask_type>) {
+      set_present_<false>(mask.base(), bits, n);
+    } else {
+      set_present_<true>(mask, bits, n);
+    }
+  }
+
+  // Set in `bits` the indices below `n` at which `v` holds an element, or,
+  // if `Valued`, an element whose value converts to `true`.
+  template <bool Valued, typename V>
+  static void set_present_(const V& v, bitmap_type& bits, size_type n) {
+    if constexpr (BitmapVector<std::remove_cvref_t<V>>) {
+      auto&& flags = v.backend().flags();
+      auto&& values = v.backend().values();
+      for (size_type i = flags.find_next(0); i < n;
+           i = flags.find_next(i + 1)) {
+        if (!Valued || bool(values[i])) {
+          bits.set(i);
+        }
+      }
+    } else {
+      for (auto&& [i, value] : v) {
+        if (size_type(i) < n && (!Valued || bool(value))) {
+          bits.set(i);
+        }
+      }
+    }
+  }
+
+  bitmap_type owned_;
+  const word_type* words_ = nullptr;
+  size_type size_ = 0;
+  bool full_ = false;
+};
+
+// Whether the matrix mask `mask` allows the element at `index`.  Structural
+// masks only look up the element; valued masks also test its value.
+template <typename M>
+bool matrix_mask_allows(const M& mask,
+                        typename std::remove_cvref_t<M>::key_type index) {
+  if constexpr (is_full_mask_v<M>) {
+    return true;
+  } else {
+    auto iter = mask.find(index);
+    if (iter == mask.end()) {
+      return false;
+    }
+    if constexpr (is_structural_mask_v<M>) {
+      return true;
+    } else {
+      return bool(grb::get<1>(*iter));
+    }
+  }
+}
+
+} // namespace detail
+
+} // namespace grb
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <grb/containers/views/full_matrix_view.hpp>
+#include <grb/containers/views/full_vector_view.hpp>
+#include <grb/containers/views/transform.hpp>
+#include <type_traits>
+
+namespace grb {
+
+/// Whether the mask `M` selects elements by their presence alone, ignoring
+/// their values.  True for masks created with `grb::views::structure`.
+template <typename M>
+struct is_structural_mask : std::false_type {};
+
+template <typename V>
+struct is_structural_mask<
+    grb::transform_vector_view<V, grb::views::structure_value_>>
+    : std::true_type {};
+
+template <typename M>
+struct is_structural_mask<
+    grb::transform_matrix_view<M, grb::views::structure_value_>>
+    : std::true_type {};
+
+template <typename M>
+inline constexpr bool is_structural_mask_v =
+    is_structural_mask<std::remove_cvref_t<M>>::value;
+
+/// Whether the mask `M` allows every element.
+template <typename M>
+struct is_full_mask : std::false_type {};
+
+template <typename I>
+struct is_full_mask<grb::full_vector_mask<I>> : std::true_type {};
+
+template <typename I>
+struct is_full_mask<grb::full_matrix_mask<I>> : std::true_type {};
+
+template <typename M>
+inline constexpr bool is_full_mask_v =
+    is_full_mask<std::remove_cvref_t<M>>::value;
+
+namespace detail {
+
+// Vectors, such as `grb::vector`, that store a presence bitmap next to a
+// dense array of values.
+template <typename V>
+concept BitmapVector = requires(const V& v) {
+  { v.backend().flags().data() } -> std::same_as<const std::uint64_t*>;
+  v.backend().flags().find_next(std::size_t(0));
+  v.backend().values()[std::size_t(0)];
+};
+
+// Structure views of a `BitmapVector`.
+template <typename M>
+concept BitmapStructureMask =
+    is_structural_mask_v<M> && requires(const M& mask) {
+      requires BitmapVector<std::remove_cvref_t<decltype(mask.base())>>;
+    };
+
+} // namespace detail
+
+} // namespace grb
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <grb/detail/parallel.hpp>
+#include <grb/detail/radix_sort.hpp>
+#include <grb/exceptions/exception.hpp>
+#include <grb/util/index.hpp>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace grb {
+
+namespace __detail {
+
+// Sort the elements `{{i, j}, value}` in `[first, last)`, given in any order,
+// into row-major order with a radix sort on their indices, and combine the
+// values of elements with the same index as `dup(dup(v0, v1), v2)...`, in
+// input order.  Calls `reserve(nnz)` once with the number of distinct
+// indices, then `write(k, i, j, value)` for the `k`th distinct index from
+// several threads.  Throws `grb::out_of_range` before calling `reserve` if
+// an index is outside `shape`.
+template <typename T, typename I, std::forward_iterator Iter, typename Dup,
+          typename Reserve, typename Write>
+void build_elements(Iter first, Iter last, grb::index<I> shape, Dup&& dup,
+                    Reserve&& reserve, Write&& write) {
+  std::size_t m = shape[0];
+  std::size_t n = shape[1];
+  std::size_t size = std::distance(first, last);
+
+  std::vector<I> rows(size);
+  std::vector<I> cols(size);
+  auto values = std::make_unique<T[]>(size);
+
+  auto gather = [&](std::size_t k, std::size_t k_last, Iter iter) {
+    for (; k < k_last; ++k, ++iter) {
+      auto&& [index, value] = *iter;
+      auto&& [i, j] = index;
+      if (std::size_t(i) >= m || std::size_t(j) >= n) {
+        throw grb::out_of_range("matrix::build: index {" + std::to_string(i) +
+                                ", " + std::to_string(j) +
+                                "} is out of bounds for a " +
+                                std::to_string(m) + " x " + std::to_string(n) +
+                                " matrix.");
+      }
+      rows[k] = I(i);
+      cols[k] = I(j);
+      values[k] = value;
+    }
+  };
+
+  std::size_t nthreads = grb::detail::num_threads(size);
+  if constexpr (std::random_access_iterator<Iter>) {
+    grb::detail::parallel_for(
+        size, nthreads, [&](std::size_t, std::size_t k, std::size_t k_last) {
+          gather(k, k_last, first + k);
+        });
+  } else {
+    gather(0, size, first);
+  }
+
+  // Sort on `i * 2^col_bits + j` when it fits in 64 bits, otherwise by
+  // column and then stably by row.
+  std::size_t row_bits = std::bit_width(std::max<std::size_t>(m, 1) - 1);
+  std::size_t col_bits = std::bit_width(std::max<std::size_t>(n, 1) - 1);
+  bool packed = row_bits + col_bits <= 64;
+
+  std::vector<grb::detail::radix_item> items(size);
+  grb::detail::parallel_for(
+      size, nthreads, [&](std::size_t, std::size_t k, std::size_t k_last) {
+        for (; k < k_last; k++) {
+          std::uint64_t key = std::uint64_t(cols[k]);
+          if (packed && row_bits > 0) {
+            key |= std::uint64_t(rows[k]) << col_bits;
+          }
+          items[k] = {key, k};
+        }
+      });
+
+  if (packed) {
+    grb::detail::radix_sort(items, row_bits + col_bits);
+  } else {
+    grb::detail::radix_sort(items, col_bits);
+    grb::detail::parallel_for(
+        size, nthreads, [&](std::size_t, std::size_t k, std::size_t k_last) {
+          for (; k < k_last; k++) {
+            items[k].key = std::uint64_t(rows[items[k].position]);
+          }
+        });
+    grb::detail::radix_sort(items, row_bits);
+  }
+
+  auto same_index = [&](const grb::detail::radix_item& x,
+                        const grb::detail::radix_item& y) {
+    if (packed) {
+      return x.key == y.key;
+    } else {
+      return rows[x.position] == rows[y.position] &&
+             cols[x.position] == cols[y.position];
+    }
+  };
+
+  // Split the sorted elements into blocks that each start at a new index,
+  // so that every run of duplicates is combined by a single thread.
+  std::vector<std::size_t> bounds(nthreads + 1, size);
+  bounds[0] = 0;
+  for (std::size_t t = 1; t < nthreads; t++) {
+    std::size_t k = std::max(size * t / nthreads, bounds[t - 1]);
+    while (k > 0 && k < size && same_index(items[k - 1], items[k])) {
+      k++;
+    }
+    bounds[t] = k;
+  }
+
+  std::vector<std::size_t> offsets(nthreads + 1, 0);
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    std::size_t count = 0;
+    for (std::size_t k = bounds[t]; k < bounds[t + 1]; k++) {
+      if (k == bounds[t] || !same_index(items[k - 1], items[k])) {
+        count++;
+      }
+    }
+    offsets[t + 1] = count;
+  });
+  for (std::size_t t = 0; t < nthreads; t++) {
+    offsets[t + 1] += offsets[t];
+  }
+
+  reserve(offsets[nthreads]);
+
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    std::size_t out = offsets[t];
+    std::size_t k = bounds[t];
+    while (k < bounds[t + 1]) {
+      std::size_t position = items[k].position;
+      T value = std::move(values[position]);
+      for (k++; k < bounds[t + 1] && same_index(items[k - 1], items[k]);
+           k++) {
+        value = dup(std::move(value), std::move(values[items[k].position]));
+      }
+      write(out++, rows[position], cols[position], std::move(value));
+    }
+  });
+}
+
+} // namespace __detail
+
+} // namespace grb
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <grb/exceptions/exception.hpp>
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace grb {
+
+/// Value of `grb::memory_budget()` when no budget is set.
+inline constexpr std::size_t unlimited_memory =
+    std::numeric_limits<std::size_t>::max();
+
+namespace detail {
+
+// Bytes currently allocated through `grb::allocator`.
+inline std::atomic<std::size_t> live_bytes = 0;
+
+// Parse a byte count such as "4096", "512M" or "8G".
+inline std::size_t parse_bytes(const char* text) {
+  char* end = nullptr;
+  std::size_t bytes = std::strtoull(text, &end, 10);
+  switch (end != nullptr ? *end : '\0') {
+  case 'k':
+  case 'K':
+    return bytes << 10;
+  case 'm':
+  case 'M':
+    return bytes << 20;
+  case 'g':
+  case 'G':
+    return bytes << 30;
+  case 't':
+  case 'T':
+    return bytes << 40;
+  default:
+    return bytes;
+  }
+}
+
+// The global memory budget, initially the value of the `GRB_MEMORY_BUDGET`
+// environment variable if set, and otherwise unlimited.
+inline std::atomic<std::size_t>& memory_budget() {
+  static std::atomic<std::size_t> budget = [] {
+    if (const char* env = std::getenv("GRB_MEMORY_BUDGET")) {
+      if (std::size_t bytes = parse_bytes(env); bytes > 0) {
+        return bytes;
+      }
+    }
+    return unlimited_memory;
+  }();
+  return budget;
+}
+
+// Bytes that can still be allocated within the memory budget.
+inline std::size_t available_memory() noexcept {
+  std::size_t budget = memory_budget().load();
+  std::size_t live = live_bytes.load();
+  return budget > live ? budget - live : 0;
+}
+
+// Throw `grb::out_of_memory` if `operation` cannot allocate `bytes` more
+// bytes within the memory budget.
+inline void require_memory(std::size_t bytes, const char* operation) {
+  std::size_t available = available_memory();
+  if (bytes > available) {
+    throw grb::out_of_memory(std::string(operation) + ": needs " +
+                                 std::to_string(bytes) + " bytes, but only " +
+                                 std::to_string(available) +
+                                 " bytes of the memory budget are available",
+                             bytes, available);
+  }
+}
+
+} // namespace detail
+
+/// The default allocator of GraphBLAS containers: `std::allocator`, counting
+/// the bytes it holds in `grb::live_bytes()`.
+template <typename T>
+class allocator : public std::allocator<T> {
+public:
+  using value_type = T;
+
+  allocator() noexcept = default;
+
+  template <typename U>
+  allocator(const allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    T* p = std::allocator<T>::allocate(n);
+    grb::detail::live_bytes.fetch_add(n * sizeof(T),
+                                      std::memory_order_relaxed);
+    return p;
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    grb::detail::live_bytes.fetch_sub(n * sizeof(T),
+                                      std::memory_order_relaxed);
+    std::allocator<T>::deallocate(p, n);
+  }
+};
+
+/// Bytes currently held by all containers, and algorithm temporaries, that
+/// allocate with `grb::allocator`, the default allocator.
+inline std::size_t live_bytes() noexcept {
+  return grb::detail::live_bytes.load(std::memory_order_relaxed);
+}
+
+/// The global memory budget.  Algorithms that plan their memory, such as
+/// matrix-matrix `grb::multiply`, choose a strategy that fits in the budget
+/// left over by `grb::live_bytes()`, or throw `grb::out_of_memory` before
+/// allocating.  Initially the value of the `GRB_MEMORY_BUDGET` environment
+/// variable, in bytes with an optional `K`, `M`, `G` or `T` suffix, or
+/// `grb::unlimited_memory`.
+inline std::size_t memory_budget() noexcept {
+  return grb::detail::memory_budget().load();
+}
+
+/// Set the global memory budget to `bytes`.
+inline void set_memory_budget(std::size_t bytes) noexcept {
+  grb::detail::memory_budget() = bytes;
+}
+
+} // namespace grb
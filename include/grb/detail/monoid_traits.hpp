@@ -1,7 +1,7 @@
-
 #pragma once
 
 #include <any>
+#include <functional>
 #include <type_traits>
 
 namespace grb {
@@ -23,6 +23,55 @@ inline constexpr bool has_identity_method_v = requires {
   { Fn::identity() } -> std::same_as<T>;
 };
 
+template <typename Fn, typename T>
+inline constexpr bool has_terminal_template_v = requires {
+  { Fn::template terminal<T>() } -> std::same_as<T>;
+};
+
+template <typename Fn, typename T>
+inline constexpr bool has_terminal_method_v = requires {
+  { Fn::terminal() } -> std::same_as<T>;
+};
+
+/// Whether `op(a, b) == op(b, a)`, so that reductions over `Fn`
+/// may be reordered.
+template <typename Fn>
+inline constexpr bool is_commutative_v = requires {
+  requires std::remove_cvref_t<Fn>::commutative;
+};
+
+/// Whether `op(a, a) == a`, so that duplicate contributions to a
+/// reduction over `Fn` do not change its result.
+template <typename Fn>
+inline constexpr bool is_idempotent_v = requires {
+  requires std::remove_cvref_t<Fn>::idempotent;
+};
+
+/// Whether any one of the operands is an acceptable result of `Fn`, so
+/// that a reduction over `Fn` may stop as soon as it holds a value.
+template <typename Fn>
+inline constexpr bool is_any_op_v = requires {
+  requires std::remove_cvref_t<Fn>::any;
+};
+
+template <typename T>
+inline constexpr bool is_commutative_v<std::plus<T>> = true;
+
+template <typename T>
+inline constexpr bool is_commutative_v<std::multiplies<T>> = true;
+
+template <typename T>
+inline constexpr bool is_commutative_v<std::logical_and<T>> = true;
+
+template <typename T>
+inline constexpr bool is_commutative_v<std::logical_or<T>> = true;
+
+template <typename T>
+inline constexpr bool is_idempotent_v<std::logical_and<T>> = true;
+
+template <typename T>
+inline constexpr bool is_idempotent_v<std::logical_or<T>> = true;
+
 template <typename Fn, typename T>
   requires(is_binary_op_v<Fn, T, T, T> &&
            (has_identity_method_v<Fn, T> || has_identity_template_v<Fn, T>))
@@ -35,6 +84,22 @@ public:
       return Fn::template identity<T>();
     }
   }
+
+  /// The annihilator of the monoid: once a reduction holds this
+  /// value, further reductions cannot change it.
+  static constexpr T terminal() noexcept
+    requires(has_terminal_method_v<Fn, T> || has_terminal_template_v<Fn, T>)
+  {
+    if constexpr (has_terminal_method_v<Fn, T>) {
+      return Fn::terminal();
+    } else if constexpr (has_terminal_template_v<Fn, T>) {
+      return Fn::template terminal<T>();
+    }
+  }
+
+  static constexpr bool is_commutative = grb::is_commutative_v<Fn>;
+  static constexpr bool is_idempotent = grb::is_idempotent_v<Fn>;
+  static constexpr bool is_any = grb::is_any_op_v<Fn>;
 };
 
 template <typename T>
@@ -43,6 +108,10 @@ public:
   static constexpr T identity() noexcept {
     return T(0);
   }
+
+  static constexpr bool is_commutative = true;
+  static constexpr bool is_idempotent = false;
+  static constexpr bool is_any = false;
 };
 
 template <typename T>
@@ -51,6 +120,10 @@ public:
   static constexpr T identity() noexcept {
     return T(0);
   }
+
+  static constexpr bool is_commutative = true;
+  static constexpr bool is_idempotent = false;
+  static constexpr bool is_any = false;
 };
 
 template <typename Fn, typename T>
@@ -58,10 +131,38 @@ inline constexpr bool has_identity_v = requires {
   { grb::monoid_traits<Fn, T>::identity() } -> std::same_as<T>;
 };
 
+template <typename Fn, typename T>
+inline constexpr bool has_terminal_v = requires {
+  { grb::monoid_traits<Fn, T>::terminal() } -> std::same_as<T>;
+};
+
 template <typename Fn, typename T>
 inline constexpr bool is_monoid_v =
     is_binary_op_v<Fn, T, T, T> && has_identity_v<Fn, T>;
 
+/// Whether a reduction over `Fn` currently holding `value` can be
+/// skipped, either because `value` is the monoid's terminal or because
+/// `Fn` is an "any" operator, for which every held value is final.
+template <typename Fn, typename T>
+constexpr bool is_terminal(const T& value) {
+  using fn_type = std::remove_cvref_t<Fn>;
+  if constexpr (is_any_op_v<fn_type>) {
+    return true;
+  } else if constexpr (has_terminal_v<fn_type, T>) {
+    return value == grb::monoid_traits<fn_type, T>::terminal();
+  } else {
+    return false;
+  }
+}
+
+/// Whether a reduction over `Fn` on values of type `T` can ever stop
+/// early.  Kernels use this to avoid the bookkeeping of early termination
+/// for operators that will never trigger it.
+template <typename Fn, typename T>
+inline constexpr bool has_early_exit_v =
+    is_any_op_v<std::remove_cvref_t<Fn>> ||
+    has_terminal_v<std::remove_cvref_t<Fn>, T>;
+
 template <typename Fn, typename T, typename U = T, typename V = grb::any>
 concept BinaryOperator = requires(Fn fn, T t, U u) {
   { fn(t, u) } -> std::convertible_to<V>;
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace grb {
+
+namespace detail {
+
+// Maximum number of threads used by parallel kernels: the value of the
+// `GRB_NUM_THREADS` environment variable if set, otherwise the number of
+// hardware threads.
+inline std::size_t max_threads() {
+  static std::size_t n = [] {
+    if (const char* env = std::getenv("GRB_NUM_THREADS")) {
+      long value = std::strtol(env, nullptr, 10);
+      if (value > 0) {
+        return std::size_t(value);
+      }
+    }
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  }();
+  return n;
+}
+
+// Number of threads to use for `work` units of work, giving each thread at
+// least `grain` units.
+inline std::size_t num_threads(std::size_t work, std::size_t grain = 16384) {
+  return std::clamp<std::size_t>(work / std::max<std::size_t>(grain, 1), 1,
+                                 max_threads());
+}
+
+// Call `fn(thread_id)` for `thread_id` in `[0, nthreads)`, each on its own
+// thread, and wait for all of them.  The calling thread runs `fn(0)`.  If
+// any call throws, the first exception is rethrown.
+template <typename Fn>
+void parallel_invoke(std::size_t nthreads, Fn&& fn) {
+  if (nthreads <= 1) {
+    fn(std::size_t(0));
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(nthreads);
+  std::vector<std::thread> threads;
+  threads.reserve(nthreads - 1);
+
+  auto run = [&](std::size_t id) {
+    try {
+      fn(id);
+    } catch (...) {
+      errors[id] = std::current_exception();
+    }
+  };
+
+  for (std::size_t id = 1; id < nthreads; id++) {
+    threads.emplace_back(run, id);
+  }
+  run(0);
+
+  for (auto&& thread : threads) {
+    thread.join();
+  }
+
+  for (auto&& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+// Split `[0, n)` into `nthreads` contiguous blocks and call
+// `fn(thread_id, first, last)` on each block in parallel.
+template <typename Fn>
+void parallel_for(std::size_t n, std::size_t nthreads, Fn&& fn) {
+  parallel_invoke(nthreads, [&](std::size_t id) {
+    fn(id, n * id / nthreads, n * (id + 1) / nthreads);
+  });
+}
+
+} // namespace detail
+
+} // namespace grb
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <grb/detail/parallel.hpp>
+#include <vector>
+
+namespace grb {
+
+namespace detail {
+
+// An item sorted by `radix_sort`: its key and its position in the input.
+struct radix_item {
+  std::uint64_t key;
+  std::size_t position;
+};
+
+// Stably sort `items` by key, where every key is below `2^key_bits`, with a
+// parallel least-significant-digit radix sort over 8-bit digits.  Each
+// thread counts the digits of its block of items, then scatters the block
+// after the items of the same digit in lower blocks.  Digits that are the
+// same in every item are skipped.
+inline void radix_sort(std::vector<radix_item>& items, std::size_t key_bits) {
+  constexpr std::size_t digit_bits = 8;
+  constexpr std::size_t radix = std::size_t(1) << digit_bits;
+
+  std::size_t n = items.size();
+  if (n <= 1) {
+    return;
+  }
+
+  std::size_t nthreads = num_threads(n);
+  std::vector<radix_item> buffer(n);
+  std::vector<std::size_t> offsets(nthreads * radix);
+
+  for (std::size_t shift = 0; shift < key_bits; shift += digit_bits) {
+    auto digit = [=](const radix_item& item) {
+      return std::size_t(item.key >> shift) & (radix - 1);
+    };
+
+    std::fill(offsets.begin(), offsets.end(), std::size_t(0));
+    parallel_for(n, nthreads,
+                 [&](std::size_t t, std::size_t first, std::size_t last) {
+                   std::size_t* count = offsets.data() + t * radix;
+                   for (std::size_t k = first; k < last; k++) {
+                     count[digit(items[k])]++;
+                   }
+                 });
+
+    // Turn the counts into the position of each thread's first item of
+    // each digit, ordered by digit, then by thread.
+    std::size_t offset = 0;
+    bool constant = false;
+    for (std::size_t d = 0; d < radix; d++) {
+      std::size_t digit_first = offset;
+      for (std::size_t t = 0; t < nthreads; t++) {
+        std::size_t count = offsets[t * radix + d];
+        offsets[t * radix + d] = offset;
+        offset += count;
+      }
+      constant = constant || offset - digit_first == n;
+    }
+    if (constant) {
+      continue;
+    }
+
+    parallel_for(n, nthreads,
+                 [&](std::size_t t, std::size_t first, std::size_t last) {
+                   std::size_t* next = offsets.data() + t * radix;
+                   for (std::size_t k = first; k < last; k++) {
+                     buffer[next[digit(items[k])]++] = items[k];
+                   }
+                 });
+    items.swap(buffer);
+  }
+}
+
+} // namespace detail
+
+} // namespace grb
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace grb {
+
+namespace detail {
+
+// Counter-based random number generator.  The number drawn for a given
+// seed, stream and counter never depends on which other numbers were drawn
+// before it, so parallel generators that give each row or block of work its
+// own stream produce the same output whatever the number of threads.
+class counter_rng {
+public:
+  explicit counter_rng(std::uint64_t seed) noexcept
+      : key_(mix(seed + 0x9e3779b97f4a7c15ULL)) {}
+
+  // 64 random bits for position `counter` of stream `stream`.
+  std::uint64_t operator()(std::uint64_t stream,
+                           std::uint64_t counter) const noexcept {
+    std::uint64_t x = mix(key_ + stream * 0xd1b54a32d192ed03ULL);
+    return mix(mix(x ^ (counter * 0x9e3779b97f4a7c15ULL)));
+  }
+
+  // Uniform double in [0, 1).
+  double uniform(std::uint64_t stream, std::uint64_t counter) const noexcept {
+    return double((*this)(stream, counter) >> 11) * 0x1.0p-53;
+  }
+
+private:
+  // splitmix64 finalizer.
+  static std::uint64_t mix(std::uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+  }
+
+  std::uint64_t key_;
+};
+
+// Random value of type `T` from 64 random bits: uniform in [0, 1) for
+// floating point types, and 0 or 1 otherwise.
+template <typename T>
+T random_value(std::uint64_t bits) noexcept {
+  if constexpr (std::is_same_v<T, float>) {
+    return float(bits >> 40) * 0x1.0p-24f;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return T(double(bits >> 11) * 0x1.0p-53);
+  } else {
+    return T(bits >> 63);
+  }
+}
+
+} // namespace detail
+
+} // namespace grb
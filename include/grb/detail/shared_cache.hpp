@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace grb {
+
+namespace detail {
+
+// A value of type `T` computed on first use and shared with its readers.
+// `get(build)` returns the value, calling `build()` to compute it if the
+// cache is empty, and `reset()` empties the cache.  Both are thread-safe,
+// and concurrent callers of `get` build the value only once.  Copies share
+// the cached value, which is immutable; moves take it from the source.
+template <typename T>
+class shared_cache {
+public:
+  shared_cache() = default;
+
+  shared_cache(const shared_cache& other) : value_(other.load()) {}
+
+  shared_cache(shared_cache&& other) noexcept : value_(other.take()) {}
+
+  shared_cache& operator=(const shared_cache& other) {
+    if (this != &other) {
+      auto value = other.load();
+      std::lock_guard lock(mutex_);
+      value_ = std::move(value);
+    }
+    return *this;
+  }
+
+  shared_cache& operator=(shared_cache&& other) noexcept {
+    if (this != &other) {
+      auto value = other.take();
+      std::lock_guard lock(mutex_);
+      value_ = std::move(value);
+    }
+    return *this;
+  }
+
+  template <typename Build>
+  std::shared_ptr<const T> get(Build&& build) const {
+    std::lock_guard lock(mutex_);
+    if (!value_) {
+      value_ = std::make_shared<const T>(build());
+    }
+    return value_;
+  }
+
+  void reset() noexcept {
+    std::lock_guard lock(mutex_);
+    value_.reset();
+  }
+
+private:
+  std::shared_ptr<const T> load() const {
+    std::lock_guard lock(mutex_);
+    return value_;
+  }
+
+  std::shared_ptr<const T> take() noexcept {
+    std::lock_guard lock(mutex_);
+    return std::move(value_);
+  }
+
+  mutable std::mutex mutex_;
+  mutable std::shared_ptr<const T> value_;
+};
+
+} // namespace detail
+
+} // namespace grb
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <grb/containers/backend/coo_matrix.hpp>
+#include <grb/containers/backend/dia_matrix.hpp>
+#include <grb/detail/concepts.hpp>
+#include <grb/detail/get.hpp>
+#include <grb/detail/mask_bitmap.hpp>
+#include <grb/detail/mask_traits.hpp>
+#include <grb/detail/matrix_traits.hpp>
+#include <mutex>
+#include <ranges>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+/// Whether algorithm calls are traced.  Tracing is enabled by defining
+/// `GRB_ENABLE_TRACING` before including the library; otherwise it compiles
+/// to nothing.
+#ifdef GRB_ENABLE_TRACING
+inline constexpr bool tracing_enabled = true;
+#else
+inline constexpr bool tracing_enabled = false;
+#endif
+
+/// An operand of a traced algorithm call.
+struct trace_operand {
+  /// `{rows, columns}` for matrices and `{dimension}` for vectors.
+  std::vector<std::size_t> shape;
+
+  /// Number of stored elements.
+  std::size_t nnz = 0;
+
+  /// Storage format, such as "csr", "coo" or "bitmap", or "view" for views.
+  std::string backend;
+};
+
+/// One traced algorithm call.
+struct trace_event {
+  /// Name of the algorithm, such as "multiply" or "ewise_union".
+  std::string name;
+
+  /// Implementation chosen for the call, such as "dense_semiring".
+  std::string kernel;
+
+  /// Kind of mask: "none", "value", "structure" or "complement".
+  std::string mask;
+
+  std::vector<trace_operand> operands;
+
+  /// Small integer identifying the calling thread.
+  std::size_t thread = 0;
+
+  /// Start time in microseconds since tracing started, and wall time.
+  double start_us = 0;
+  double duration_us = 0;
+
+  /// Arithmetic operations performed, counting a multiply-add as two.
+  std::size_t flops = 0;
+
+  /// Bytes of storage held by the result.
+  std::size_t bytes = 0;
+};
+
+namespace detail {
+
+// Process-wide, thread-safe list of traced events.
+class trace_log {
+public:
+  static trace_log& instance() {
+    static trace_log log;
+    return log;
+  }
+
+  void record(trace_event event) {
+    std::lock_guard lock(mutex_);
+    events_.push_back(std::move(event));
+  }
+
+  std::vector<trace_event> events() const {
+    std::lock_guard lock(mutex_);
+    return events_;
+  }
+
+  void clear() {
+    std::lock_guard lock(mutex_);
+    events_.clear();
+  }
+
+  double now_us() const {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - epoch_)
+        .count();
+  }
+
+  static std::size_t thread_id() {
+    static std::atomic<std::size_t> next = 0;
+    thread_local std::size_t id = next++;
+    return id;
+  }
+
+private:
+  std::chrono::steady_clock::time_point epoch_ =
+      std::chrono::steady_clock::now();
+  mutable std::mutex mutex_;
+  std::vector<trace_event> events_;
+};
+
+template <typename T>
+struct is_coo_matrix : std::false_type {};
+
+template <typename T, typename I, typename Allocator>
+struct is_coo_matrix<grb::coo_matrix<T, I, Allocator>> : std::true_type {};
+
+template <typename T>
+struct is_dia_matrix : std::false_type {};
+
+template <typename T, typename I, typename Allocator>
+struct is_dia_matrix<grb::dia_matrix<T, I, Allocator>> : std::true_type {};
+
+template <typename O>
+std::string backend_name(const O& o) {
+  using type = std::remove_cvref_t<O>;
+  if constexpr (requires { o.backend(); }) {
+    return backend_name(o.backend());
+  } else if constexpr (requires {
+                         o.rowptr_data();
+                         o.colind_data();
+                       }) {
+    return "csr";
+  } else if constexpr (is_coo_matrix<type>::value) {
+    return "coo";
+  } else if constexpr (is_dia_matrix<type>::value) {
+    return "dia";
+  } else if constexpr (requires { o.flags().find_next(std::size_t(0)); }) {
+    return "bitmap";
+  } else {
+    return "view";
+  }
+}
+
+template <typename O>
+trace_operand describe_operand(O&& o) {
+  trace_operand operand;
+  if constexpr (MatrixRange<O>) {
+    operand.shape = {std::size_t(o.shape()[0]), std::size_t(o.shape()[1])};
+  } else {
+    operand.shape = {std::size_t(o.shape())};
+  }
+  operand.nnz = o.size();
+  operand.backend = backend_name(o);
+  return operand;
+}
+
+template <typename M>
+const char* mask_kind() {
+  if constexpr (is_full_mask_v<M>) {
+    return "none";
+  } else if constexpr (is_complement_view_v<M>) {
+    return "complement";
+  } else if constexpr (is_structural_mask_v<M>) {
+    return "structure";
+  } else {
+    return "value";
+  }
+}
+
+// Bytes of storage held by the container `c`.
+template <typename C>
+std::size_t storage_bytes(const C& c) {
+  if constexpr (requires { c.backend().nbytes(); }) {
+    return c.backend().nbytes();
+  } else if constexpr (requires { c.nbytes(); }) {
+    return c.nbytes();
+  } else if constexpr (BitmapVector<std::remove_cvref_t<C>>) {
+    std::size_t n = c.shape();
+    return n * sizeof(grb::vector_scalar_t<C>) +
+           (n + CHAR_BIT - 1) / CHAR_BIT;
+  } else {
+    return c.size() * sizeof(std::ranges::range_value_t<C>);
+  }
+}
+
+// Records one algorithm call, from its construction to its destruction, in
+// the trace log.  Algorithms name the kernel they choose with `kernel`, and
+// pass `flops` either the call's flops or a function computing them, which
+// is only called once the call has been timed.  When tracing is disabled,
+// every member is empty, so a scope costs nothing.
+template <bool Enabled = tracing_enabled>
+class trace_scope {
+public:
+  template <typename... Operands>
+  trace_scope(const char*, Operands&&...) noexcept {}
+
+  template <typename M>
+  void mask(const M&) noexcept {}
+
+  void kernel(const char*) noexcept {}
+
+  void flops(std::size_t) noexcept {}
+
+  template <std::invocable Fn>
+  void flops(Fn&&) noexcept {}
+
+  template <typename C>
+  void output(const C&) noexcept {}
+};
+
+template <>
+class trace_scope<true> {
+public:
+  template <typename... Operands>
+  trace_scope(const char* name, Operands&&... operands) {
+    event_.name = name;
+    event_.kernel = "generic";
+    event_.mask = "none";
+    (event_.operands.push_back(describe_operand(operands)), ...);
+    event_.thread = trace_log::thread_id();
+    event_.start_us = trace_log::instance().now_us();
+  }
+
+  trace_scope(const trace_scope&) = delete;
+  trace_scope& operator=(const trace_scope&) = delete;
+
+  ~trace_scope() {
+    auto&& log = trace_log::instance();
+    event_.duration_us = log.now_us() - event_.start_us;
+    if (flops_) {
+      event_.flops = flops_();
+    }
+    log.record(std::move(event_));
+  }
+
+  template <typename M>
+  void mask(const M&) {
+    event_.mask = mask_kind<std::remove_cvref_t<M>>();
+  }
+
+  void kernel(const char* name) {
+    event_.kernel = name;
+  }
+
+  void flops(std::size_t flops) {
+    event_.flops = flops;
+  }
+
+  template <std::invocable Fn>
+  void flops(Fn&& fn) {
+    flops_ = std::forward<Fn>(fn);
+  }
+
+  template <typename C>
+  void output(const C& c) {
+    event_.bytes = storage_bytes(c);
+  }
+
+private:
+  trace_event event_;
+  std::function<std::size_t()> flops_;
+};
+
+// Flops of the matrix product `a * b`: two for each pair of an element
+// `a[i, k]` and an element `b[k, j]`.
+template <typename A, typename B>
+std::size_t multiply_flops(A&& a, B&& b) {
+  std::vector<std::size_t> a_nnz(a.shape()[1]);
+  std::vector<std::size_t> b_nnz(a.shape()[1]);
+
+  for (auto&& [index, _] : a) {
+    a_nnz[grb::get<1>(index)]++;
+  }
+
+  if constexpr (MatrixRange<B>) {
+    for (auto&& [index, _] : b) {
+      b_nnz[grb::get<0>(index)]++;
+    }
+  } else {
+    for (auto&& [k, _] : b) {
+      b_nnz[k]++;
+    }
+  }
+
+  std::size_t flops = 0;
+  for (std::size_t k = 0; k < a_nnz.size(); k++) {
+    flops += 2 * a_nnz[k] * b_nnz[k];
+  }
+  return flops;
+}
+
+} // namespace detail
+
+} // namespace grb
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <stdexcept>
 #include <string>
 
@@ -43,4 +44,32 @@ private:
   std::string what_arg_;
 };
 
+/// Thrown by operations whose planned memory does not fit in the memory
+/// budget set with `grb::set_memory_budget`, before they allocate it.
+class out_of_memory final : public grb::exception {
+public:
+  out_of_memory(const std::string& what_arg, std::size_t required = 0,
+                std::size_t available = 0)
+      : what_arg_(what_arg), required_(required), available_(available) {}
+
+  const char* what() const throw() {
+    return what_arg_.c_str();
+  }
+
+  /// Bytes the operation needed.
+  std::size_t required() const noexcept {
+    return required_;
+  }
+
+  /// Bytes of the budget that were available.
+  std::size_t available() const noexcept {
+    return available_;
+  }
+
+private:
+  std::string what_arg_;
+  std::size_t required_;
+  std::size_t available_;
+};
+
 } // namespace grb
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <type_traits>
 
 namespace shp {
 
@@ -100,9 +101,37 @@ public:
     return *this;
   }
 
-  vector& operator=(vector&& other) noexcept
+  // Takes over `other`'s storage, releasing the current storage, when the
+  // allocator propagates or allocators are interchangeable; otherwise copies
+  // the elements into storage from this vector's allocator.
+  vector& operator=(vector&& other) noexcept(
+      std::allocator_traits<
+          allocator_type>::propagate_on_container_move_assignment::value ||
+      std::allocator_traits<allocator_type>::is_always_equal::value)
     requires(std::is_trivially_move_constructible_v<T>)
   {
+    using traits = std::allocator_traits<allocator_type>;
+    constexpr bool propagate =
+        traits::propagate_on_container_move_assignment::value;
+
+    if (this == &other) {
+      return *this;
+    }
+
+    if constexpr (!propagate && !traits::is_always_equal::value) {
+      if (!(allocator_ == other.allocator_)) {
+        assign(other.begin(), other.end());
+        return *this;
+      }
+    }
+
+    if (data_ != nullptr) {
+      allocator_.deallocate(data_, capacity());
+    }
+    if constexpr (propagate) {
+      allocator_ = std::move(other.allocator_);
+    }
+
     data_ = other.data_;
     other.data_ = nullptr;
     size_ = other.size_;
@@ -183,6 +212,18 @@ public:
 
   void reserve(size_type new_cap) {
     if (new_cap > capacity()) {
+      // Allocators that can resize in place, such as
+      // `grb::huge_page_allocator` with `mremap`, avoid the copy.
+      if constexpr (std::is_trivially_copyable_v<T> &&
+                    requires(allocator_type a, pointer p, size_type n) {
+                      a.reallocate(p, n, n);
+                    }) {
+        if (data_ != nullptr) {
+          data_ = allocator_.reallocate(data_, capacity(), new_cap);
+          capacity_ = new_cap;
+          return;
+        }
+      }
       pointer new_data = get_allocator().allocate(new_cap);
       using namespace std;
       if (begin() != end()) {
@@ -198,7 +239,7 @@ public:
 
   void push_back(const T& value) {
     if (size() + 1 > capacity()) {
-      size_type new_capacity = next_highest_power_of_two_impl_(capacity());
+      size_type new_capacity = next_highest_power_of_two_impl_(size() + 1);
       reserve(new_capacity);
     }
 
@@ -208,7 +249,7 @@ public:
 
   void push_back(T&& value) {
     if (size() + 1 > capacity()) {
-      size_type new_capacity = next_highest_power_of_two_impl_(capacity());
+      size_type new_capacity = next_highest_power_of_two_impl_(size() + 1);
       reserve(new_capacity);
     }
 
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <grb/containers/backend/csr_matrix.hpp>
+#include <grb/containers/matrix.hpp>
+#include <grb/containers/views/traditional_formats/csr_matrix_view.hpp>
+#include <grb/detail/concepts.hpp>
+#include <grb/detail/csr_storage.hpp>
+#include <grb/detail/mapped_file.hpp>
+#include <grb/detail/matrix_traits.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace grb {
+
+namespace __detail {
+
+// Header of a binary CSR snapshot.  The row pointer, column index and value
+// arrays follow, each starting at an offset aligned to
+// `binary_alignment` bytes, so that they can be used in place once the file
+// is memory-mapped.
+struct binary_header {
+  char magic[8];
+  std::uint32_t version;
+  // `binary_endian_tag` as written by the saving machine.
+  std::uint32_t endian_tag;
+  std::uint32_t index_size;
+  std::uint32_t value_size;
+  std::uint32_t value_kind;
+  std::uint32_t reserved;
+  std::uint64_t m;
+  std::uint64_t n;
+  std::uint64_t nnz;
+  std::uint64_t rowptr_offset;
+  std::uint64_t colind_offset;
+  std::uint64_t values_offset;
+};
+
+inline constexpr char binary_magic[8] = {'G', 'R', 'B', 'C', 'S', 'R', 0, 0};
+inline constexpr std::uint32_t binary_version = 1;
+inline constexpr std::uint32_t binary_endian_tag = 0x01020304;
+inline constexpr std::size_t binary_alignment = 64;
+
+enum binary_value_kind : std::uint32_t {
+  binary_signed = 0,
+  binary_unsigned = 1,
+  binary_floating = 2,
+  binary_bool = 3,
+};
+
+template <typename T>
+constexpr std::uint32_t binary_kind_of() {
+  if constexpr (std::is_same_v<T, bool>) {
+    return binary_bool;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return binary_floating;
+  } else if constexpr (std::is_signed_v<T>) {
+    return binary_signed;
+  } else {
+    return binary_unsigned;
+  }
+}
+
+inline std::uint64_t binary_align(std::uint64_t offset) {
+  return (offset + binary_alignment - 1) / binary_alignment * binary_alignment;
+}
+
+template <typename T, typename I>
+binary_header make_binary_header(std::size_t m, std::size_t n,
+                                 std::size_t nnz) {
+  binary_header header{};
+  std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+  header.version = binary_version;
+  header.endian_tag = binary_endian_tag;
+  header.index_size = sizeof(I);
+  header.value_size = sizeof(T);
+  header.value_kind = binary_kind_of<T>();
+  header.m = m;
+  header.n = n;
+  header.nnz = nnz;
+  header.rowptr_offset = binary_align(sizeof(binary_header));
+  header.colind_offset =
+      binary_align(header.rowptr_offset + (m + 1) * sizeof(I));
+  header.values_offset = binary_align(header.colind_offset + nnz * sizeof(I));
+  return header;
+}
+
+// Check that `file` holds a snapshot of a matrix with scalar type `T` and
+// index type `I`, and return its header.
+template <typename T, typename I>
+binary_header read_binary_header(const grb::detail::mapped_file& file,
+                                 const std::string& path) {
+  binary_header header;
+  if (file.size() < sizeof(header)) {
+    throw std::runtime_error(path + " is not a grb binary matrix.");
+  }
+  std::memcpy(&header, file.data(), sizeof(header));
+
+  if (std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0) {
+    throw std::runtime_error(path + " is not a grb binary matrix.");
+  }
+  if (header.version != binary_version) {
+    throw std::runtime_error(path + " has unsupported format version " +
+                             std::to_string(header.version) + ".");
+  }
+  if (header.endian_tag != binary_endian_tag) {
+    throw std::runtime_error(path + " was written with a different byte "
+                                    "order.");
+  }
+  if (header.index_size != sizeof(I) || header.value_size != sizeof(T) ||
+      header.value_kind != binary_kind_of<T>()) {
+    throw std::runtime_error(path + " holds a matrix of a different scalar "
+                                    "or index type.");
+  }
+
+  auto expected = make_binary_header<T, I>(header.m, header.n, header.nnz);
+  if (header.rowptr_offset != expected.rowptr_offset ||
+      header.colind_offset != expected.colind_offset ||
+      header.values_offset != expected.values_offset ||
+      file.size() < header.values_offset + header.nnz * sizeof(T)) {
+    throw std::runtime_error(path + " is truncated or corrupt.");
+  }
+
+  return header;
+}
+
+inline void write_binary_padding(std::ofstream& f, std::uint64_t offset) {
+  static constexpr char zeros[binary_alignment] = {};
+  std::uint64_t position = f.tellp();
+  f.write(zeros, offset - position);
+}
+
+template <typename T, typename I>
+void write_binary_csr(const std::string& path, std::size_t m, std::size_t n,
+                      std::size_t nnz, const I* rowptr, const I* colind,
+                      const T* values) {
+  auto header = make_binary_header<T, I>(m, n, nnz);
+
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  if (!f.is_open()) {
+    throw std::runtime_error("save_binary: cannot open " + path);
+  }
+
+  f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  write_binary_padding(f, header.rowptr_offset);
+  f.write(reinterpret_cast<const char*>(rowptr), (m + 1) * sizeof(I));
+  write_binary_padding(f, header.colind_offset);
+  f.write(reinterpret_cast<const char*>(colind), nnz * sizeof(I));
+  write_binary_padding(f, header.values_offset);
+  f.write(reinterpret_cast<const char*>(values), nnz * sizeof(T));
+
+  if (!f) {
+    throw std::runtime_error("save_binary: error writing " + path);
+  }
+}
+
+} // namespace __detail
+
+template <typename T, typename I>
+class mapped_csr_matrix;
+
+/// Rows `[first, last)` of a `grb::mapped_csr_matrix`, as
+/// `csr_matrix_row_view`s in order, returned by its `rows()`.  Iterating
+/// the rows prefetches the next block of rows, of about `block_bytes` bytes
+/// of elements, as soon as the traversal enters the last block prefetched,
+/// so that reading the file overlaps with computing on the rows already
+/// read.  The range can only be iterated once.
+template <typename T, typename I>
+class mapped_row_range {
+public:
+  using matrix_type = mapped_csr_matrix<T, I>;
+  using index_type = I;
+  using row_type = csr_matrix_row_view<T, I, const T*, const I*>;
+
+  class iterator {
+  public:
+    using value_type = row_type;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    iterator(mapped_row_range* range, index_type row)
+        : range_(range), row_(row) {}
+
+    row_type operator*() const {
+      return range_->matrix_->row(row_);
+    }
+
+    iterator& operator++() {
+      ++row_;
+      range_->advance(row_);
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    bool operator==(const iterator& other) const noexcept {
+      return row_ == other.row_;
+    }
+
+  private:
+    mapped_row_range* range_ = nullptr;
+    index_type row_ = 0;
+  };
+
+  mapped_row_range(const matrix_type& matrix, index_type first,
+                   index_type last, std::size_t block_bytes)
+      : matrix_(&matrix), first_(first), last_(last), ahead_(first),
+        prefetched_(first),
+        block_elements_(
+            std::max<std::size_t>(block_bytes / (sizeof(T) + sizeof(I)), 1)) {}
+
+  iterator begin() {
+    advance(first_);
+    return iterator(this, first_);
+  }
+
+  iterator end() {
+    return iterator(this, last_);
+  }
+
+private:
+  // Rows `[ahead_, prefetched_)` are the last block prefetched.  Entering it
+  // prefetches the block after it, so that one block is always in flight.
+  void advance(index_type row) {
+    while (row >= ahead_ && prefetched_ < last_) {
+      ahead_ = prefetched_;
+      prefetched_ = block_end(prefetched_);
+      matrix_->prefetch(ahead_, prefetched_);
+    }
+  }
+
+  // The end of the block of rows starting at `row`: as many rows as hold at
+  // most `block_elements_` elements, and at least one.
+  index_type block_end(index_type row) const {
+    const I* rowptr = matrix_->rowptr_data();
+    auto target = std::size_t(rowptr[row]) + block_elements_;
+    auto end = std::upper_bound(rowptr + row + 1, rowptr + last_ + 1, target,
+                                [](std::size_t target, I offset) {
+                                  return target < std::size_t(offset);
+                                }) -
+               rowptr - 1;
+    return std::max<index_type>(index_type(end), row + 1);
+  }
+
+  const matrix_type* matrix_;
+  index_type first_;
+  index_type last_;
+  index_type ahead_;
+  index_type prefetched_;
+  std::size_t block_elements_;
+};
+
+/// A read-only CSR matrix whose arrays live in a memory-mapped binary
+/// snapshot written by `grb::save_binary`, for matrices larger than memory.
+/// Pages are read from the file as they are first used, and `rows()`
+/// prefetches them ahead of a traversal in row order, which is the order of
+/// the file; matrix-vector `grb::multiply` traverses it so.  Copies share
+/// the mapping, which is released with the last copy.
+template <typename T, typename I>
+class mapped_csr_matrix : public csr_matrix_view<T, I, const T*, const I*> {
+public:
+  using base_type = csr_matrix_view<T, I, const T*, const I*>;
+  using key_type = typename base_type::key_type;
+  using size_type = typename base_type::size_type;
+  using index_type = typename base_type::index_type;
+
+  /// Default bytes of elements per block prefetched by `rows()`.
+  static constexpr std::size_t prefetch_bytes = std::size_t(8) << 20;
+
+  mapped_csr_matrix(std::shared_ptr<const grb::detail::mapped_file> file,
+                    const T* values, const I* rowptr, const I* colind,
+                    key_type shape, size_type nnz)
+      : base_type(values, rowptr, colind, shape, nnz), file_(std::move(file)) {
+  }
+
+  /// Ask the kernel to start reading rows `[first, last)` from the file in
+  /// the background.
+  void prefetch(index_type first, index_type last) const {
+    const I* rowptr = this->rowptr_data();
+    file_->advise_willneed(rowptr + first, (last - first + 1) * sizeof(I));
+    std::size_t offset = rowptr[first];
+    std::size_t count = rowptr[last] - rowptr[first];
+    file_->advise_willneed(this->colind_data() + offset, count * sizeof(I));
+    file_->advise_willneed(this->values_data() + offset, count * sizeof(T));
+  }
+
+  /// Rows `[first, last)` in order, prefetched in blocks of about
+  /// `block_bytes` bytes of elements.
+  mapped_row_range<T, I> rows(index_type first, index_type last,
+                              std::size_t block_bytes = prefetch_bytes) const {
+    return mapped_row_range<T, I>(*this, first, last, block_bytes);
+  }
+
+  /// All rows in order, prefetched in blocks of `prefetch_bytes` bytes.
+  mapped_row_range<T, I> rows() const {
+    return rows(0, this->shape()[0]);
+  }
+
+private:
+  std::shared_ptr<const grb::detail::mapped_file> file_;
+};
+
+/// Write `matrix` to `path` as a binary snapshot: a versioned header
+/// followed by the raw CSR row pointer, column index and value arrays.
+/// Matrices not stored in CSR are converted first.
+template <MatrixRange M>
+void save_binary(M&& matrix, const std::string& path) {
+  using T = grb::matrix_scalar_t<M>;
+  using I = grb::matrix_index_t<M>;
+
+  std::size_t m = matrix.shape()[0];
+  std::size_t n = matrix.shape()[1];
+
+  auto&& storage = __detail::storage_of(std::as_const(matrix));
+  using storage_type = std::remove_cvref_t<decltype(storage)>;
+
+  if constexpr (__detail::CSRStorage<storage_type>) {
+    const auto& csr = storage;
+    __detail::write_binary_csr(path, m, n, std::size_t(csr.rowptr_data()[m]),
+                               csr.rowptr_data(), csr.colind_data(),
+                               csr.values_data());
+  } else {
+    auto csr = __detail::csr_from_elements<T, I>(matrix);
+    __detail::write_binary_csr(path, m, n, matrix.size(),
+                               std::as_const(csr).rowptr_data(),
+                               std::as_const(csr).colind_data(),
+                               std::as_const(csr).values_data());
+  }
+}
+
+/// Read a binary snapshot written by `grb::save_binary` into a new
+/// `grb::matrix`.  `T` and `I` must match the types the snapshot was saved
+/// with.
+template <typename T, std::integral I = std::size_t>
+grb::matrix<T, I> load_binary(const std::string& path) {
+  grb::detail::mapped_file file(path);
+  file.advise_sequential();
+  auto header = __detail::read_binary_header<T, I>(file, path);
+
+  grb::matrix<T, I> matrix({I(header.m), I(header.n)});
+  auto&& csr = matrix.backend();
+  csr.resize_storage(header.nnz);
+
+  std::memcpy(csr.rowptr_data(), file.data() + header.rowptr_offset,
+              (header.m + 1) * sizeof(I));
+  std::memcpy(csr.colind_data(), file.data() + header.colind_offset,
+              header.nnz * sizeof(I));
+  std::memcpy(csr.values_data(), file.data() + header.values_offset,
+              header.nnz * sizeof(T));
+
+  return matrix;
+}
+
+/// Memory-map a binary snapshot written by `grb::save_binary` and return a
+/// read-only CSR matrix over it without copying.  Only the header is read
+/// up front; the arrays are paged in as they are used.  `T` and `I` must
+/// match the types the snapshot was saved with.
+template <typename T, std::integral I = std::size_t>
+mapped_csr_matrix<T, I> mmap_binary(const std::string& path) {
+  auto file = std::make_shared<const grb::detail::mapped_file>(path);
+  auto header = __detail::read_binary_header<T, I>(*file, path);
+
+  auto rowptr =
+      reinterpret_cast<const I*>(file->data() + header.rowptr_offset);
+  auto colind =
+      reinterpret_cast<const I*>(file->data() + header.colind_offset);
+  auto values =
+      reinterpret_cast<const T*>(file->data() + header.values_offset);
+
+  return mapped_csr_matrix<T, I>(std::move(file), values, rowptr, colind,
+                                 {I(header.m), I(header.n)}, header.nnz);
+}
+
+} // namespace grb
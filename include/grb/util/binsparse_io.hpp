@@ -7,98 +7,429 @@
 namespace grb {
 namespace experimental {
 
-template <grb::MatrixRange M>
-void binsparse_mwrite(std::string fname, M&& matrix) {
-
-  using index_type = grb::matrix_index_t<M>;
-  using value_type = grb::matrix_scalar_t<M>;
-
-  std::vector<std::ranges::range_value_t<M>> tuples(matrix.begin(),
-                                                    matrix.end());
-
-  auto sort_fn = [](const auto& a, const auto& b) {
-    auto&& [a_index, a_value] = a;
-    auto&& [b_index, b_value] = b;
-    auto&& [a_i, a_j] = a_index;
-    auto&& [b_i, b_j] = b_index;
-    if (a_i < b_i) {
-      return true;
-    } else if (a_i == b_i) {
-      if (a_j < b_j) {
-        return true;
+/// Options for `binsparse_mwrite` and `binsparse_mread`.
+struct binsparse_options {
+  /// Binsparse format to write: "CSR", "CSC", "DCSR", "COO" or "DMATR"
+  /// (dense, row-major).
+  std::string format = "CSR";
+
+  /// Datasets are written and read this many elements at a time, and
+  /// written in HDF5 chunks of this size.
+  hsize_t chunk_size = hsize_t(1) << 20;
+
+  /// Deflate compression level for written datasets, or 0 for none.
+  int compression_level = 0;
+};
+
+namespace __detail {
+
+template <typename T>
+std::string binsparse_type_name() {
+  if constexpr (std::is_floating_point_v<T>) {
+    return "float" + std::to_string(sizeof(T) * 8);
+  } else if constexpr (std::is_signed_v<T>) {
+    return "int" + std::to_string(sizeof(T) * 8);
+  } else {
+    return "uint" + std::to_string(sizeof(T) * 8);
+  }
+}
+
+template <typename T>
+void binsparse_write(H5::H5File& f, const std::string& label, const T* data,
+                     std::size_t size, const binsparse_options& options) {
+  hdf5_tools::write_dataset_chunked(f, label, data, size, options.chunk_size,
+                                    options.compression_level);
+}
+
+// Write a dataset of `size` elements produced `options.chunk_size` at a time
+// by `fill(offset, buffer, count)`.
+template <typename T, typename Fn>
+void binsparse_write_generated(H5::H5File& f, const std::string& label,
+                               std::size_t size,
+                               const binsparse_options& options, Fn&& fill) {
+  auto dataset = hdf5_tools::create_dataset<T>(
+      f, label, size, options.chunk_size, options.compression_level);
+  hsize_t step = std::max<hsize_t>(options.chunk_size, 1);
+  std::vector<T> buffer(std::min<hsize_t>(step, size));
+  for (hsize_t offset = 0; offset < size; offset += step) {
+    hsize_t count = std::min<hsize_t>(step, size - offset);
+    fill(offset, buffer.data(), count);
+    hdf5_tools::write_slab(dataset, offset, buffer.data(), count);
+  }
+  dataset.close();
+}
+
+// Write the `m` x `n` CSR matrix (`rowptr`, `colind`, `values`) in
+// `options.format`.  For "CSC", the arrays must hold the transpose.
+template <typename T, typename I>
+void binsparse_write_csr(H5::H5File& f, std::size_t m, std::size_t n,
+                         const I* rowptr, const I* colind, const T* values,
+                         const binsparse_options& options) {
+  std::size_t nnz = rowptr[options.format == "CSC" ? n : m];
+
+  nlohmann::json data_types;
+  data_types["values"] = binsparse_type_name<T>();
+
+  if (options.format == "CSR" || options.format == "CSC") {
+    std::size_t pointers = (options.format == "CSR" ? m : n) + 1;
+    binsparse_write(f, "pointers_to_1", rowptr, pointers, options);
+    binsparse_write(f, "indices_1", colind, nnz, options);
+    binsparse_write(f, "values", values, nnz, options);
+    data_types["pointers_to_1"] = binsparse_type_name<I>();
+    data_types["indices_1"] = binsparse_type_name<I>();
+  } else if (options.format == "DCSR") {
+    std::vector<I> rows;
+    std::vector<I> pointers(1, I(0));
+    for (std::size_t i = 0; i < m; i++) {
+      if (rowptr[i + 1] != rowptr[i]) {
+        rows.push_back(I(i));
+        pointers.push_back(rowptr[i + 1]);
       }
     }
-    return false;
+    binsparse_write(f, "indices_0", rows.data(), rows.size(), options);
+    binsparse_write(f, "pointers_to_1", pointers.data(), pointers.size(),
+                    options);
+    binsparse_write(f, "indices_1", colind, nnz, options);
+    binsparse_write(f, "values", values, nnz, options);
+    data_types["indices_0"] = binsparse_type_name<I>();
+    data_types["pointers_to_1"] = binsparse_type_name<I>();
+    data_types["indices_1"] = binsparse_type_name<I>();
+  } else if (options.format == "COO") {
+    // Expand the row pointers chunk by chunk.
+    std::size_t row = 0;
+    binsparse_write_generated<I>(
+        f, "indices_0", nnz, options,
+        [&](hsize_t offset, I* out, hsize_t count) {
+          for (hsize_t k = 0; k < count; k++) {
+            while (std::size_t(rowptr[row + 1]) <= offset + k) {
+              row++;
+            }
+            out[k] = I(row);
+          }
+        });
+    binsparse_write(f, "indices_1", colind, nnz, options);
+    binsparse_write(f, "values", values, nnz, options);
+    data_types["indices_0"] = binsparse_type_name<I>();
+    data_types["indices_1"] = binsparse_type_name<I>();
+  } else if (options.format == "DMATR") {
+    // Fill whole rows at a time, with zero for missing elements.
+    std::size_t rows_per_chunk =
+        std::max<std::size_t>(options.chunk_size / std::max<std::size_t>(n, 1),
+                              1);
+    binsparse_options dense_options = options;
+    dense_options.chunk_size = rows_per_chunk * n;
+    binsparse_write_generated<T>(
+        f, "values", m * n, dense_options,
+        [&](hsize_t offset, T* out, hsize_t count) {
+          std::fill(out, out + count, T{});
+          for (std::size_t i = offset / n; i < (offset + count) / n; i++) {
+            for (I k = rowptr[i]; k < rowptr[i + 1]; k++) {
+              out[(i * n - offset) + colind[k]] = values[k];
+            }
+          }
+        });
+    nnz = m * n;
+  } else {
+    throw grb::invalid_argument("binsparse_mwrite: unsupported format " +
+                                options.format);
+  }
+
+  nlohmann::json metadata;
+  metadata["version"] = "0.1";
+  metadata["format"] = options.format;
+  metadata["shape"] = {m, n};
+  metadata["nnz"] = nnz;
+  metadata["number_of_stored_values"] = nnz;
+  metadata["data_types"] = data_types;
+
+  hdf5_tools::write_dataset(f, "metadata", metadata.dump(2));
+}
+
+// Check that the dataset `label` holds `size` elements, as the metadata
+// says, before it is read into a buffer of that size.
+inline void binsparse_check_size(H5::H5File& f, const std::string& label,
+                                 std::size_t size) {
+  std::size_t actual = hdf5_tools::dataset_size(f, label);
+  if (actual != size) {
+    throw std::runtime_error("binsparse_mread: dataset " + label + " has " +
+                             std::to_string(actual) + " elements, expected " +
+                             std::to_string(size));
+  }
+}
+
+// Check that the last of the pointers read from `label` is `nnz`.
+template <typename I>
+void binsparse_check_pointers(const std::string& label, const I* pointers,
+                              std::size_t size, std::size_t nnz) {
+  if (pointers[0] != I(0) || std::size_t(pointers[size - 1]) != nnz) {
+    throw std::runtime_error("binsparse_mread: dataset " + label +
+                             " does not span the stored values");
+  }
+}
+
+// Row pointers of the `m`-row matrix whose elements' row indices are stored
+// in `label`, counted one chunk at a time.
+template <typename I>
+void binsparse_count_rows(H5::H5File& f, const std::string& label,
+                          std::size_t m, I* rowptr, hsize_t chunk_size) {
+  std::fill(rowptr, rowptr + m + 1, I(0));
+  auto count = [&](hsize_t, const I* rows, hsize_t size) {
+    for (hsize_t k = 0; k < size; k++) {
+      if (std::size_t(rows[k]) >= m) {
+        throw std::runtime_error("binsparse_mread: index out of bounds in " +
+                                 label);
+      }
+      rowptr[rows[k] + 1]++;
+    }
   };
+  hdf5_tools::for_each_chunk<I>(f, label, chunk_size, count);
+  for (std::size_t i = 0; i < m; i++) {
+    rowptr[i + 1] += rowptr[i];
+  }
+}
+
+// Call `fn(offset, indices, values, count)` on successive chunks of the
+// index dataset `label` and the "values" dataset.
+template <typename T, typename I, typename Fn>
+void binsparse_for_each_element_chunk(H5::H5File& f, const std::string& label,
+                                      hsize_t chunk_size, Fn&& fn) {
+  H5::DataSet index_set = f.openDataSet(label.c_str());
+  H5::DataSet value_set = f.openDataSet("values");
+  hsize_t size = hdf5_tools::dataset_size(f, label);
+  hsize_t step = std::max<hsize_t>(chunk_size, 1);
 
-  std::sort(tuples.begin(), tuples.end(), sort_fn);
+  std::vector<I> indices(std::min(step, size));
+  std::vector<T> values(std::min(step, size));
+  for (hsize_t offset = 0; offset < size; offset += step) {
+    hsize_t count = std::min(step, size - offset);
+    hdf5_tools::read_slab(index_set, offset, indices.data(), count);
+    hdf5_tools::read_slab(value_set, offset, values.data(), count);
+    fn(offset, static_cast<const I*>(indices.data()),
+       static_cast<const T*>(values.data()), count);
+  }
+}
+
+// Read the binsparse matrix in `f`, described by `metadata`, into the CSR
+// storage `csr` of an `m` x `n` matrix.  Indices are read with HDF5
+// converting from their declared integer width to `I`.  Only one chunk of
+// each dataset that must be rearranged is held in memory at a time.
+template <typename T, typename I, typename Storage>
+void binsparse_read_csr(H5::H5File& f, const nlohmann::json& metadata,
+                        std::size_t m, std::size_t n, Storage& csr,
+                        hsize_t chunk_size) {
+  std::string format = metadata["format"];
+  std::size_t nnz = metadata.contains("number_of_stored_values")
+                        ? std::size_t(metadata["number_of_stored_values"])
+                        : std::size_t(metadata["nnz"]);
 
-  std::vector<grb::matrix_index_t<M>> rows;
-  std::vector<grb::matrix_index_t<M>> cols;
-  std::vector<grb::matrix_scalar_t<M>> vals;
+  if (format == "DMATR") {
+    binsparse_check_size(f, "values", m * n);
+  } else {
+    binsparse_check_size(f, "indices_1", nnz);
+    binsparse_check_size(f, "values", nnz);
+  }
 
-  rows.reserve(matrix.size());
-  cols.reserve(matrix.size());
-  vals.reserve(matrix.size());
+  if (format == "CSR") {
+    binsparse_check_size(f, "pointers_to_1", m + 1);
+    csr.resize_storage(nnz);
+    hdf5_tools::read_dataset_chunked(f, "pointers_to_1", csr.rowptr_data(),
+                                     chunk_size);
+    binsparse_check_pointers("pointers_to_1", csr.rowptr_data(), m + 1, nnz);
+    hdf5_tools::read_dataset_chunked(f, "indices_1", csr.colind_data(),
+                                     chunk_size);
+    hdf5_tools::read_dataset_chunked(f, "values", csr.values_data(),
+                                     chunk_size);
+  } else if (format == "DCSR") {
+    std::vector<I> rows(hdf5_tools::dataset_size(f, "indices_0"));
+    std::vector<I> pointers(rows.size() + 1);
+    binsparse_check_size(f, "pointers_to_1", pointers.size());
+    hdf5_tools::read_dataset_chunked(f, "indices_0", rows.data(), chunk_size);
+    hdf5_tools::read_dataset_chunked(f, "pointers_to_1", pointers.data(),
+                                     chunk_size);
+    binsparse_check_pointers("pointers_to_1", pointers.data(),
+                             pointers.size(), nnz);
+
+    csr.resize_storage(nnz);
+    I* rowptr = csr.rowptr_data();
+    std::fill(rowptr, rowptr + m + 1, I(0));
+    for (std::size_t k = 0; k < rows.size(); k++) {
+      if (std::size_t(rows[k]) >= m) {
+        throw std::runtime_error(
+            "binsparse_mread: index out of bounds in indices_0");
+      }
+      rowptr[rows[k] + 1] = pointers[k + 1] - pointers[k];
+    }
+    for (std::size_t i = 0; i < m; i++) {
+      rowptr[i + 1] += rowptr[i];
+    }
 
-  for (auto&& [index, value] : tuples) {
-    auto&& [row, col] = index;
-    rows.push_back(row);
-    cols.push_back(col);
-    vals.push_back(value);
+    hdf5_tools::read_dataset_chunked(f, "indices_1", csr.colind_data(),
+                                     chunk_size);
+    hdf5_tools::read_dataset_chunked(f, "values", csr.values_data(),
+                                     chunk_size);
+  } else if (format == "CSC" || format == "COO") {
+    // Count elements per row, then scatter the elements of each chunk into
+    // place.  Elements arrive column by column for CSC, so rows come out
+    // sorted.
+    if (format == "COO") {
+      binsparse_check_size(f, "indices_0", nnz);
+    } else {
+      binsparse_check_size(f, "pointers_to_1", n + 1);
+    }
+    csr.resize_storage(nnz);
+    I* rowptr = csr.rowptr_data();
+    I* colind = csr.colind_data();
+    T* values = csr.values_data();
+
+    std::string row_label = format == "CSC" ? "indices_1" : "indices_0";
+    binsparse_count_rows(f, row_label, m, rowptr, chunk_size);
+    std::vector<I> next(rowptr, rowptr + m);
+
+    if (format == "CSC") {
+      std::vector<I> colptr(n + 1);
+      hdf5_tools::read_dataset_chunked(f, "pointers_to_1", colptr.data(),
+                                       chunk_size);
+      binsparse_check_pointers("pointers_to_1", colptr.data(), n + 1, nnz);
+      std::size_t j = 0;
+      binsparse_for_each_element_chunk<T, I>(
+          f, row_label, chunk_size,
+          [&](hsize_t offset, const I* rows, const T* vals, hsize_t count) {
+            for (hsize_t k = 0; k < count; k++) {
+              while (std::size_t(colptr[j + 1]) <= offset + k) {
+                j++;
+              }
+              I dest = next[rows[k]]++;
+              colind[dest] = I(j);
+              values[dest] = vals[k];
+            }
+          });
+    } else {
+      // Stream the row indices alongside the column indices and values.
+      H5::DataSet column_set = f.openDataSet("indices_1");
+      std::vector<I> columns;
+      binsparse_for_each_element_chunk<T, I>(
+          f, row_label, chunk_size,
+          [&](hsize_t offset, const I* rows, const T* vals, hsize_t count) {
+            columns.resize(count);
+            hdf5_tools::read_slab(column_set, offset, columns.data(), count);
+            for (hsize_t k = 0; k < count; k++) {
+              I dest = next[rows[k]]++;
+              colind[dest] = columns[k];
+              values[dest] = vals[k];
+            }
+          });
+
+      std::vector<std::pair<I, T>> row;
+      for (std::size_t i = 0; i < m; i++) {
+        if (!std::is_sorted(colind + rowptr[i], colind + rowptr[i + 1])) {
+          row.clear();
+          for (I k = rowptr[i]; k < rowptr[i + 1]; k++) {
+            row.emplace_back(colind[k], values[k]);
+          }
+          std::sort(row.begin(), row.end(), [](auto&& x, auto&& y) {
+            return x.first < y.first;
+          });
+          for (std::size_t k = 0; k < row.size(); k++) {
+            colind[rowptr[i] + k] = row[k].first;
+            values[rowptr[i] + k] = row[k].second;
+          }
+        }
+      }
+    }
+  } else if (format == "DMATR") {
+    csr.resize_storage(m * n);
+    I* rowptr = csr.rowptr_data();
+    I* colind = csr.colind_data();
+    for (std::size_t i = 0; i <= m; i++) {
+      rowptr[i] = I(i * n);
+    }
+    for (std::size_t k = 0; k < m * n; k++) {
+      colind[k] = I(k % n);
+    }
+    hdf5_tools::read_dataset_chunked(f, "values", csr.values_data(),
+                                     chunk_size);
+  } else {
+    throw std::runtime_error("binsparse_mread: unsupported format " + format);
   }
+}
+
+} // namespace __detail
+
+/// Write `matrix` to the HDF5 file `fname` in the binsparse format
+/// `options.format`.  Matrices stored in CSR are written straight from their
+/// arrays, in chunks of `options.chunk_size` elements.
+template <grb::MatrixRange M>
+void binsparse_mwrite(std::string fname, M&& matrix,
+                      const binsparse_options& options = {}) {
+  using T = grb::matrix_scalar_t<M>;
+  using I = grb::matrix_index_t<M>;
+
+  std::size_t m = matrix.shape()[0];
+  std::size_t n = matrix.shape()[1];
 
   H5::H5File f(fname.c_str(), H5F_ACC_TRUNC);
 
-  hdf5_tools::write_dataset(f, "values", vals);
-  hdf5_tools::write_dataset(f, "indices_0", rows);
-  hdf5_tools::write_dataset(f, "indices_1", cols);
+  auto write = [&](auto&& csr) {
+    __detail::binsparse_write_csr(
+        f, m, n, std::as_const(csr).rowptr_data(),
+        std::as_const(csr).colind_data(), std::as_const(csr).values_data(),
+        options);
+  };
 
-  std::string json_string = "{\n"
-                            "  \"format\": \"COO\",\n"
-                            "  \"shape\": [";
-  json_string += std::to_string(matrix.shape()[0]) + ", " +
-                 std::to_string(matrix.shape()[1]) + "],\n" +
-                 "  \"nnz\": " + std::to_string(matrix.size()) + "\n" + "}\n";
+  auto&& storage = grb::__detail::storage_of(std::as_const(matrix));
+  using storage_type = std::remove_cvref_t<decltype(storage)>;
 
-  hdf5_tools::write_dataset(f, "metadata", json_string);
+  if (options.format == "CSC") {
+    // The CSR arrays of the transpose are the CSC arrays of `matrix`.
+    auto t = grb::transpose_materialize(matrix);
+    auto&& t_storage = grb::__detail::storage_of(t);
+    if constexpr (grb::__detail::CSRStorage<
+                      std::remove_cvref_t<decltype(t_storage)>>) {
+      write(t_storage);
+    } else {
+      write(grb::__detail::csr_from_elements<T, I>(t));
+    }
+  } else if constexpr (grb::__detail::CSRStorage<storage_type>) {
+    write(storage);
+  } else {
+    write(grb::__detail::csr_from_elements<T, I>(matrix));
+  }
 
   f.close();
 }
 
+/// Read the binsparse matrix stored in the HDF5 file `fname`.  CSR, CSC,
+/// DCSR, COO and DMATR (dense, row-major) formats are supported.  Datasets
+/// are read `options.chunk_size` elements at a time, directly into the
+/// arrays of CSR backends.
 template <typename T, typename I = std::size_t, typename Hint = grb::sparse>
-grb::matrix<T, I, Hint> binsparse_mread(std::string fname) {
-  H5::H5File f(fname.c_str(), H5F_ACC_RDWR);
+grb::matrix<T, I, Hint> binsparse_mread(std::string fname,
+                                        const binsparse_options& options = {}) {
+  H5::H5File f(fname.c_str(), H5F_ACC_RDONLY);
 
   auto metadata = hdf5_tools::read_dataset<char>(f, "metadata");
 
   using json = nlohmann::json;
-  auto data = json::parse(metadata);
-
-  if (data["format"] == "COO") {
-    auto nrows = data["shape"][0];
-    auto ncols = data["shape"][1];
-    auto nnz = data["nnz"];
-
-    auto values = hdf5_tools::read_dataset<T>(f, "values");
-    auto rows = hdf5_tools::read_dataset<T>(f, "indices_0");
-    auto cols = hdf5_tools::read_dataset<T>(f, "indices_1");
+  auto data = json::parse(metadata.begin(), metadata.end());
 
-    grb::matrix<T, I, Hint> m({nrows, ncols});
+  std::size_t m = data["shape"][0];
+  std::size_t n = data["shape"][1];
 
-    std::vector<std::tuple<std::tuple<I, I>, T>> tuples;
+  grb::matrix<T, I, Hint> matrix({I(m), I(n)});
 
-    for (size_t i = 0; i < nnz; i++) {
-      tuples.push_back({{rows[i], cols[i]}, values[i]});
-    }
-
-    m.insert(tuples.begin(), tuples.end());
-
-    return m;
+  using backend_type = typename grb::matrix<T, I, Hint>::backend_type;
+  if constexpr (grb::__detail::CSRStorage<backend_type>) {
+    __detail::binsparse_read_csr<T, I>(f, data, m, n, matrix.backend(),
+                                       options.chunk_size);
   } else {
-    assert(false);
+    grb::csr_matrix<T, I> csr({I(m), I(n)});
+    __detail::binsparse_read_csr<T, I>(f, data, m, n, csr,
+                                       options.chunk_size);
+    matrix.insert(csr.begin(), csr.end());
   }
+
   f.close();
+  return matrix;
 }
 
 } // namespace experimental
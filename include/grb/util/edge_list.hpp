@@ -0,0 +1,355 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <grb/containers/matrix.hpp>
+#include <grb/detail/mapped_file.hpp>
+#include <grb/detail/parallel.hpp>
+#include <grb/util/matrix_io.hpp>
+#include <grb/util/matrix_write.hpp>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+namespace __detail {
+
+// Edges parsed by one thread, with their original vertex ids.
+template <typename T>
+struct edge_chunk {
+  std::vector<std::uint64_t> sources;
+  std::vector<std::uint64_t> targets;
+  std::vector<T> values;
+};
+
+inline const char* edge_skip_separators(const char* p, const char* end,
+                                        char delimiter) noexcept {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == ',' ||
+                     *p == delimiter)) {
+    ++p;
+  }
+  return p;
+}
+
+// Parse the edge list `file` in parallel, one chunk of lines per thread.
+// Blank lines and lines starting with '#' or '%' are skipped.
+template <typename T>
+std::vector<edge_chunk<T>> parse_edge_list(std::string_view file,
+                                           const edge_list_options& options,
+                                           const std::string& file_path) {
+  auto starts = split_lines(file, 0);
+  std::size_t nthreads = starts.size() - 1;
+  std::vector<edge_chunk<T>> chunks(nthreads);
+  std::uint64_t base = options.one_indexed ? 1 : 0;
+
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    auto&& chunk = chunks[t];
+    const char* p = file.data() + starts[t];
+    const char* end = file.data() + starts[t + 1];
+
+    while (p < end) {
+      const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      if (eol == nullptr) {
+        eol = end;
+      }
+
+      const char* q = edge_skip_separators(p, eol, options.delimiter);
+      if (q < eol && *q != '#' && *q != '%') {
+        std::uint64_t i, j;
+        q = mm_parse_number(q, eol, i);
+        if (q) {
+          q = edge_skip_separators(q, eol, options.delimiter);
+          q = mm_parse_number(q, eol, j);
+        }
+        if (q == nullptr) {
+          throw std::runtime_error("read_edge_list: cannot parse line in " +
+                                   file_path);
+        }
+        if (i < base || j < base) {
+          throw std::runtime_error("read_edge_list: vertex id out of range "
+                                   "in " +
+                                   file_path);
+        }
+
+        T v = T(1);
+        if (options.weights) {
+          q = edge_skip_separators(q, eol, options.delimiter);
+          if (q < eol && mm_parse_number(q, eol, v) == nullptr) {
+            throw std::runtime_error("read_edge_list: cannot parse line in " +
+                                     file_path);
+          }
+        }
+
+        chunk.sources.push_back(i - base);
+        chunk.targets.push_back(j - base);
+        chunk.values.push_back(v);
+      }
+
+      p = eol + 1;
+    }
+  });
+
+  return chunks;
+}
+
+// Number of ids that `read_edge_list_compact` first sizes its id table for.
+inline constexpr std::size_t id_table_initial_ids = std::size_t(1) << 16;
+
+// Open-addressing hash set of 64-bit vertex ids that threads fill
+// concurrently.  Once filled, ids are numbered densely in increasing order,
+// so that the numbering does not depend on the order of insertion.  Each
+// slot holds an id next to its number.  The table is sized for an expected
+// number of ids at a load factor of at most 0.7, and `insert` fails once
+// that is reached, so that the caller can `grow` the table and retry.
+class id_table {
+public:
+  explicit id_table(std::size_t expected_ids) {
+    std::size_t capacity = 16;
+    while (capacity * max_load_percent / 100 < expected_ids) {
+      capacity *= 2;
+    }
+    allocate(capacity);
+  }
+
+  // Insert `id`, returning `false` without inserting it if it is new and
+  // the table is full.
+  bool insert(std::uint64_t id) {
+    if (id == empty) {
+      throw std::runtime_error("read_edge_list: vertex id " +
+                               std::to_string(id) + " is reserved.");
+    }
+
+    for (std::size_t slot = hash(id) & mask_;; slot = (slot + 1) & mask_) {
+      std::atomic_ref<std::uint64_t> key(slots_[slot].key);
+      std::uint64_t current = key.load(std::memory_order_relaxed);
+      if (current == empty) {
+        if (size_.fetch_add(1, std::memory_order_relaxed) >= max_size_) {
+          size_.fetch_sub(1, std::memory_order_relaxed);
+          return false;
+        }
+        if (key.compare_exchange_strong(current, id,
+                                        std::memory_order_relaxed)) {
+          return true;
+        }
+        size_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      if (current == id) {
+        return true;
+      }
+    }
+  }
+
+  // Double the capacity, keeping the ids inserted so far.  Not thread-safe.
+  void grow() {
+    std::vector<slot_type> old = std::move(slots_);
+    allocate(2 * old.size());
+    for (auto&& slot : old) {
+      if (slot.key != empty) {
+        insert(slot.key);
+      }
+    }
+  }
+
+  // Number the ids, returning them in increasing order.  `find(id)` is the
+  // position of `id` in the result.
+  std::vector<std::uint64_t> number() {
+    std::vector<std::uint64_t> ids;
+    ids.reserve(size_.load());
+    for (auto&& slot : slots_) {
+      if (slot.key != empty) {
+        ids.push_back(slot.key);
+      }
+    }
+    std::sort(ids.begin(), ids.end());
+
+    std::size_t nthreads = grb::detail::num_threads(ids.size());
+    grb::detail::parallel_for(
+        ids.size(), nthreads,
+        [&](std::size_t, std::size_t first, std::size_t last) {
+          for (std::size_t k = first; k < last; k++) {
+            slots_[slot_of(ids[k])].number = k;
+          }
+        });
+
+    return ids;
+  }
+
+  std::uint64_t find(std::uint64_t id) const noexcept {
+    return slots_[slot_of(id)].number;
+  }
+
+private:
+  static constexpr std::uint64_t empty =
+      std::numeric_limits<std::uint64_t>::max();
+
+  static constexpr std::size_t max_load_percent = 70;
+
+  struct slot_type {
+    std::uint64_t key;
+    std::uint64_t number;
+  };
+
+  static std::uint64_t hash(std::uint64_t x) noexcept {
+    // splitmix64 finalizer.
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+  }
+
+  void allocate(std::size_t capacity) {
+    slots_.assign(capacity, slot_type{empty, 0});
+    mask_ = capacity - 1;
+    max_size_ = capacity * max_load_percent / 100;
+    size_ = 0;
+  }
+
+  std::size_t slot_of(std::uint64_t id) const noexcept {
+    std::size_t slot = hash(id) & mask_;
+    while (slots_[slot].key != id) {
+      slot = (slot + 1) & mask_;
+    }
+    return slot;
+  }
+
+  std::vector<slot_type> slots_;
+  std::size_t mask_ = 0;
+  std::size_t max_size_ = 0;
+  std::atomic<std::size_t> size_ = 0;
+};
+
+// Build an `n` x `n` matrix from parsed edges, mapping each vertex id with
+// `map(id)`.
+template <typename T, typename I, typename Map>
+grb::matrix<T, I> build_edge_matrix(std::vector<edge_chunk<T>>& edges,
+                                    std::size_t n, bool symmetrize,
+                                    Map&& map) {
+  std::vector<mm_chunk<T, I>> chunks(edges.size());
+
+  grb::detail::parallel_invoke(edges.size(), [&](std::size_t t) {
+    auto&& in = edges[t];
+    auto&& out = chunks[t];
+    std::size_t size = symmetrize ? 2 * in.sources.size() : in.sources.size();
+    out.rows.reserve(size);
+    out.cols.reserve(size);
+    out.values.reserve(size);
+
+    for (std::size_t k = 0; k < in.sources.size(); k++) {
+      I i = I(map(in.sources[k]));
+      I j = I(map(in.targets[k]));
+      out.rows.push_back(i);
+      out.cols.push_back(j);
+      out.values.push_back(in.values[k]);
+      if (symmetrize && i != j) {
+        out.rows.push_back(j);
+        out.cols.push_back(i);
+        out.values.push_back(in.values[k]);
+      }
+    }
+
+    in = edge_chunk<T>{};
+  });
+
+  grb::matrix<T, I> matrix({I(n), I(n)});
+  mm_build_csr(chunks, n, matrix.backend());
+  return matrix;
+}
+
+} // namespace __detail
+
+/// Read the edge list at `file_path`, with one `i j [v]` line per edge, into
+/// an `n` x `n` matrix, where `n` is one more than the largest vertex id.
+/// Fields may be separated by whitespace, commas or `options.delimiter`, and
+/// lines starting with '#' or '%' are comments.  Lines are parsed in
+/// parallel.  Repeated edges are stored once, with one of their values.
+template <typename T, std::integral I = std::size_t>
+grb::matrix<T, I> read_edge_list(const std::string& file_path,
+                                 const edge_list_options& options = {}) {
+  grb::detail::mapped_file file(file_path);
+  file.advise_sequential();
+  auto edges = __detail::parse_edge_list<T>(file.view(), options, file_path);
+
+  std::uint64_t max_id = 0;
+  bool empty = true;
+  for (auto&& chunk : edges) {
+    for (std::size_t k = 0; k < chunk.sources.size(); k++) {
+      max_id = std::max({max_id, chunk.sources[k], chunk.targets[k]});
+      empty = false;
+    }
+  }
+
+  std::size_t n = empty ? 0 : std::size_t(max_id) + 1;
+  if (!empty && max_id >= std::uint64_t(std::numeric_limits<I>::max())) {
+    throw std::runtime_error("read_edge_list: vertex id " +
+                             std::to_string(max_id) + " in " + file_path +
+                             " does not fit the index type.");
+  }
+
+  return __detail::build_edge_matrix<T, I>(
+      edges, n, options.symmetrize, [](std::uint64_t id) { return id; });
+}
+
+/// Read the edge list at `file_path` as `read_edge_list` does, relabeling
+/// the vertex ids that occur into `[0, n)` in increasing order.  Returns the
+/// pair of the `n` x `n` matrix and the vector of original ids, whose `k`th
+/// element is the id of vertex `k`.  Ids are relabeled through a hash table
+/// filled in parallel, so sparse 64-bit ids need no `std::map`.
+template <typename T, std::integral I = std::size_t>
+std::pair<grb::matrix<T, I>, std::vector<std::uint64_t>>
+read_edge_list_compact(const std::string& file_path,
+                       const edge_list_options& options = {}) {
+  grb::detail::mapped_file file(file_path);
+  file.advise_sequential();
+  auto edges = __detail::parse_edge_list<T>(file.view(), options, file_path);
+
+  std::size_t nedges = 0;
+  for (auto&& chunk : edges) {
+    nedges += chunk.sources.size();
+  }
+
+  // Graphs have far fewer vertices than edge endpoints, so the table starts
+  // small and doubles whenever it fills.  Threads that find it full stop,
+  // and resume from the same edge once it has grown.
+  __detail::id_table table(
+      std::min<std::size_t>(2 * nedges, __detail::id_table_initial_ids));
+  std::vector<std::size_t> next(edges.size(), 0);
+  for (bool full = true; full;) {
+    std::atomic<bool> any_full = false;
+    grb::detail::parallel_invoke(edges.size(), [&](std::size_t t) {
+      auto&& chunk = edges[t];
+      for (; next[t] < chunk.sources.size(); next[t]++) {
+        if (!table.insert(chunk.sources[next[t]]) ||
+            !table.insert(chunk.targets[next[t]])) {
+          any_full = true;
+          return;
+        }
+      }
+    });
+    full = any_full;
+    if (full) {
+      table.grow();
+    }
+  }
+
+  auto ids = table.number();
+  if (ids.size() >= std::size_t(std::numeric_limits<I>::max())) {
+    throw std::runtime_error("read_edge_list: " + std::to_string(ids.size()) +
+                             " vertices in " + file_path +
+                             " do not fit the index type.");
+  }
+
+  auto matrix = __detail::build_edge_matrix<T, I>(
+      edges, ids.size(), options.symmetrize,
+      [&](std::uint64_t id) { return table.find(id); });
+
+  return std::pair(std::move(matrix), std::move(ids));
+}
+
+} // namespace grb
@@ -1,30 +1,144 @@
+#pragma once
+
+#include <cmath>
 #include <concepts>
+#include <cstdint>
+#include <grb/containers/backend/csr_matrix.hpp>
 #include <grb/containers/matrix.hpp>
 #include <grb/containers/vector.hpp>
+#include <grb/detail/csr_storage.hpp>
+#include <grb/detail/parallel.hpp>
+#include <grb/detail/random.hpp>
 #include <grb/exceptions/exception.hpp>
 #include <grb/util/matrix_hints.hpp>
+#include <grb/util/matrix_io.hpp>
 #include <random>
-#include <unordered_map>
+#include <vector>
 
 namespace grb {
 
-namespace {
+/// Parameters of `grb::generate_rmat`.  Each edge is placed by recursively
+/// choosing one quadrant of the adjacency matrix with probabilities `a`
+/// (top left), `b` (top right), `c` (bottom left) and `1 - a - b - c`.
+/// The defaults are those of Graph500.
+struct rmat_options {
+  double a = 0.57;
+  double b = 0.19;
+  double c = 0.19;
 
-template <typename T>
-struct uniform_distribution {
-  using type = std::uniform_int_distribution<T>;
+  /// Relabel vertices with a random permutation, so that vertex ids do not
+  /// reveal degrees.
+  bool scramble = true;
 };
 
-template <std::floating_point T>
-struct uniform_distribution<T> {
-  using type = std::uniform_real_distribution<T>;
-};
+namespace __detail {
+
+// Number of absent elements before the next present one in a sequence of
+// elements each present with probability p, where `log_q` is log(1 - p),
+// drawn by inverting the geometric distribution at `u` in [0, 1).
+inline std::uint64_t geometric_skip(double log_q, double u) {
+  return std::uint64_t(std::floor(std::log1p(-u) / log_q));
+}
+
+// Generate an `m` x `n` matrix whose elements are each present with
+// probability `density` into the CSR storage `csr`.  Each row draws from its
+// own stream, skipping geometrically distributed gaps between elements.
+template <typename T, typename I, typename Storage>
+void generate_erdos_renyi_csr(Storage& csr, std::size_t m, std::size_t n,
+                              double density,
+                              const grb::detail::counter_rng& rng) {
+  std::size_t expected = density * double(m) * double(n);
+  std::size_t nthreads = grb::detail::num_threads(expected + m);
+
+  std::vector<std::vector<I>> colinds(nthreads);
+  std::vector<std::vector<T>> values(nthreads);
+  std::vector<std::size_t> row_first(nthreads + 1);
+  std::vector<I> row_length(m);
 
-template <typename T>
-using uniform_distribution_t = typename uniform_distribution<T>::type;
+  double log_q = std::log1p(-density);
 
-} // namespace
+  grb::detail::parallel_for(
+      m, nthreads, [&](std::size_t t, std::size_t first, std::size_t last) {
+        row_first[t] = first;
+        auto&& colind = colinds[t];
+        auto&& value = values[t];
+        colind.reserve(density * double(last - first) * double(n) * 1.1);
+        value.reserve(colind.capacity());
+
+        for (std::size_t i = first; i < last; i++) {
+          std::size_t length = 0;
+          std::uint64_t counter = 0;
+          std::uint64_t j = 0;
+          while (true) {
+            if (density < 1) {
+              if (density <= 0) {
+                break;
+              }
+              j += geometric_skip(log_q, rng.uniform(i, counter++));
+            }
+            if (j >= n) {
+              break;
+            }
+            colind.push_back(I(j));
+            value.push_back(grb::detail::random_value<T>(rng(i, counter++)));
+            length++;
+            j++;
+          }
+          row_length[i] = I(length);
+        }
+      });
+  row_first[nthreads] = m;
+
+  std::size_t nnz = 0;
+  for (auto&& colind : colinds) {
+    nnz += colind.size();
+  }
+
+  csr.resize_storage(nnz);
+  I* rowptr = csr.rowptr_data();
+  rowptr[0] = 0;
+  for (std::size_t i = 0; i < m; i++) {
+    rowptr[i + 1] = rowptr[i] + row_length[i];
+  }
 
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    I offset = rowptr[row_first[t]];
+    std::copy(colinds[t].begin(), colinds[t].end(), csr.colind_data() + offset);
+    std::copy(values[t].begin(), values[t].end(), csr.values_data() + offset);
+  });
+}
+
+// Bijection on [0, 2^scale) used to scramble R-MAT vertex ids.
+class vertex_scrambler {
+public:
+  vertex_scrambler(std::size_t scale, const grb::detail::counter_rng& rng)
+      : scale_(scale), mask_(scale >= 64 ? ~std::uint64_t(0)
+                                         : (std::uint64_t(1) << scale) - 1),
+        multiplier_(rng(~std::uint64_t(0), 0) | 1),
+        addend_(rng(~std::uint64_t(0), 1)) {}
+
+  std::uint64_t operator()(std::uint64_t v) const noexcept {
+    v = (v * multiplier_ + addend_) & mask_;
+    v ^= v >> (scale_ / 2 + 1);
+    v = (v * multiplier_) & mask_;
+    return v;
+  }
+
+private:
+  std::size_t scale_;
+  std::uint64_t mask_;
+  std::uint64_t multiplier_;
+  std::uint64_t addend_;
+};
+
+} // namespace __detail
+
+/// Return an `shape[0]` x `shape[1]` Erdős–Rényi random matrix, in which
+/// each element is present independently with probability `density` and
+/// holds a random value (uniform in [0, 1) for floating point `T`, 0 or 1
+/// otherwise).  Rows are generated in parallel from a counter-based random
+/// number generator, so the result depends only on `seed`, not on the
+/// number of threads.
 template <typename T = float, std::integral I = std::size_t,
           typename Hint = grb::sparse>
 grb::matrix<T, I, Hint> generate_random(grb::index<I> shape,
@@ -35,59 +149,124 @@ grb::matrix<T, I, Hint> generate_random(grb::index<I> shape,
     throw grb::invalid_argument("generate_random: invalid density argument.");
   }
 
-  std::map<std::pair<I, I>, T> tuples;
-
-  size_t nnz = density * shape[0] * shape[1];
-
-  std::mt19937 gen(seed);
-  std::uniform_int_distribution<I> row(0, shape[0] - 1);
-  std::uniform_int_distribution<I> column(0, shape[1] - 1);
-
-  uniform_distribution_t<T> values(0, 1);
+  grb::detail::counter_rng rng(seed);
+  grb::matrix<T, I, Hint> matrix(shape);
 
-  while (tuples.size() < nnz) {
-    auto i = row(gen);
-    auto j = column(gen);
-    if (tuples.find({i, j}) == tuples.end()) {
-      T value = values(gen);
-      tuples.insert({{i, j}, value});
-    }
+  using backend_type = typename grb::matrix<T, I, Hint>::backend_type;
+  if constexpr (__detail::CSRStorage<backend_type>) {
+    __detail::generate_erdos_renyi_csr<T, I>(matrix.backend(), shape[0],
+                                             shape[1], density, rng);
+  } else {
+    grb::csr_matrix<T, I> csr(shape);
+    __detail::generate_erdos_renyi_csr<T, I>(csr, shape[0], shape[1], density,
+                                             rng);
+    matrix.insert(csr.begin(), csr.end());
   }
 
-  grb::matrix<T, I, Hint> matrix(shape);
-  matrix.insert(tuples.begin(), tuples.end());
   return matrix;
 }
 
+/// Return a random vector of dimension `shape`, in which each element is
+/// present independently with probability `density`.  Deterministic for a
+/// given `seed`.
 template <typename T = float, std::integral I = std::size_t,
           typename Hint = grb::sparse>
-grb::vector<T, I, Hint> generate_random(I shape, double density = 0.01) {
+grb::vector<T, I, Hint> generate_random(I shape, double density = 0.01,
+                                        unsigned int seed = 0) {
 
   if (density > 1.0 || density < 0) {
     throw grb::invalid_argument("generate_random: invalid density argument.");
   }
 
-  std::map<I, T> tuples;
+  grb::detail::counter_rng rng(seed);
+  grb::vector<T, I, Hint> vector(shape);
+
+  // Generate the vector as the rows of a matrix, so that blocks of it are
+  // generated in parallel, and drop the elements past its end.
+  constexpr std::size_t block = std::size_t(1) << 16;
+  std::size_t rows = (std::size_t(shape) + block - 1) / block;
+  grb::csr_matrix<T, std::size_t> csr({rows, block});
+  __detail::generate_erdos_renyi_csr<T, std::size_t>(csr, rows, block,
+                                                     density, rng);
+  for (auto&& [index, value] : csr) {
+    auto&& [i, j] = index;
+    if (i * block + j < std::size_t(shape)) {
+      vector.insert({I(i * block + j), value});
+    }
+  }
+
+  return vector;
+}
+
+/// Return an R-MAT random graph with `2^scale` vertices and
+/// `edge_factor * 2^scale` edges drawn, as in the Graph500 Kronecker
+/// generator.  Repeated edges are stored once, so the result may hold fewer
+/// elements; self loops are kept.  Values are random as in
+/// `generate_random`, and repeated edges share a value.  Edges are drawn in
+/// parallel from a counter-based random number generator, so the result
+/// depends only on `seed`, not on the number of threads.
+template <typename T = float, std::integral I = std::size_t>
+grb::matrix<T, I> generate_rmat(std::size_t scale,
+                                std::size_t edge_factor = 16,
+                                unsigned int seed = 0,
+                                const rmat_options& options = {}) {
+  double d = 1 - options.a - options.b - options.c;
+  if (options.a < 0 || options.b < 0 || options.c < 0 || d < 0) {
+    throw grb::invalid_argument("generate_rmat: invalid probabilities.");
+  }
+
+  std::size_t n = std::size_t(1) << scale;
+  std::size_t nedges = edge_factor * n;
 
-  size_t nnz = density * shape;
+  grb::detail::counter_rng rng(seed);
+  __detail::vertex_scrambler scramble(scale, rng);
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<I> index(0, shape - 1);
+  // Edges are drawn in fixed blocks, each thread appending its blocks to
+  // its own chunk.
+  constexpr std::size_t block = std::size_t(1) << 16;
+  std::size_t nblocks = (nedges + block - 1) / block;
+  std::size_t nthreads = grb::detail::num_threads(nedges, block);
+  std::vector<__detail::mm_chunk<T, I>> chunks(nthreads);
 
-  uniform_distribution_t<T> values(0, 1);
+  // Probabilities of the left column half given the top or bottom row half.
+  double ab = options.a + options.b;
+  double a_ab = ab > 0 ? options.a / ab : 0;
+  double c_cd = options.c + d > 0 ? options.c / (options.c + d) : 0;
 
-  while (tuples.size() < nnz) {
-    auto i = index(gen);
-    if (tuples.find(i) == tuples.end()) {
-      T value = values(gen);
-      tuples.insert({i, value});
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    auto&& chunk = chunks[t];
+    for (std::size_t b = t; b < nblocks; b += nthreads) {
+      for (std::size_t k = b * block; k < std::min(nedges, (b + 1) * block);
+           k++) {
+        std::uint64_t i = 0;
+        std::uint64_t j = 0;
+        for (std::size_t level = 0; level < scale; level++) {
+          // Choose the row half, then the column half given the row half,
+          // each from 32 of the bits drawn.
+          std::uint64_t bits = rng(k, level);
+          bool bottom = double(bits >> 32) * 0x1.0p-32 >= ab;
+          bool right = double(bits & 0xffffffff) * 0x1.0p-32 >=
+                       (bottom ? c_cd : a_ab);
+          i = (i << 1) | bottom;
+          j = (j << 1) | right;
+        }
+        if (options.scramble) {
+          i = scramble(i);
+          j = scramble(j);
+        }
+
+        chunk.rows.push_back(I(i));
+        chunk.cols.push_back(I(j));
+        // Values depend only on the edge, so repeated edges agree.
+        chunk.values.push_back(
+            grb::detail::random_value<T>(rng(~std::uint64_t(1), i * n + j)));
+      }
     }
-  }
+  });
 
-  grb::vector<T, I, Hint> vector(shape);
-  vector.insert(tuples.begin(), tuples.end());
-  return vector;
+  grb::matrix<T, I> matrix({I(n), I(n)});
+  __detail::mm_build_csr(chunks, n, matrix.backend());
+  return matrix;
 }
 
 } // namespace grb
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <H5Cpp.h>
+#include <algorithm>
 #include <ranges>
+#include <string>
 #include <vector>
 
 namespace hdf5_tools {
@@ -102,4 +104,109 @@ std::vector<T> read_dataset(H5::H5File& f, const std::string& label) {
   return v;
 }
 
+// Size of the one-dimensional dataset `label`.
+inline hsize_t dataset_size(H5::H5File& f, const std::string& label) {
+  H5::DataSet dataset = f.openDataSet(label.c_str());
+  H5::DataSpace space = dataset.getSpace();
+  hsize_t ndims = space.getSimpleExtentNdims();
+  assert(ndims == 1);
+  hsize_t dims;
+  space.getSimpleExtentDims(&dims, &ndims);
+  return dims;
+}
+
+// Create a one-dimensional dataset of `size` elements of type `T`.  If
+// `chunk_size` is nonzero, the dataset is stored in chunks of that many
+// elements, compressed with deflate at `compression_level` if nonzero.
+template <typename T>
+H5::DataSet create_dataset(H5::H5File& f, const std::string& label,
+                           hsize_t size, hsize_t chunk_size = 0,
+                           int compression_level = 0) {
+  H5::DataSpace dataspace(1, &size);
+  H5::DSetCreatPropList properties;
+  if (chunk_size > 0 && size > 0) {
+    hsize_t chunk = std::min(chunk_size, size);
+    properties.setChunk(1, &chunk);
+    if (compression_level > 0) {
+      properties.setDeflate(compression_level);
+    }
+  }
+  return f.createDataSet(label.c_str(), get_hdf5_standard_type<T>(),
+                         dataspace, properties);
+}
+
+// Write `count` elements from `data` to `dataset`, starting at element
+// `offset`.
+template <typename T>
+void write_slab(H5::DataSet& dataset, hsize_t offset, const T* data,
+                hsize_t count) {
+  if (count == 0) {
+    return;
+  }
+  H5::DataSpace file_space = dataset.getSpace();
+  file_space.selectHyperslab(H5S_SELECT_SET, &count, &offset);
+  H5::DataSpace memory_space(1, &count);
+  dataset.write(data, get_hdf5_native_type<T>(), memory_space, file_space);
+}
+
+// Read `count` elements of `dataset`, starting at element `offset`, into
+// `data`, converting them to `T`.
+template <typename T>
+void read_slab(H5::DataSet& dataset, hsize_t offset, T* data, hsize_t count) {
+  if (count == 0) {
+    return;
+  }
+  H5::DataSpace file_space = dataset.getSpace();
+  file_space.selectHyperslab(H5S_SELECT_SET, &count, &offset);
+  H5::DataSpace memory_space(1, &count);
+  dataset.read(data, get_hdf5_native_type<T>(), memory_space, file_space);
+}
+
+// Write the `size` elements at `data` to a new dataset `label`, `chunk_size`
+// elements at a time.
+template <typename T>
+void write_dataset_chunked(H5::H5File& f, const std::string& label,
+                           const T* data, hsize_t size, hsize_t chunk_size,
+                           int compression_level = 0) {
+  auto dataset =
+      create_dataset<T>(f, label, size, chunk_size, compression_level);
+  hsize_t step = chunk_size > 0 ? chunk_size : std::max<hsize_t>(size, 1);
+  for (hsize_t offset = 0; offset < size; offset += step) {
+    write_slab(dataset, offset, data + offset, std::min(step, size - offset));
+  }
+  dataset.close();
+}
+
+// Read the dataset `label` into `data`, converting to `T`, `chunk_size`
+// elements at a time.
+template <typename T>
+void read_dataset_chunked(H5::H5File& f, const std::string& label, T* data,
+                          hsize_t chunk_size) {
+  H5::DataSet dataset = f.openDataSet(label.c_str());
+  hsize_t size = dataset_size(f, label);
+  hsize_t step = chunk_size > 0 ? chunk_size : std::max<hsize_t>(size, 1);
+  for (hsize_t offset = 0; offset < size; offset += step) {
+    read_slab(dataset, offset, data + offset, std::min(step, size - offset));
+  }
+  dataset.close();
+}
+
+// Call `fn(offset, data, count)` on successive chunks of at most
+// `chunk_size` elements of the dataset `label`, converted to `T`.  Only one
+// chunk is held in memory at a time.
+template <typename T, typename Fn>
+void for_each_chunk(H5::H5File& f, const std::string& label,
+                    hsize_t chunk_size, Fn&& fn) {
+  H5::DataSet dataset = f.openDataSet(label.c_str());
+  hsize_t size = dataset_size(f, label);
+  hsize_t step = chunk_size > 0 ? chunk_size : std::max<hsize_t>(size, 1);
+  std::vector<T> buffer(std::min(step, size));
+  for (hsize_t offset = 0; offset < size; offset += step) {
+    hsize_t count = std::min(step, size - offset);
+    read_slab(dataset, offset, buffer.data(), count);
+    fn(offset, static_cast<const T*>(buffer.data()), count);
+  }
+  dataset.close();
+}
+
 } // namespace hdf5_tools
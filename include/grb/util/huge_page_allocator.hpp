@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <grb/detail/huge_pages.hpp>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+namespace grb {
+
+/// Which huge pages `grb::huge_page_allocator` backs large allocations with.
+enum class huge_page_mode {
+  /// Transparent huge pages, requested with `madvise(MADV_HUGEPAGE)`.
+  transparent,
+
+  /// Huge pages reserved by the administrator (hugetlbfs), falling back to
+  /// transparent huge pages when none are free.
+  hugetlb
+};
+
+/// Process-wide statistics of `grb::huge_page_allocator`.
+struct huge_page_stats {
+  /// Bytes currently mapped for allocations of at least
+  /// `huge_page_allocator<T>::min_bytes`, rounded up to whole huge pages.
+  std::size_t mapped_bytes = 0;
+
+  /// Part of `mapped_bytes` backed by reserved huge pages.
+  std::size_t hugetlb_bytes = 0;
+};
+
+inline huge_page_stats huge_page_statistics() {
+  return {grb::detail::huge_page_mapped_bytes.load(),
+          grb::detail::huge_page_hugetlb_bytes.load()};
+}
+
+/// Allocator backing large allocations with huge pages, so that random
+/// accesses to multi-gigabyte arrays, such as the gathers of SpMV, do not
+/// miss the TLB on nearly every access.  Use it as the `Allocator` of
+/// `grb::matrix` or `grb::vector`, for example
+/// `grb::matrix<float, int, grb::sparse, grb::huge_page_allocator<float>>`.
+///
+/// Allocations of at least `min_bytes` bytes are mapped from the system,
+/// aligned to and rounded up to 2 MiB huge pages; smaller ones are aligned
+/// to 64-byte cache lines.  `csr_matrix::huge_page_nbytes()` reports how
+/// much of a matrix's storage the kernel actually backs with huge pages.
+template <typename T>
+class huge_page_allocator {
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  static constexpr std::size_t min_bytes = grb::detail::huge_page_size;
+  static constexpr std::size_t alignment =
+      std::max<std::size_t>(64, alignof(T));
+
+  huge_page_allocator(
+      grb::huge_page_mode mode = grb::huge_page_mode::transparent) noexcept
+      : mode_(mode) {}
+
+  template <typename U>
+  huge_page_allocator(const huge_page_allocator<U>& other) noexcept
+      : mode_(other.mode()) {}
+
+  T* allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+#ifdef GRB_HAS_HUGE_PAGES
+    if (mapped(n)) {
+      void* data = grb::detail::map_huge_pages(
+          grb::detail::round_to_huge_pages(n * sizeof(T)),
+          mode_ == grb::huge_page_mode::hugetlb);
+      if (data == nullptr) {
+        throw std::bad_alloc();
+      }
+      return static_cast<T*>(data);
+    }
+#endif
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t(alignment)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+#ifdef GRB_HAS_HUGE_PAGES
+    if (mapped(n)) {
+      grb::detail::unmap_huge_pages(
+          p, grb::detail::round_to_huge_pages(n * sizeof(T)));
+      return;
+    }
+#endif
+    ::operator delete(p, std::align_val_t(alignment));
+  }
+
+  /// Resize the allocation `p` of `old_n` elements to `new_n` elements,
+  /// keeping its first `min(old_n, new_n)` elements.  Mapped allocations
+  /// are remapped with `mremap` instead of copied.  Only valid for
+  /// trivially copyable `T`.
+  T* reallocate(T* p, std::size_t old_n, std::size_t new_n)
+    requires(std::is_trivially_copyable_v<T>)
+  {
+#ifdef GRB_HAS_HUGE_PAGES
+    if (mapped(old_n) && mapped(new_n)) {
+      if (void* moved = grb::detail::remap_huge_pages(
+              p, grb::detail::round_to_huge_pages(old_n * sizeof(T)),
+              grb::detail::round_to_huge_pages(new_n * sizeof(T)))) {
+        return static_cast<T*>(moved);
+      }
+    }
+#endif
+    T* new_p = allocate(new_n);
+    std::memcpy(new_p, p, std::min(old_n, new_n) * sizeof(T));
+    deallocate(p, old_n);
+    return new_p;
+  }
+
+  grb::huge_page_mode mode() const noexcept {
+    return mode_;
+  }
+
+  // Memory from either mode is released the same way.
+  template <typename U>
+  bool operator==(const huge_page_allocator<U>&) const noexcept {
+    return true;
+  }
+
+private:
+  static bool mapped(std::size_t n) noexcept {
+    return n * sizeof(T) >= min_bytes;
+  }
+
+  grb::huge_page_mode mode_;
+};
+
+} // namespace grb
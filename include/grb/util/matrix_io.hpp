@@ -2,14 +2,22 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <charconv>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include <grb/containers/backend/coo_matrix.hpp>
+#include <grb/detail/mapped_file.hpp>
+#include <grb/detail/parallel.hpp>
 
 namespace grb {
 
@@ -204,30 +212,43 @@ private:
   bool is_symmetric_ = false;
 };
 
-/// Read in the Matrix Market file at location `file_path` and a return
-/// a coo_matrix data structure with its contents.
-template <typename T, typename I = std::size_t>
-inline coo_matrix<T, I> mmread(std::string file_path, bool one_indexed = true) {
-  using index_type = I;
-  using size_type = std::size_t;
-
-  std::ifstream f;
-
-  f.open(file_path.c_str());
+namespace __detail {
+
+// Contents of a Matrix Market header and size line.
+struct mm_header {
+  bool pattern = false;
+  bool symmetric = false;
+  std::size_t m = 0;
+  std::size_t n = 0;
+  std::size_t nnz = 0;
+  // Offset of the first element line.
+  std::size_t body = 0;
+};
 
-  if (!f.is_open()) {
-    // TODO better choice of exception.
-    throw std::runtime_error("mmread: cannot open " + file_path);
+inline std::string_view mm_next_line(std::string_view file,
+                                     std::size_t& offset) {
+  std::size_t end = file.find('\n', offset);
+  if (end == std::string_view::npos) {
+    end = file.size();
+  }
+  std::string_view line = file.substr(offset, end - offset);
+  offset = std::min(end + 1, file.size());
+  if (!line.empty() && line.back() == '\r') {
+    line.remove_suffix(1);
   }
+  return line;
+}
 
-  std::string buf;
+inline mm_header mm_parse_header(std::string_view file,
+                                 const std::string& file_path) {
+  mm_header header;
+  std::size_t offset = 0;
 
   // Make sure the file is matrix market matrix, coordinate, and check whether
   // it is symmetric. If the matrix is symmetric, non-diagonal elements will
   // be inserted in both (i, j) and (j, i).  Error out if skew-symmetric or
   // Hermitian.
-  std::getline(f, buf);
-  std::istringstream ss(buf);
+  std::istringstream ss{std::string(mm_next_line(file, offset))};
   std::string item;
   ss >> item;
   if (item != "%%MatrixMarket") {
@@ -244,91 +265,358 @@ inline coo_matrix<T, I> mmread(std::string file_path, bool one_indexed = true) {
     throw std::runtime_error(file_path +
                              " could not be parsed as a Matrix Market file.");
   }
-  bool pattern;
   ss >> item;
   if (item == "pattern") {
-    pattern = true;
-  } else {
-    pattern = false;
+    header.pattern = true;
+  } else if (item == "complex") {
+    throw std::runtime_error(file_path + " has an unsupported field type");
   }
-  // TODO: do something with real vs. integer vs. pattern?
   ss >> item;
-  bool symmetric;
   if (item == "general") {
-    symmetric = false;
+    header.symmetric = false;
   } else if (item == "symmetric") {
-    symmetric = true;
+    header.symmetric = true;
   } else {
     throw std::runtime_error(file_path + " has an unsupported matrix type");
   }
 
-  bool outOfComments = false;
-  while (!outOfComments) {
-    std::getline(f, buf);
-
-    if (buf[0] != '%') {
-      outOfComments = true;
+  std::string_view line;
+  do {
+    if (offset >= file.size()) {
+      throw std::runtime_error(file_path + " is missing its size line.");
     }
+    line = mm_next_line(file, offset);
+  } while (line.empty() || line[0] == '%');
+
+  std::istringstream size_line{std::string(line)};
+  size_line >> header.m >> header.n >> header.nnz;
+  header.body = offset;
+
+  return header;
+}
+
+inline const char* mm_skip_space(const char* p, const char* end) noexcept {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+    ++p;
   }
+  return p;
+}
 
-  I m, n, nnz;
-  // std::istringstream ss(buf);
-  ss.clear();
-  ss.str(buf);
-  ss >> m >> n >> nnz;
+// Parse the number at `p` into `value` with `std::from_chars`, returning
+// the position after it, or `nullptr` if there is none.
+template <typename U>
+const char* mm_parse_number(const char* p, const char* end, U& value) {
+  p = mm_skip_space(p, end);
+  if (p < end && *p == '+') {
+    ++p;
+  }
 
-  // NOTE for symmetric matrices: `nnz` holds the number of stored values in
-  // the matrix market file, while `matrix.nnz_` will hold the total number of
-  // stored values (including "mirrored" symmetric values).
-  coo_matrix<T, I> matrix({m, n});
-  if (symmetric) {
-    matrix.reserve(2 * nnz);
+  if constexpr (std::is_same_v<U, bool>) {
+    double v;
+    const char* next = mm_parse_number(p, end, v);
+    value = v != 0;
+    return next;
+  } else if constexpr (std::is_integral_v<U>) {
+    auto [ptr, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc()) {
+      return nullptr;
+    }
+    // Integer matrices written with a fractional part or exponent.
+    if (ptr < end && (*ptr == '.' || *ptr == 'e' || *ptr == 'E')) {
+      double v;
+      auto [fptr, fec] = std::from_chars(p, end, v);
+      if (fec != std::errc()) {
+        return nullptr;
+      }
+      value = U(v);
+      return fptr;
+    }
+    return ptr;
+  } else if constexpr (std::is_floating_point_v<U>) {
+    auto [ptr, ec] = std::from_chars(p, end, value);
+    return ec == std::errc() ? ptr : nullptr;
   } else {
-    matrix.reserve(nnz);
+    double v;
+    const char* next = mm_parse_number(p, end, v);
+    value = U(v);
+    return next;
   }
-  /*
-    TODO: reserve? (for general and for symmetric)
-  */
-
-  size_type c = 0;
-  while (std::getline(f, buf)) {
-    I i, j;
-    T v;
-    std::istringstream ss(buf);
-    if (!pattern) {
-      ss >> i >> j >> v;
-    } else {
-      ss >> i >> j;
-      v = T(1);
-    }
-    if (one_indexed) {
-      i--;
-      j--;
+}
+
+// Split `file[begin, file.size())` into one chunk of whole lines per thread,
+// returning the offsets at which the chunks start followed by
+// `file.size()`.
+inline std::vector<std::size_t> split_lines(std::string_view file,
+                                            std::size_t begin) {
+  std::size_t size = file.size() - begin;
+  std::size_t nthreads = grb::detail::num_threads(size, 1 << 20);
+
+  // Chunk `t` starts at the first line beginning at or after its share of
+  // the text.
+  std::vector<std::size_t> starts(nthreads + 1);
+  for (std::size_t t = 0; t < nthreads; t++) {
+    std::size_t offset = begin + size * t / nthreads;
+    if (t > 0 && file[offset - 1] != '\n') {
+      offset = file.find('\n', offset);
+      offset = (offset == std::string_view::npos) ? file.size() : offset + 1;
     }
+    starts[t] = offset;
+  }
+  starts[nthreads] = file.size();
+
+  return starts;
+}
 
-    if (i >= m || j >= n) {
-      throw std::runtime_error(
-          "read_MatrixMarket: file has nonzero out of bounds.");
+// Elements parsed by one thread, in file order.
+template <typename T, typename I>
+struct mm_chunk {
+  std::vector<I> rows;
+  std::vector<I> cols;
+  std::vector<T> values;
+  // Number of element lines, before mirroring symmetric elements.
+  std::size_t lines = 0;
+};
+
+// Parse the element lines of a Matrix Market file in parallel.  The body is
+// split into chunks of whole lines, one per thread.
+template <typename T, typename I>
+std::vector<mm_chunk<T, I>> mm_parse_elements(std::string_view file,
+                                              const mm_header& header,
+                                              bool one_indexed,
+                                              const std::string& file_path) {
+  auto starts = split_lines(file, header.body);
+  std::size_t nthreads = starts.size() - 1;
+
+  std::vector<mm_chunk<T, I>> chunks(nthreads);
+  std::size_t offset_base = one_indexed ? 1 : 0;
+
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    auto&& chunk = chunks[t];
+    std::size_t expected = header.nnz / nthreads + 1;
+    chunk.rows.reserve(header.symmetric ? 2 * expected : expected);
+    chunk.cols.reserve(header.symmetric ? 2 * expected : expected);
+    chunk.values.reserve(header.symmetric ? 2 * expected : expected);
+
+    const char* p = file.data() + starts[t];
+    const char* end = file.data() + starts[t + 1];
+
+    while (p < end) {
+      const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      if (eol == nullptr) {
+        eol = end;
+      }
+
+      const char* q = mm_skip_space(p, eol);
+      if (q < eol && *q != '%') {
+        std::size_t i, j;
+        T v = T(1);
+        q = mm_parse_number(q, eol, i);
+        q = q ? mm_parse_number(q, eol, j) : nullptr;
+        if (q && !header.pattern) {
+          q = mm_parse_number(q, eol, v);
+        }
+        if (q == nullptr) {
+          throw std::runtime_error("read_MatrixMarket: cannot parse line in " +
+                                   file_path);
+        }
+
+        i -= offset_base;
+        j -= offset_base;
+        if (i >= header.m || j >= header.n) {
+          throw std::runtime_error(
+              "read_MatrixMarket: file has nonzero out of bounds.");
+        }
+
+        chunk.rows.push_back(I(i));
+        chunk.cols.push_back(I(j));
+        chunk.values.push_back(v);
+        if (header.symmetric && i != j) {
+          chunk.rows.push_back(I(j));
+          chunk.cols.push_back(I(i));
+          chunk.values.push_back(v);
+        }
+        chunk.lines++;
+      }
+
+      p = eol + 1;
     }
+  });
+
+  std::size_t lines = 0;
+  for (auto&& chunk : chunks) {
+    lines += chunk.lines;
+  }
+  if (lines > header.nnz) {
+    throw std::runtime_error("read_MatrixMarket: error reading Matrix Market "
+                             "file, file has more nonzeros than reported.");
+  }
+
+  return chunks;
+}
 
-    matrix.push_back({{i, j}, v});
+// Build CSR storage `csr` from parsed elements with a parallel counting
+// sort by row, then sort each row by column.  Duplicate elements, which
+// Matrix Market files should not contain, keep the value that comes first
+// in the file.
+template <typename T, typename I, typename Storage>
+void mm_build_csr(const std::vector<mm_chunk<T, I>>& chunks, std::size_t m,
+                  Storage& csr) {
+  using index_type = std::remove_cvref_t<decltype(*csr.rowptr_data())>;
+  using value_type = std::remove_cvref_t<decltype(*csr.values_data())>;
+
+  std::size_t nnz = 0;
+  for (auto&& chunk : chunks) {
+    nnz += chunk.rows.size();
+  }
+
+  csr.resize_storage(nnz);
+  index_type* rowptr = csr.rowptr_data();
+  index_type* colind = csr.colind_data();
+  value_type* values = csr.values_data();
+
+  std::fill(rowptr, rowptr + m + 1, index_type(0));
 
-    if (symmetric && i != j) {
-      matrix.push_back({{j, i}, v});
+  std::size_t nthreads = chunks.size();
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    for (auto&& i : chunks[t].rows) {
+      std::atomic_ref<index_type>(rowptr[i + 1])
+          .fetch_add(1, std::memory_order_relaxed);
     }
+  });
+
+  for (std::size_t i = 0; i < m; i++) {
+    rowptr[i + 1] += rowptr[i];
+  }
 
-    c++;
-    if (c > nnz) {
-      throw std::runtime_error("read_MatrixMarket: error reading Matrix Market "
-                               "file, file has more nonzeros than reported.");
+  // Chunks hold consecutive lines of the file, so an element's position in
+  // the file follows from its chunk and its offset in the chunk.
+  std::vector<std::size_t> chunk_first(nthreads + 1, 0);
+  for (std::size_t t = 0; t < nthreads; t++) {
+    chunk_first[t + 1] = chunk_first[t] + chunks[t].rows.size();
+  }
+
+  // Threads scatter their elements in any order, so each element carries
+  // its position to order duplicates.
+  std::vector<std::size_t> position(nnz);
+  std::vector<index_type> cursor(rowptr, rowptr + m);
+  grb::detail::parallel_invoke(nthreads, [&](std::size_t t) {
+    auto&& chunk = chunks[t];
+    for (std::size_t k = 0; k < chunk.rows.size(); k++) {
+      index_type dest = std::atomic_ref<index_type>(cursor[chunk.rows[k]])
+                            .fetch_add(1, std::memory_order_relaxed);
+      colind[dest] = chunk.cols[k];
+      values[dest] = chunk.values[k];
+      position[dest] = chunk_first[t] + k;
     }
+  });
+
+  // Sort each row by column, and duplicates by position, then drop
+  // duplicates in place, recording the new length of each row.
+  std::vector<index_type> row_length(m);
+  std::size_t sort_threads = grb::detail::num_threads(nnz);
+  grb::detail::parallel_for(
+      m, sort_threads, [&](std::size_t, std::size_t first, std::size_t last) {
+        std::vector<std::tuple<index_type, std::size_t, value_type>> row;
+        for (std::size_t i = first; i < last; i++) {
+          index_type begin = rowptr[i];
+          index_type end = rowptr[i + 1];
+
+          if (std::adjacent_find(colind + begin, colind + end,
+                                 std::greater_equal<>()) != colind + end) {
+            row.clear();
+            for (index_type k = begin; k < end; k++) {
+              row.emplace_back(colind[k], position[k], values[k]);
+            }
+            std::sort(row.begin(), row.end(), [](auto&& x, auto&& y) {
+              return std::tie(std::get<0>(x), std::get<1>(x)) <
+                     std::tie(std::get<0>(y), std::get<1>(y));
+            });
+            for (std::size_t k = 0; k < row.size(); k++) {
+              colind[begin + k] = std::get<0>(row[k]);
+              values[begin + k] = std::get<2>(row[k]);
+            }
+          }
+
+          index_type out = begin;
+          for (index_type k = begin; k < end; k++) {
+            if (out == begin || colind[k] != colind[out - 1]) {
+              colind[out] = colind[k];
+              values[out] = values[k];
+              ++out;
+            }
+          }
+          row_length[i] = out - begin;
+        }
+      });
+
+  // Close the gaps left by duplicates.
+  index_type out = 0;
+  for (std::size_t i = 0; i < m; i++) {
+    index_type begin = rowptr[i];
+    if (out != begin) {
+      std::copy(colind + begin, colind + begin + row_length[i], colind + out);
+      std::copy(values + begin, values + begin + row_length[i], values + out);
+    }
+    rowptr[i] = out;
+    out += row_length[i];
   }
+  rowptr[m] = out;
 
-  // std::sort(matrix.matrix_.begin(), matrix.matrix_.end(), sort_fn);
+  if (std::size_t(out) < nnz) {
+    csr.resize_storage(out);
+  }
+}
+
+} // namespace __detail
 
-  f.close();
+/// Read in the Matrix Market file at location `file_path` and a return
+/// a coo_matrix data structure with its contents.  The file is memory-mapped
+/// and its elements are parsed in parallel.
+template <typename T, typename I = std::size_t>
+inline coo_matrix<T, I> mmread(std::string file_path, bool one_indexed = true) {
+  grb::detail::mapped_file file(file_path);
+  file.advise_sequential();
+
+  auto header = __detail::mm_parse_header(file.view(), file_path);
+  auto chunks = __detail::mm_parse_elements<T, I>(file.view(), header,
+                                                  one_indexed, file_path);
+
+  // NOTE for symmetric matrices: `nnz` holds the number of stored values in
+  // the matrix market file, while `matrix.nnz_` will hold the total number of
+  // stored values (including "mirrored" symmetric values).
+  coo_matrix<T, I> matrix({I(header.m), I(header.n)});
+
+  std::size_t nnz = 0;
+  for (auto&& chunk : chunks) {
+    nnz += chunk.rows.size();
+  }
+  matrix.reserve(nnz);
+
+  for (auto&& chunk : chunks) {
+    for (std::size_t k = 0; k < chunk.rows.size(); k++) {
+      matrix.push_back({{chunk.rows[k], chunk.cols[k]}, chunk.values[k]});
+    }
+  }
 
   return matrix;
 }
 
+/// Read the Matrix Market file at location `file_path` directly into the CSR
+/// storage `csr`, which is reshaped to the matrix's dimensions.  Elements
+/// are parsed in parallel and placed with a parallel counting sort by row,
+/// without building an intermediate sorted list of tuples.
+template <typename T, typename I, typename Storage>
+void mmread_csr(const std::string& file_path, Storage& csr,
+                bool one_indexed = true) {
+  grb::detail::mapped_file file(file_path);
+  file.advise_sequential();
+
+  auto header = __detail::mm_parse_header(file.view(), file_path);
+  auto chunks = __detail::mm_parse_elements<T, I>(file.view(), header,
+                                                  one_indexed, file_path);
+
+  csr.reshape({I(header.m), I(header.n)});
+  __detail::mm_build_csr(chunks, header.m, csr);
+}
+
 } // namespace grb
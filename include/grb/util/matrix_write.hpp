@@ -0,0 +1,425 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <grb/containers/matrix.hpp>
+#include <grb/detail/concepts.hpp>
+#include <grb/detail/csr_storage.hpp>
+#include <grb/detail/mask_traits.hpp>
+#include <grb/detail/matrix_traits.hpp>
+#include <grb/detail/parallel.hpp>
+#include <grb/exceptions/exception.hpp>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+/// Options for `grb::mmwrite`.
+struct mmwrite_options {
+  /// Write only the elements on or below the diagonal, under a `symmetric`
+  /// header.  The matrix must be symmetric.
+  bool symmetric = false;
+
+  /// Write only the indices of elements, under a `pattern` header.
+  bool pattern = false;
+};
+
+/// Options for reading and writing edge lists, with one `i j [v]` line per
+/// element.
+struct edge_list_options {
+  /// Character separating the fields of each line.
+  char delimiter = '\t';
+
+  /// Whether vertices are numbered from 1 instead of 0.
+  bool one_indexed = false;
+
+  /// Whether each line holds the element's value after its indices.  When
+  /// reading, lines without a value get the value 1.
+  bool weights = true;
+
+  /// When reading, also add the reverse (j, i) of each edge (i, j).
+  bool symmetrize = false;
+};
+
+namespace __detail {
+
+// Number of elements formatted by each thread at a time.
+inline constexpr std::size_t write_block_size = std::size_t(1) << 16;
+
+// A line of text output, built with `std::to_chars`.  `append` writes
+// numbers, including `char` values, in decimal, and `put` writes a single
+// character such as a separator.
+class line_buffer {
+public:
+  template <typename U>
+  void append(U value) {
+    if constexpr (std::is_same_v<U, bool>) {
+      data_.push_back(value ? '1' : '0');
+    } else {
+      char digits[64];
+      auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+      data_.insert(data_.end(), digits, end);
+    }
+  }
+
+  void append(const std::string& s) {
+    data_.insert(data_.end(), s.begin(), s.end());
+  }
+
+  void put(char c) {
+    data_.push_back(c);
+  }
+
+  void write(std::ofstream& f) {
+    f.write(data_.data(), data_.size());
+    data_.clear();
+  }
+
+  std::size_t size() const noexcept {
+    return data_.size();
+  }
+
+private:
+  std::vector<char> data_;
+};
+
+// Write the text of blocks `[0, nblocks)` to `f` in order.  Blocks are
+// formatted by `format(block, buffer)` on `nthreads` worker threads, which
+// run for the whole write, one round of one block per thread at a time,
+// while the calling thread writes each round with one large write per
+// block.  Rounds alternate between two sets of buffers, so that round
+// `k + 1` is formatted while round `k` is written.
+template <typename Format>
+void write_blocks(std::ofstream& f, std::size_t nblocks, std::size_t nthreads,
+                  Format&& format) {
+  if (nblocks <= 1) {
+    line_buffer out;
+    if (nblocks == 1) {
+      format(std::size_t(0), out);
+    }
+    out.write(f);
+    return;
+  }
+
+  nthreads = std::min(nthreads, nblocks);
+  std::size_t nrounds = (nblocks + nthreads - 1) / nthreads;
+  std::vector<line_buffer> buffers(2 * nthreads);
+
+  // `formatted[s]` counts the blocks of the round in buffer set `s` that
+  // are ready, and `written` counts the rounds written so far.
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::size_t formatted[2] = {0, 0};
+  std::size_t written = 0;
+  bool failed = false;
+
+  grb::detail::parallel_invoke(nthreads + 1, [&](std::size_t id) {
+    if (id == 0) {
+      for (std::size_t r = 0; r < nrounds; r++) {
+        std::size_t round = std::min(nthreads, nblocks - r * nthreads);
+        {
+          std::unique_lock lock(mutex);
+          cv.wait(lock, [&] { return formatted[r % 2] == round || failed; });
+          if (failed) {
+            return;
+          }
+        }
+        for (std::size_t t = 0; t < round; t++) {
+          buffers[(r % 2) * nthreads + t].write(f);
+        }
+        {
+          std::lock_guard lock(mutex);
+          formatted[r % 2] = 0;
+          written++;
+        }
+        cv.notify_all();
+      }
+      return;
+    }
+
+    std::size_t t = id - 1;
+    for (std::size_t r = 0; r * nthreads + t < nblocks; r++) {
+      {
+        // Round `r` reuses the buffers of round `r - 2`.
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&] { return written + 1 >= r || failed; });
+        if (failed) {
+          return;
+        }
+      }
+      try {
+        format(r * nthreads + t, buffers[(r % 2) * nthreads + t]);
+      } catch (...) {
+        {
+          std::lock_guard lock(mutex);
+          failed = true;
+        }
+        cv.notify_all();
+        throw;
+      }
+      {
+        std::lock_guard lock(mutex);
+        formatted[r % 2]++;
+      }
+      cv.notify_all();
+    }
+  });
+}
+
+// Write each element of `matrix` for which `keep(i, j)` holds to `f`,
+// formatted by `emit(buffer, i, j, value)` in parallel blocks.  CSR matrices
+// are split into row blocks of about `write_block_size` elements, matrices
+// with random access iterators into blocks of elements, and other matrices
+// are written serially.
+template <typename M, typename Keep, typename Emit>
+void write_matrix_elements(std::ofstream& f, M&& matrix, Keep&& keep,
+                           Emit&& emit) {
+  auto&& storage = storage_of(std::as_const(matrix));
+  using storage_type = std::remove_cvref_t<decltype(storage)>;
+
+  std::size_t nnz = matrix.size();
+  std::size_t nblocks = (nnz + write_block_size - 1) / write_block_size;
+  std::size_t nthreads = grb::detail::num_threads(nnz, write_block_size);
+
+  if constexpr (CSRStorage<storage_type>) {
+    std::size_t m = matrix.shape()[0];
+    const auto& csr = storage;
+    auto rowptr = csr.rowptr_data();
+    auto colind = csr.colind_data();
+    auto values = csr.values_data();
+
+    // Rows [row_first[b], row_first[b + 1]) form block `b`.
+    std::vector<std::size_t> row_first(nblocks + 1, m);
+    for (std::size_t b = 0; b < nblocks; b++) {
+      row_first[b] = std::lower_bound(rowptr, rowptr + m,
+                                      b * write_block_size,
+                                      [](auto offset, std::size_t target) {
+                                        return std::size_t(offset) < target;
+                                      }) -
+                     rowptr;
+    }
+
+    write_blocks(f, nblocks, nthreads, [&](std::size_t b, line_buffer& out) {
+      for (std::size_t i = row_first[b]; i < row_first[b + 1]; i++) {
+        for (auto k = rowptr[i]; k < rowptr[i + 1]; k++) {
+          if (keep(i, colind[k])) {
+            emit(out, i, colind[k], values[k]);
+          }
+        }
+      }
+    });
+  } else if constexpr (std::random_access_iterator<
+                           decltype(std::ranges::begin(matrix))>) {
+    auto begin = std::ranges::begin(matrix);
+    write_blocks(f, nblocks, nthreads, [&](std::size_t b, line_buffer& out) {
+      auto first = begin + b * write_block_size;
+      auto last = begin + std::min(nnz, (b + 1) * write_block_size);
+      for (auto iter = first; iter != last; ++iter) {
+        auto&& [index, value] = *iter;
+        auto&& [i, j] = index;
+        if (keep(i, j)) {
+          emit(out, i, j, value);
+        }
+      }
+    });
+  } else {
+    line_buffer out;
+    for (auto&& [index, value] : matrix) {
+      auto&& [i, j] = index;
+      if (keep(i, j)) {
+        emit(out, i, j, value);
+      }
+      if (out.size() >= (std::size_t(1) << 22)) {
+        out.write(f);
+      }
+    }
+    out.write(f);
+  }
+}
+
+template <typename M, typename Keep>
+std::size_t count_matrix_elements(M&& matrix, Keep&& keep) {
+  std::size_t count = 0;
+  for (auto&& [index, _] : matrix) {
+    auto&& [i, j] = index;
+    if (keep(i, j)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+template <typename T>
+std::string mm_field_name() {
+  if constexpr (std::is_floating_point_v<T>) {
+    return "real";
+  } else {
+    return "integer";
+  }
+}
+
+inline std::ofstream open_for_writing(const std::string& file_path) {
+  std::ofstream f(file_path, std::ios::binary | std::ios::trunc);
+  if (!f.is_open()) {
+    throw std::runtime_error("mmwrite: cannot open " + file_path);
+  }
+  return f;
+}
+
+} // namespace __detail
+
+/// Write `matrix` to the Matrix Market file `file_path`.  Elements are
+/// formatted with `std::to_chars` by several threads at once, each over a
+/// block of rows, and written with large sequential writes.
+template <MatrixRange M>
+void mmwrite(const std::string& file_path, M&& matrix,
+             const mmwrite_options& options = {}) {
+  using T = grb::matrix_scalar_t<M>;
+
+  if (options.symmetric && matrix.shape()[0] != matrix.shape()[1]) {
+    throw grb::invalid_argument("mmwrite: symmetric matrix must be square.");
+  }
+
+  auto keep = [&](std::size_t i, std::size_t j) {
+    return !options.symmetric || i >= j;
+  };
+
+  std::size_t nnz = options.symmetric
+                        ? __detail::count_matrix_elements(matrix, keep)
+                        : std::size_t(matrix.size());
+
+  auto f = __detail::open_for_writing(file_path);
+
+  __detail::line_buffer header;
+  header.append("%%MatrixMarket matrix coordinate " +
+                (options.pattern ? std::string("pattern")
+                                 : __detail::mm_field_name<T>()) +
+                (options.symmetric ? " symmetric\n" : " general\n"));
+  header.append(std::size_t(matrix.shape()[0]));
+  header.put(' ');
+  header.append(std::size_t(matrix.shape()[1]));
+  header.put(' ');
+  header.append(nnz);
+  header.put('\n');
+  header.write(f);
+
+  __detail::write_matrix_elements(
+      f, matrix, keep,
+      [&](__detail::line_buffer& out, std::size_t i, std::size_t j,
+          auto&& value) {
+        out.append(i + 1);
+        out.put(' ');
+        out.append(j + 1);
+        if (!options.pattern) {
+          out.put(' ');
+          out.append(T(value));
+        }
+        out.put('\n');
+      });
+
+  if (!f) {
+    throw std::runtime_error("mmwrite: error writing " + file_path);
+  }
+}
+
+/// Write `vector` to the Matrix Market file `file_path` as a coordinate
+/// matrix with one column.  `options.symmetric` is ignored.
+template <VectorRange V>
+void mmwrite(const std::string& file_path, V&& vector,
+             const mmwrite_options& options = {}) {
+  using T = grb::vector_scalar_t<V>;
+
+  auto f = __detail::open_for_writing(file_path);
+
+  __detail::line_buffer header;
+  header.append("%%MatrixMarket matrix coordinate " +
+                (options.pattern ? std::string("pattern")
+                                 : __detail::mm_field_name<T>()) +
+                " general\n");
+  header.append(std::size_t(vector.shape()));
+  header.append(std::string(" 1 "));
+  header.append(std::size_t(vector.size()));
+  header.put('\n');
+  header.write(f);
+
+  auto emit = [&](__detail::line_buffer& out, std::size_t i, auto&& value) {
+    out.append(i + 1);
+    if (options.pattern) {
+      out.append(std::string(" 1\n"));
+    } else {
+      out.append(std::string(" 1 "));
+      out.append(T(value));
+      out.put('\n');
+    }
+  };
+
+  if constexpr (grb::detail::BitmapVector<std::remove_cvref_t<V>>) {
+    // Blocks of indices, scanned through the presence bitmap.
+    auto&& flags = vector.backend().flags();
+    auto&& values = vector.backend().values();
+    std::size_t n = vector.shape();
+    std::size_t block = __detail::write_block_size * 4;
+    std::size_t nblocks = (n + block - 1) / block;
+    std::size_t nthreads =
+        grb::detail::num_threads(vector.size(), __detail::write_block_size);
+
+    __detail::write_blocks(
+        f, nblocks, nthreads, [&](std::size_t b, __detail::line_buffer& out) {
+          std::size_t last = std::min(n, (b + 1) * block);
+          for (std::size_t i = flags.find_next(b * block); i < last;
+               i = flags.find_next(i + 1)) {
+            emit(out, i, values[i]);
+          }
+        });
+  } else {
+    __detail::line_buffer out;
+    for (auto&& [index, value] : vector) {
+      emit(out, index, value);
+    }
+    out.write(f);
+  }
+
+  if (!f) {
+    throw std::runtime_error("mmwrite: error writing " + file_path);
+  }
+}
+
+/// Write `matrix` to `file_path` as an edge list, with one line
+/// `i<delimiter>j[<delimiter>v]` per element and no header.  Lines are
+/// formatted in parallel as in `grb::mmwrite`.
+template <MatrixRange M>
+void write_edge_list(const std::string& file_path, M&& matrix,
+                     const edge_list_options& options = {}) {
+  using T = grb::matrix_scalar_t<M>;
+
+  auto f = __detail::open_for_writing(file_path);
+  std::size_t base = options.one_indexed ? 1 : 0;
+
+  __detail::write_matrix_elements(
+      f, matrix, [](std::size_t, std::size_t) { return true; },
+      [&](__detail::line_buffer& out, std::size_t i, std::size_t j,
+          auto&& value) {
+        out.append(i + base);
+        out.put(options.delimiter);
+        out.append(j + base);
+        if (options.weights) {
+          out.put(options.delimiter);
+          out.append(T(value));
+        }
+        out.put('\n');
+      });
+
+  if (!f) {
+    throw std::runtime_error("write_edge_list: error writing " + file_path);
+  }
+}
+
+} // namespace grb
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <grb/detail/parallel.hpp>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#define GRB_HAS_NUMA 1
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace grb {
+
+/// How `grb::numa_allocator` places the pages of an allocation on the NUMA
+/// nodes of the machine.
+enum class numa_policy {
+  /// Split the pages of the allocation evenly into one contiguous block per
+  /// thread, and have the thread of each block touch it first, on the
+  /// block's node.  For the element arrays of a CSR matrix, even blocks
+  /// roughly match the equal-element row ranges of the row-parallel
+  /// kernels; the allocator does not see the rows themselves.
+  first_touch,
+
+  /// Spread the pages round-robin over all nodes, for data that every
+  /// thread reads uniformly.
+  interleave
+};
+
+namespace __detail {
+
+#ifdef GRB_HAS_NUMA
+
+// Maximum number of NUMA nodes supported by the node masks below.
+inline constexpr std::size_t max_numa_nodes = 1024;
+
+// A set of nodes, one bit per node, as `mbind` expects.
+using numa_node_mask = std::vector<unsigned long>;
+
+// The NUMA nodes this process may allocate memory on, or no nodes if the
+// kernel does not support NUMA policies.
+inline const std::vector<std::size_t>& numa_nodes() {
+  static std::vector<std::size_t> nodes = [] {
+    constexpr std::size_t word_bits = sizeof(unsigned long) * 8;
+    numa_node_mask mask(max_numa_nodes / word_bits);
+    std::vector<std::size_t> nodes;
+    if (::syscall(SYS_get_mempolicy, nullptr, mask.data(), max_numa_nodes,
+                  nullptr, MPOL_F_MEMS_ALLOWED) != 0) {
+      return nodes;
+    }
+    for (std::size_t node = 0; node < max_numa_nodes; node++) {
+      if ((mask[node / word_bits] >> (node % word_bits)) & 1) {
+        nodes.push_back(node);
+      }
+    }
+    return nodes;
+  }();
+  return nodes;
+}
+
+inline numa_node_mask make_node_mask(const std::vector<std::size_t>& nodes) {
+  constexpr std::size_t word_bits = sizeof(unsigned long) * 8;
+  numa_node_mask mask(max_numa_nodes / word_bits);
+  for (auto&& node : nodes) {
+    mask[node / word_bits] |= 1ul << (node % word_bits);
+  }
+  return mask;
+}
+
+// Set the memory policy of the pages `[data, data + bytes)`.  Placement is
+// a hint: failures leave the pages under the default policy.
+inline void numa_bind(void* data, std::size_t bytes, int mode,
+                      const numa_node_mask& mask) {
+  ::syscall(SYS_mbind, data, bytes, mode, mask.data(), max_numa_nodes, 0);
+}
+
+inline std::size_t page_size() {
+  static std::size_t size = std::size_t(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+// Map `bytes` bytes of fresh pages and place them according to `policy`.
+inline void* numa_allocate(std::size_t bytes, numa_policy policy) {
+  void* data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+
+  auto&& nodes = numa_nodes();
+  std::size_t npages = (bytes + page_size() - 1) / page_size();
+
+  if (policy == numa_policy::interleave) {
+    if (nodes.size() > 1) {
+      numa_bind(data, npages * page_size(), MPOL_INTERLEAVE,
+                make_node_mask(nodes));
+    }
+    return data;
+  }
+
+  // Block `id` of `nthreads` is preferred on node `id * nodes / nthreads`,
+  // so placement does not depend on where the scheduler runs the thread
+  // touching it.
+  std::size_t nthreads =
+      std::min(grb::detail::max_threads(), std::max<std::size_t>(npages, 1));
+  grb::detail::parallel_for(
+      npages, nthreads,
+      [&](std::size_t id, std::size_t first, std::size_t last) {
+        auto block = static_cast<char*>(data) + first * page_size();
+        if (nodes.size() > 1 && first < last) {
+          numa_bind(block, (last - first) * page_size(), MPOL_PREFERRED,
+                    make_node_mask({nodes[id * nodes.size() / nthreads]}));
+        }
+        auto touch = static_cast<volatile char*>(block);
+        for (std::size_t page = 0; page < last - first; page++) {
+          touch[page * page_size()] = 0;
+        }
+      });
+  return data;
+}
+
+inline void numa_deallocate(void* data, std::size_t bytes) noexcept {
+  ::munmap(data, bytes);
+}
+
+#endif
+
+} // namespace __detail
+
+/// Allocator placing large allocations on the NUMA nodes of the machine
+/// according to a `grb::numa_policy`, for use as the `Allocator` of
+/// `grb::matrix` and `grb::vector`, for example
+/// `grb::matrix<float, int, grb::sparse, grb::numa_allocator<float>>`.
+///
+/// Allocations of at least `min_bytes` bytes are mapped directly from the
+/// system and placed with `mbind`; smaller ones, and all allocations on
+/// systems other than Linux, use `operator new`.
+template <typename T>
+class numa_allocator {
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  static constexpr std::size_t min_bytes = std::size_t(1) << 20;
+
+  numa_allocator(
+      grb::numa_policy policy = grb::numa_policy::first_touch) noexcept
+      : policy_(policy) {}
+
+  template <typename U>
+  numa_allocator(const numa_allocator<U>& other) noexcept
+      : policy_(other.policy()) {}
+
+  T* allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+#ifdef GRB_HAS_NUMA
+    if (n * sizeof(T) >= min_bytes) {
+      return static_cast<T*>(__detail::numa_allocate(n * sizeof(T), policy_));
+    }
+#endif
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+#ifdef GRB_HAS_NUMA
+    if (n * sizeof(T) >= min_bytes) {
+      __detail::numa_deallocate(p, n * sizeof(T));
+      return;
+    }
+#endif
+    ::operator delete(p, std::align_val_t(alignof(T)));
+  }
+
+  grb::numa_policy policy() const noexcept {
+    return policy_;
+  }
+
+  /// Number of NUMA nodes memory is placed on, which is 1 on machines
+  /// without NUMA.
+  static std::size_t num_nodes() {
+#ifdef GRB_HAS_NUMA
+    return std::max<std::size_t>(__detail::numa_nodes().size(), 1);
+#else
+    return 1;
+#endif
+  }
+
+  // Memory from any policy is released the same way.
+  template <typename U>
+  bool operator==(const numa_allocator<U>&) const noexcept {
+    return true;
+  }
+
+private:
+  grb::numa_policy policy_;
+};
+
+} // namespace grb
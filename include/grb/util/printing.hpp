@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <utility>
 
 namespace grb {
 
@@ -21,11 +22,22 @@ void print(M&& matrix, std::string label = "") {
   }
   std::cout << std::endl;
 
-  for (auto&& tuple : matrix) {
-    auto&& [index, value] = tuple;
-    auto&& [i, j] = index;
-
-    std::cout << "(" << i << ", " << j << "): " << value << std::endl;
+  if constexpr (requires { grb::raw_arrays(std::as_const(matrix)); }) {
+    auto [shape, rowptr, colind, values] =
+        grb::raw_arrays(std::as_const(matrix));
+    for (std::size_t i = 0; i < std::size_t(shape[0]); i++) {
+      for (auto k = rowptr[i]; k < rowptr[i + 1]; k++) {
+        std::cout << "(" << i << ", " << colind[k] << "): " << values[k]
+                  << std::endl;
+      }
+    }
+  } else {
+    for (auto&& tuple : matrix) {
+      auto&& [index, value] = tuple;
+      auto&& [i, j] = index;
+
+      std::cout << "(" << i << ", " << j << "): " << value << std::endl;
+    }
   }
 }
 
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <grb/detail/trace.hpp>
+#include <iomanip>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace grb {
+
+/// Return the algorithm calls traced so far, in the order they finished.
+/// Always empty unless `GRB_ENABLE_TRACING` is defined.
+inline std::vector<trace_event> trace_events() {
+  return grb::detail::trace_log::instance().events();
+}
+
+/// Discard the algorithm calls traced so far.
+inline void clear_trace() {
+  grb::detail::trace_log::instance().clear();
+}
+
+/// Return the traced algorithm calls in the Chrome trace event format, which
+/// `chrome://tracing` and Perfetto display as a timeline with one row per
+/// thread.
+inline nlohmann::json chrome_trace() {
+  nlohmann::json events = nlohmann::json::array();
+  for (auto&& event : trace_events()) {
+    nlohmann::json operands = nlohmann::json::array();
+    for (auto&& operand : event.operands) {
+      operands.push_back({{"shape", operand.shape},
+                          {"nnz", operand.nnz},
+                          {"backend", operand.backend}});
+    }
+
+    events.push_back({{"name", event.name},
+                      {"cat", "grb"},
+                      {"ph", "X"},
+                      {"ts", event.start_us},
+                      {"dur", event.duration_us},
+                      {"pid", 0},
+                      {"tid", event.thread},
+                      {"args",
+                       {{"kernel", event.kernel},
+                        {"mask", event.mask},
+                        {"flops", event.flops},
+                        {"bytes", event.bytes},
+                        {"operands", operands}}}});
+  }
+
+  return {{"traceEvents", events}, {"displayTimeUnit", "ms"}};
+}
+
+/// Write `grb::chrome_trace()` to the file `file_path`.
+inline void write_chrome_trace(const std::string& file_path) {
+  std::ofstream f(file_path);
+  if (!f.is_open()) {
+    throw std::runtime_error("write_chrome_trace: cannot open " + file_path);
+  }
+  f << chrome_trace().dump() << std::endl;
+}
+
+/// Return a table of the traced algorithm calls, aggregated by algorithm and
+/// kernel and sorted by total time, with their number of calls, total and
+/// mean time, flop rate and bytes of results.
+inline std::string trace_report() {
+  struct totals {
+    std::size_t calls = 0;
+    double total_us = 0;
+    double max_us = 0;
+    std::size_t flops = 0;
+    std::size_t bytes = 0;
+  };
+
+  std::map<std::pair<std::string, std::string>, totals> rows;
+  for (auto&& event : trace_events()) {
+    auto&& row = rows[{event.name, event.kernel}];
+    row.calls++;
+    row.total_us += event.duration_us;
+    row.max_us = std::max(row.max_us, event.duration_us);
+    row.flops += event.flops;
+    row.bytes += event.bytes;
+  }
+
+  std::vector<std::pair<std::pair<std::string, std::string>, totals>> sorted(
+      rows.begin(), rows.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](auto&& a, auto&& b) {
+                     return a.second.total_us > b.second.total_us;
+                   });
+
+  std::ostringstream out;
+  out << std::left << std::setw(24) << "operation" << std::setw(20)
+      << "kernel" << std::right << std::setw(8) << "calls" << std::setw(14)
+      << "total (ms)" << std::setw(14) << "mean (us)" << std::setw(14)
+      << "max (us)" << std::setw(10) << "GFLOPS" << std::setw(14) << "bytes"
+      << "\n";
+
+  out << std::fixed;
+  for (auto&& [key, row] : sorted) {
+    double gflops = row.total_us > 0 ? row.flops / row.total_us * 1e-3 : 0;
+    out << std::left << std::setw(24) << key.first << std::setw(20)
+        << key.second << std::right << std::setw(8) << row.calls
+        << std::setprecision(3) << std::setw(14) << row.total_us * 1e-3
+        << std::setprecision(1) << std::setw(14) << row.total_us / row.calls
+        << std::setw(14) << row.max_us << std::setprecision(3)
+        << std::setw(10) << gflops << std::setw(14) << row.bytes << "\n";
+  }
+
+  return out.str();
+}
+
+} // namespace grb
@@ -1,7 +1,13 @@
 
 #pragma once
 
+#include "binary_io.hpp"
+#include "edge_list.hpp"
 #include "generate.hpp"
+#include "huge_page_allocator.hpp"
 #include "index.hpp"
+#include "matrix_write.hpp"
+#include "numa_allocator.hpp"
 #include "printing.hpp"
 #include "read_matrix.hpp"
+#include "workspace.hpp"
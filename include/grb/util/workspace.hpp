@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace grb {
+
+/// A monotonic arena for the results and temporaries of the steps of an
+/// iterative algorithm.  Allocation bumps a pointer through large blocks,
+/// deallocation does nothing, and `reset()` releases every allocation at
+/// once.  When a step needed more than one block, `reset()` replaces the
+/// blocks with a single block as large as all of them, so that repeating a
+/// step of the same size allocates nothing from the system.
+///
+/// Algorithms such as `grb::multiply` accept a workspace as their first
+/// argument, and return results allocated from it that stay valid until the
+/// workspace is reset.  Alternating between two workspaces keeps the results
+/// of the previous step alive while computing the next one.
+class workspace {
+public:
+  /// Create a workspace that allocates blocks of at least `block_size`
+  /// bytes.
+  explicit workspace(std::size_t block_size = std::size_t(1) << 16)
+      : block_size_(std::max<std::size_t>(block_size, 64)) {}
+
+  workspace(const workspace&) = delete;
+  workspace& operator=(const workspace&) = delete;
+
+  /// Allocate `bytes` bytes aligned to `alignment`, a power of two.
+  void* allocate(std::size_t bytes,
+                 std::size_t alignment = alignof(std::max_align_t)) {
+    if (void* p = try_allocate_(bytes, alignment)) {
+      return p;
+    }
+
+    std::size_t size = std::max(block_size_, bytes + alignment);
+    if (!blocks_.empty()) {
+      size = std::max(size, 2 * blocks_.back().size);
+    }
+    add_block_(size);
+    return try_allocate_(bytes, alignment);
+  }
+
+  /// Release every allocation, including those of the thread-local
+  /// sub-arenas, keeping the memory for reuse.
+  void reset() {
+    if (blocks_.size() > 1) {
+      std::size_t total = capacity();
+      blocks_.clear();
+      add_block_(total);
+    }
+    offset_ = 0;
+    used_ = 0;
+
+    for (auto&& local : locals_) {
+      local->reset();
+    }
+  }
+
+  /// The sub-arena of thread `thread` of a parallel region, so that threads
+  /// can allocate without synchronizing.  Sub-arenas are reset with their
+  /// parent.
+  workspace& local(std::size_t thread) {
+    std::lock_guard lock(mutex_);
+    while (locals_.size() <= thread) {
+      locals_.push_back(std::make_unique<workspace>(block_size_));
+    }
+    return *locals_[thread];
+  }
+
+  /// Bytes allocated since the last reset, not counting sub-arenas.
+  std::size_t used() const noexcept {
+    return used_;
+  }
+
+  /// Bytes held in blocks, not counting sub-arenas.
+  std::size_t capacity() const noexcept {
+    std::size_t total = 0;
+    for (auto&& block : blocks_) {
+      total += block.size;
+    }
+    return total;
+  }
+
+  /// Number of blocks allocated from the system so far, which stops growing
+  /// once the steps of an algorithm fit in the workspace.
+  std::size_t system_allocations() const noexcept {
+    return system_allocations_;
+  }
+
+private:
+  struct block {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size;
+  };
+
+  void* try_allocate_(std::size_t bytes, std::size_t alignment) noexcept {
+    if (blocks_.empty()) {
+      return nullptr;
+    }
+
+    auto&& block = blocks_.back();
+    std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data.get());
+    std::uintptr_t p = (base + offset_ + alignment - 1) & ~(alignment - 1);
+    if (p - base > block.size || bytes > block.size - (p - base)) {
+      return nullptr;
+    }
+
+    offset_ = p - base + bytes;
+    used_ += bytes;
+    return reinterpret_cast<void*>(p);
+  }
+
+  void add_block_(std::size_t size) {
+    blocks_.push_back(
+        {std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    offset_ = 0;
+    system_allocations_++;
+  }
+
+  std::size_t block_size_;
+  std::vector<block> blocks_;
+  std::size_t offset_ = 0;
+  std::size_t used_ = 0;
+  std::size_t system_allocations_ = 0;
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<workspace>> locals_;
+};
+
+/// C++ allocator drawing from a `grb::workspace`, for containers such as
+/// `grb::vector<T, I, grb::dense, grb::workspace_allocator<T>>`.
+/// Deallocation does nothing; memory is reclaimed by resetting the
+/// workspace.
+template <typename T>
+class workspace_allocator {
+public:
+  using value_type = T;
+
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  workspace_allocator(grb::workspace& workspace) noexcept
+      : workspace_(&workspace) {}
+
+  template <typename U>
+  workspace_allocator(const workspace_allocator<U>& other) noexcept
+      : workspace_(&other.get_workspace()) {}
+
+  T* allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(workspace_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t) noexcept {}
+
+  grb::workspace& get_workspace() const noexcept {
+    return *workspace_;
+  }
+
+  template <typename U>
+  bool operator==(const workspace_allocator<U>& other) const noexcept {
+    return workspace_ == &other.get_workspace();
+  }
+
+private:
+  grb::workspace* workspace_;
+};
+
+} // namespace grb
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <grb/grb.hpp>
+#include <string>
+
+TEMPLATE_TEST_CASE("save_binary and load_binary", "[template]", int, float,
+                   bool) {
+  using T = TestType;
+
+  grb::matrix<T, int> a({23, 41});
+  for (int i = 0; i < 23; i++) {
+    for (int j = (i * 5) % 7; j < 41; j += 2 + i % 5) {
+      a[{i, j}] = T(i + j + 1);
+    }
+  }
+
+  auto path =
+      (std::filesystem::temp_directory_path() / "grb_binary_1.bin").string();
+  grb::save_binary(a, path);
+
+  auto check = [&](auto&& b) {
+    REQUIRE(b.shape() == a.shape());
+    REQUIRE(b.size() == a.size());
+
+    std::size_t count = 0;
+    for (auto&& [index, value] : b) {
+      auto&& [i, j] = index;
+      REQUIRE(a[{i, j}] == value);
+      count++;
+    }
+    REQUIRE(count == a.size());
+
+    for (auto&& [index, value] : a) {
+      auto iter = b.find(index);
+      REQUIRE(iter != b.end());
+      auto&& [_, b_value] = *iter;
+      REQUIRE(b_value == value);
+    }
+  };
+
+  SECTION("copying load") {
+    auto b = grb::load_binary<T, int>(path);
+    check(b);
+  }
+
+  SECTION("mapped load") {
+    auto b = grb::mmap_binary<T, int>(path);
+    check(b);
+
+    // Rows of the mapped matrix are its CSR rows.
+    auto row = b.row(3);
+    for (auto&& [index, value] : row) {
+      REQUIRE(index[0] == 3);
+      REQUIRE(a[{3, index[1]}] == value);
+    }
+
+    // The mapping outlives the original handle.
+    auto c = b;
+    b = grb::mmap_binary<T, int>(path);
+    check(c);
+  }
+
+  SECTION("view of a matrix") {
+    grb::save_binary(grb::transpose(a), path);
+    auto t = grb::load_binary<T, int>(path);
+    REQUIRE(t.shape()[0] == a.shape()[1]);
+    REQUIRE(t.size() == a.size());
+    for (auto&& [index, value] : a) {
+      auto&& [i, j] = index;
+      REQUIRE(t[{j, i}] == value);
+    }
+  }
+
+  SECTION("type mismatch") {
+    REQUIRE_THROWS_AS((grb::load_binary<double, int>(path)),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS((grb::mmap_binary<T, long long>(path)),
+                      std::runtime_error);
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("mapped matrices are traversed by prefetched rows", "[binary]") {
+  auto a = grb::generate_random<float, int>({300, 200}, 0.05, 7);
+  auto path =
+      (std::filesystem::temp_directory_path() / "grb_binary_2.bin").string();
+  grb::save_binary(a, path);
+  auto b = grb::mmap_binary<float, int>(path);
+
+  // Blocks of a few rows exercise the prefetching of every block.
+  int i = 10;
+  std::size_t count = 0;
+  for (auto&& row : b.rows(10, 250, 64)) {
+    for (auto&& [index, value] : row) {
+      REQUIRE(index[0] == i);
+      REQUIRE(a[{i, index[1]}] == value);
+      count++;
+    }
+    i++;
+  }
+  REQUIRE(i == 250);
+
+  std::size_t expected = 0;
+  for (auto&& [index, _] : a) {
+    expected += index[0] >= 10 && index[0] < 250;
+  }
+  REQUIRE(count == expected);
+
+  auto check_multiply = [&](auto&& x, auto&& mask) {
+    auto reference = grb::multiply(a, x, grb::plus(), grb::multiplies(), mask);
+    auto y = grb::multiply(b, x, grb::plus(), grb::multiplies(), mask);
+    REQUIRE(y.size() == reference.size());
+    for (auto&& [index, value] : reference) {
+      REQUIRE(y.find(index) != y.end());
+      REQUIRE(float(y[index]) == float(value));
+    }
+  };
+
+  grb::vector<float, int> dense_x(200);
+  for (int k = 0; k < 200; k++) {
+    dense_x[k] = k % 7 + 1;
+  }
+  auto sparse_x = grb::generate_random<float, int>(200, 0.1, 8);
+  grb::vector<bool, int> mask(300);
+  for (int i = 0; i < 300; i += 2) {
+    mask[i] = true;
+  }
+
+  check_multiply(dense_x, grb::full_vector_mask());
+  check_multiply(sparse_x, grb::full_vector_mask());
+  check_multiply(dense_x, mask);
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <grb/grb.hpp>
+
+namespace {
+
+// Whether `b` holds the elements of `a`, with explicit zeros allowed in `b`
+// where `a` has no element if `dense`.
+template <typename A, typename B>
+bool same_elements(const A& a, const B& b, bool dense) {
+  if (a.shape() != b.shape()) {
+    return false;
+  }
+  std::size_t matched = 0;
+  for (auto&& [index, value] : b) {
+    auto iter = a.find(index);
+    if (iter != a.end()) {
+      auto&& [_, a_value] = *iter;
+      if (a_value != value) {
+        return false;
+      }
+      matched++;
+    } else if (!dense || value != 0) {
+      return false;
+    }
+  }
+  return matched == a.size();
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("binsparse round trips", "[template]", int, float) {
+  using T = TestType;
+  auto a = grb::generate_random<T, int>({37, 23}, 0.1, 21);
+  // An empty row and column, which DCSR leaves out.
+  grb::matrix<T, int> b(a.shape());
+  for (auto&& [index, value] : a) {
+    if (index[0] != 5 && index[1] != 7) {
+      b.insert({index, value});
+    }
+  }
+
+  grb::matrix<T, int, grb::coordinate> b_coo(b.shape());
+  b_coo.insert(b.begin(), b.end());
+  grb::matrix<T, int, grb::dense> b_dense(b.shape());
+  b_dense.insert(b.begin(), b.end());
+
+  auto path =
+      (std::filesystem::temp_directory_path() / "grb_binsparse_1.hdf5")
+          .string();
+
+  for (std::string format : {"CSR", "CSC", "DCSR", "COO", "DMATR"}) {
+    grb::experimental::binsparse_options options;
+    options.format = format;
+    options.chunk_size = 7;
+    bool dense = format == "DMATR";
+
+    grb::experimental::binsparse_mwrite(path, b, options);
+    auto c = grb::experimental::binsparse_mread<T, int>(path, options);
+    REQUIRE(same_elements(b, c, dense));
+
+    auto c_coo = grb::experimental::binsparse_mread<T, int, grb::coordinate>(
+        path, options);
+    REQUIRE(same_elements(b, c_coo, dense));
+
+    grb::experimental::binsparse_mwrite(path, b_coo, options);
+    c = grb::experimental::binsparse_mread<T, int>(path, options);
+    REQUIRE(same_elements(b, c, dense));
+
+    grb::experimental::binsparse_mwrite(path, b_dense, options);
+    c = grb::experimental::binsparse_mread<T, int>(path, options);
+    REQUIRE(same_elements(b, c, dense));
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("binsparse_mread checks dataset lengths", "[binsparse]") {
+  auto a = grb::generate_random<float, int>({20, 20}, 0.2, 22);
+  auto path =
+      (std::filesystem::temp_directory_path() / "grb_binsparse_2.hdf5")
+          .string();
+
+  for (std::string format : {"CSR", "CSC", "DCSR", "COO", "DMATR"}) {
+    grb::experimental::binsparse_options options;
+    options.format = format;
+    grb::experimental::binsparse_mwrite(path, a, options);
+
+    // Claim one more stored value than the datasets hold.
+    {
+      H5::H5File f(path.c_str(), H5F_ACC_RDWR);
+      auto text = hdf5_tools::read_dataset<char>(f, "metadata");
+      auto metadata = nlohmann::json::parse(text.begin(), text.end());
+      std::size_t nnz = metadata["number_of_stored_values"];
+      metadata["number_of_stored_values"] = nnz + 1;
+      if (format == "DMATR") {
+        metadata["shape"] = {21, 20};
+      }
+      f.unlink("metadata");
+      hdf5_tools::write_dataset(f, "metadata", metadata.dump(2));
+      f.close();
+    }
+
+    REQUIRE_THROWS_AS((grb::experimental::binsparse_mread<float, int>(path)),
+                      std::runtime_error);
+  }
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+#include <vector>
+
+TEST_CASE("algorithms read csr_matrix_view in place", "[csr_matrix_view]") {
+  auto a = grb::generate_random<float, int>({70, 50}, 0.1, 12);
+  auto b = grb::generate_random<float, int>({50, 40}, 0.1, 13);
+
+  // External CSR buffers, as handed over by another component.
+  auto [shape, rowptr_span, colind_span, values_span] = grb::raw_arrays(a);
+  std::vector<int> rowptr(rowptr_span.begin(), rowptr_span.end());
+  std::vector<int> colind(colind_span.begin(), colind_span.end());
+  std::vector<float> values(values_span.begin(), values_span.end());
+  grb::csr_matrix_view view(values.data(), rowptr.data(), colind.data(),
+                            shape, values.size());
+
+  // SpGEMM borrows the view's arrays instead of converting it.
+  static_assert(std::is_lvalue_reference_v<decltype(
+                    grb::__detail::csr_operand<int>(view))>);
+
+  auto check_vector = [](auto&& x, auto&& y) {
+    REQUIRE(x.size() == y.size());
+    for (auto&& [i, value] : y) {
+      REQUIRE(x.find(i) != x.end());
+      REQUIRE(float(x[i]) == float(value));
+    }
+  };
+
+  auto check_matrix = [](auto&& x, auto&& y) {
+    REQUIRE(x.shape() == y.shape());
+    REQUIRE(x.size() == y.size());
+    for (auto&& [index, value] : y) {
+      auto iter = x.find(index);
+      REQUIRE(iter != x.end());
+      auto&& [_, x_value] = *iter;
+      REQUIRE(float(x_value) == float(value));
+    }
+  };
+
+  grb::vector<float, int> dense_x(50);
+  for (int k = 0; k < 50; k++) {
+    dense_x[k] = k + 1;
+  }
+  auto sparse_x = grb::generate_random<float, int>(50, 0.2, 14);
+
+  check_vector(grb::multiply(view, dense_x), grb::multiply(a, dense_x));
+  check_vector(grb::multiply(view, sparse_x), grb::multiply(a, sparse_x));
+  check_vector(grb::reduce(view), grb::reduce(a));
+  check_matrix(grb::multiply(view, b), grb::multiply(a, b));
+  check_matrix(grb::transpose_materialize(view),
+               grb::transpose_materialize(a));
+
+  auto parts = view.partition(4);
+  REQUIRE(parts.size() == 4);
+  REQUIRE(parts.back()[1] == 70);
+}
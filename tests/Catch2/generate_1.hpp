@@ -0,0 +1,89 @@
+#pragma once
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+
+template <typename M1, typename M2>
+bool same_elements(M1&& a, M2&& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  auto a_iter = a.begin();
+  auto b_iter = b.begin();
+  for (; a_iter != a.end(); ++a_iter, ++b_iter) {
+    auto&& [a_index, a_value] = *a_iter;
+    auto&& [b_index, b_value] = *b_iter;
+    if (a_index != b_index || a_value != b_value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEMPLATE_TEST_CASE("generate_random", "[template]", int, float) {
+  using T = TestType;
+
+  auto a = grb::generate_random<T, int>({500, 300}, 0.05, 42);
+  auto b = grb::generate_random<T, int>({500, 300}, 0.05, 42);
+  auto c = grb::generate_random<T, int>({500, 300}, 0.05, 43);
+
+  REQUIRE(same_elements(a, b));
+  REQUIRE(!same_elements(a, c));
+
+  // 7500 elements expected, with a standard deviation under 100.
+  REQUIRE(a.size() > 7000);
+  REQUIRE(a.size() < 8000);
+
+  for (auto&& [index, value] : a) {
+    REQUIRE(value >= T(0));
+    REQUIRE(value <= T(1));
+  }
+
+  REQUIRE(grb::generate_random<T, int>({20, 30}, 1.0).size() == 600);
+  REQUIRE(grb::generate_random<T, int>({20, 30}, 0.0).size() == 0);
+
+  auto dense = grb::generate_random<T, int, grb::dense>({40, 40}, 0.2, 1);
+  REQUIRE(same_elements(dense, grb::generate_random<T, int>({40, 40}, 0.2, 1)));
+
+  auto u = grb::generate_random<T, int>(100000, 0.1, 5);
+  auto v = grb::generate_random<T, int>(100000, 0.1, 5);
+  auto w = grb::generate_random<T, int>(100000, 0.1, 6);
+  REQUIRE(same_elements(u, v));
+  REQUIRE(!same_elements(u, w));
+  REQUIRE(u.size() > 9000);
+  REQUIRE(u.size() < 11000);
+}
+
+TEST_CASE("generate_rmat", "[generate]") {
+  auto a = grb::generate_rmat<float, int>(10, 8, 1);
+  auto b = grb::generate_rmat<float, int>(10, 8, 1);
+  REQUIRE(same_elements(a, b));
+  REQUIRE(a.shape() == grb::index<int>{1024, 1024});
+  REQUIRE(a.size() <= 8 * 1024);
+  REQUIRE(a.size() > 4 * 1024);
+
+  // Without scrambling, the top-left quadrant is the densest.
+  auto c = grb::generate_rmat<float, int>(10, 8, 1, {.scramble = false});
+  std::size_t quadrants[2][2] = {};
+  for (auto&& [index, _] : c) {
+    auto&& [i, j] = index;
+    quadrants[i >= 512][j >= 512]++;
+  }
+  REQUIRE(quadrants[0][0] > quadrants[0][1]);
+  REQUIRE(quadrants[0][1] > quadrants[1][1]);
+  REQUIRE(quadrants[1][0] > quadrants[1][1]);
+
+  // Scrambling relabels vertices, so the degrees are the same.
+  std::vector<int> degrees_a(1024), degrees_c(1024);
+  for (auto&& [index, _] : a) {
+    degrees_a[index[0]]++;
+  }
+  for (auto&& [index, _] : c) {
+    degrees_c[index[0]]++;
+  }
+  REQUIRE(degrees_a != degrees_c);
+  std::sort(degrees_a.begin(), degrees_a.end());
+  std::sort(degrees_c.begin(), degrees_c.end());
+  REQUIRE(degrees_a == degrees_c);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+
+TEST_CASE("huge_page_allocator aligns and resizes allocations",
+          "[huge_pages]") {
+  for (auto mode : {grb::huge_page_mode::transparent,
+                    grb::huge_page_mode::hugetlb}) {
+    grb::huge_page_allocator<int> allocator(mode);
+    REQUIRE(allocator.mode() == mode);
+
+    int* small = allocator.allocate(100);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(small) % 64 == 0);
+
+    auto before = grb::huge_page_statistics().mapped_bytes;
+    std::size_t n = grb::huge_page_allocator<int>::min_bytes / sizeof(int);
+    int* large = allocator.allocate(n);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(large) %
+                grb::huge_page_allocator<int>::min_bytes ==
+            0);
+    REQUIRE(grb::huge_page_statistics().mapped_bytes == before + n * 4);
+    for (std::size_t i = 0; i < n; i++) {
+      large[i] = int(i);
+    }
+
+    // Small allocations are copied into large ones, and large ones remapped.
+    for (int i = 0; i < 100; i++) {
+      small[i] = i;
+    }
+    small = allocator.reallocate(small, 100, n);
+    REQUIRE(small[99] == 99);
+#ifdef MAP_FIXED_NOREPLACE
+    // Occupy the pages after `large` so that growing it has to move it.
+    void* blocker = ::mmap(large + n, 4096, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+                           -1, 0);
+#endif
+    large = allocator.reallocate(large, n, 3 * n);
+    REQUIRE(large[n - 1] == int(n - 1));
+    REQUIRE(reinterpret_cast<std::uintptr_t>(large) %
+                grb::huge_page_allocator<int>::min_bytes ==
+            0);
+    REQUIRE(grb::huge_page_statistics().mapped_bytes == before + 4 * n * 4);
+#ifdef MAP_FIXED_NOREPLACE
+    if (blocker != MAP_FAILED) {
+      ::munmap(blocker, 4096);
+    }
+#endif
+
+    allocator.deallocate(small, n);
+    allocator.deallocate(large, 3 * n);
+    REQUIRE(grb::huge_page_statistics().mapped_bytes == before);
+  }
+}
+
+TEST_CASE("shp::vector grows through reallocate", "[huge_pages]") {
+  shp::vector<int, grb::huge_page_allocator<int>> v;
+  std::size_t n = 3 * grb::huge_page_allocator<int>::min_bytes / sizeof(int);
+  for (std::size_t i = 0; i < n; i++) {
+    v.push_back(int(i));
+  }
+  REQUIRE(v.size() == n);
+  REQUIRE(v.capacity() >= n);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(v.data()) %
+              grb::huge_page_allocator<int>::min_bytes ==
+          0);
+  for (std::size_t i = 0; i < n; i += 1000) {
+    REQUIRE(v[i] == int(i));
+  }
+}
+
+TEST_CASE("csr_matrix stores elements with huge_page_allocator",
+          "[huge_pages]") {
+  using allocator = grb::huge_page_allocator<float>;
+
+  auto a = grb::generate_random<float, int>({1000, 1000}, 0.6, 6);
+  grb::matrix<float, int, grb::sparse, allocator> b(a.shape());
+  b.insert(a.begin(), a.end());
+  REQUIRE(b.size() == a.size());
+  REQUIRE(b.backend().huge_page_nbytes() <= b.backend().nbytes());
+
+  grb::vector<float, int> x(1000);
+  for (int j = 0; j < 1000; j++) {
+    x[j] = j % 5;
+  }
+
+  auto expected = grb::multiply(a, x);
+  auto result = grb::multiply(b, x);
+  REQUIRE(result.size() == expected.size());
+  for (auto&& [i, value] : expected) {
+    REQUIRE(result[i] == value);
+  }
+}
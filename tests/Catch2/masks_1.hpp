@@ -0,0 +1,190 @@
+#pragma once
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+
+TEMPLATE_TEST_CASE("structural and valued masks", "[template]", int, float) {
+  using T = TestType;
+
+  std::size_t n = 200;
+
+  grb::vector<T, int> a(n);
+  grb::vector<T, int> b(n);
+  for (std::size_t i = 0; i < n; i++) {
+    a[i] = T(1);
+    b[i] = T(2);
+  }
+
+  // Stored elements at multiples of 3, holding `false` at multiples of 6.
+  grb::vector<bool, int> mask(n);
+  for (std::size_t i = 0; i < n; i += 3) {
+    mask[i] = (i % 6 != 0);
+  }
+
+  using structure_type = decltype(grb::views::structure(mask));
+  static_assert(grb::is_structural_mask_v<structure_type>);
+  static_assert(grb::detail::BitmapStructureMask<structure_type>);
+  static_assert(!grb::is_structural_mask_v<decltype(mask)>);
+  static_assert(grb::is_full_mask_v<grb::full_vector_mask<>>);
+
+  auto valued = grb::ewise_intersection(a, b, grb::plus{}, mask);
+  auto structural =
+      grb::ewise_intersection(a, b, grb::plus{}, grb::views::structure(mask));
+  auto complement =
+      grb::ewise_union(a, b, grb::plus{}, grb::complement_view(mask));
+  auto structural_complement = grb::ewise_union(
+      a, b, grb::plus{}, grb::complement_view(grb::views::structure(mask)));
+
+  for (std::size_t i = 0; i < n; i++) {
+    bool stored = i % 3 == 0;
+    bool truthy = stored && i % 6 != 0;
+
+    REQUIRE((valued.find(i) != valued.end()) == truthy);
+    REQUIRE((structural.find(i) != structural.end()) == stored);
+    REQUIRE((complement.find(i) != complement.end()) == !truthy);
+    REQUIRE((structural_complement.find(i) != structural_complement.end()) ==
+            !stored);
+  }
+
+  REQUIRE(valued.size() == mask.size() / 2);
+  REQUIRE(structural.size() == mask.size());
+
+  for (auto&& [i, v] : structural) {
+    REQUIRE(v == T(3));
+  }
+}
+
+TEST_CASE("complement views", "[complement]") {
+  std::size_t n = 300;
+
+  grb::vector<int, int> v(n);
+  for (std::size_t i = 0; i < n; i += 7) {
+    v[i] = i % 2;
+  }
+
+  auto check_complement = [](auto&& view, auto&& excluded_fn,
+                             std::size_t count) {
+    std::size_t expected_size = 0;
+    for (std::size_t i = 0; i < count; i++) {
+      bool present = view.find(i) != view.end();
+      REQUIRE(present == !excluded_fn(i));
+      expected_size += present;
+    }
+    REQUIRE(view.size() == expected_size);
+    REQUIRE(std::size_t(std::ranges::distance(view.begin(), view.end())) ==
+            expected_size);
+    for (auto&& [i, value] : view) {
+      REQUIRE(value);
+      REQUIRE(!excluded_fn(i));
+    }
+  };
+
+  // `v` holds zeros at even multiples of 7, which stay in the complement.
+  check_complement(
+      grb::complement_view(v), [](auto i) { return i % 14 == 7; }, n);
+  check_complement(
+      grb::complement_view(grb::views::structure(v)),
+      [](auto i) { return i % 7 == 0; }, n);
+
+  grb::matrix<int, int> a({20, 30});
+  for (int i = 0; i < 20; i++) {
+    for (int j = i % 3; j < 30; j += 4) {
+      a[{i, j}] = j % 2;
+    }
+  }
+
+  auto in_matrix = [](int i, int j) {
+    return j >= i % 3 && (j - i % 3) % 4 == 0;
+  };
+
+  auto complement = grb::complement_view(a);
+  auto structure = grb::views::structure(a);
+  auto structure_complement = grb::complement_view(structure);
+
+  std::size_t size = 0;
+  std::size_t structure_size = 0;
+  for (int i = 0; i < 20; i++) {
+    for (int j = 0; j < 30; j++) {
+      bool excluded = in_matrix(i, j) && j % 2 == 1;
+      REQUIRE((complement.find({i, j}) != complement.end()) == !excluded);
+      REQUIRE((structure_complement.find({i, j}) !=
+               structure_complement.end()) == !in_matrix(i, j));
+      size += !excluded;
+      structure_size += !in_matrix(i, j);
+    }
+  }
+
+  REQUIRE(complement.size() == size);
+  REQUIRE(structure_complement.size() == structure_size);
+  REQUIRE(std::size_t(std::ranges::distance(complement.begin(),
+                                             complement.end())) == size);
+
+  for (auto&& [index, value] : structure_complement) {
+    auto&& [i, j] = index;
+    REQUIRE(!in_matrix(i, j));
+  }
+
+  // Views read their base as it is when they are used.
+  auto v_complement = grb::complement_view(v);
+  auto v_structure = grb::views::structure(v);
+  auto v_structure_complement = grb::complement_view(v_structure);
+  v[1] = 1;
+  v[2] = 0;
+  v[7] = 0;
+  auto v_excluded = [](auto i) { return i == 1 || (i % 14 == 7 && i != 7); };
+  check_complement(v_complement, v_excluded, n);
+  check_complement(
+      v_structure_complement,
+      [](auto i) { return i % 7 == 0 || i == 1 || i == 2; }, n);
+
+  // Matrix complements gather the excluded indices once, so iterating `a`
+  // after modifying it takes a new view.
+  a[{0, 1}] = 1;
+  a[{0, 3}] = 0;
+  REQUIRE(complement.find({0, 1}) == complement.end());
+  REQUIRE(complement.find({0, 3}) != complement.end());
+  REQUIRE(complement.size() == size);
+  REQUIRE(structure_complement.find({0, 1}) == structure_complement.end());
+  REQUIRE(structure_complement.find({0, 3}) == structure_complement.end());
+  REQUIRE(structure_complement.size() == structure_size - 2);
+
+  auto new_complement = grb::complement_view(a);
+  REQUIRE(new_complement.size() == size - 1);
+  REQUIRE(std::size_t(std::ranges::distance(new_complement.begin(),
+                                             new_complement.end())) ==
+          size - 1);
+}
+
+TEST_CASE("valued complement views skip whole words", "[complement]") {
+  // Runs of `true` spanning several words, with `false` elements and gaps
+  // at and around word boundaries.
+  std::size_t n = 1000;
+  // Even indices in the complement hold `false`; odd ones are missing.
+  std::vector<std::size_t> in_complement = {0, 63, 64, 200, 511, 999};
+  grb::vector<bool, int> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    if (std::ranges::find(in_complement, i) == in_complement.end()) {
+      v[i] = true;
+    } else if (i % 2 == 0) {
+      v[i] = false;
+    }
+  }
+
+  auto complement = grb::complement_view(v);
+  REQUIRE(complement.size() == in_complement.size());
+
+  std::vector<std::size_t> visited;
+  for (auto&& [i, value] : complement) {
+    visited.push_back(i);
+  }
+  REQUIRE(visited == in_complement);
+
+  grb::vector<bool, int> all_true(130);
+  for (std::size_t i = 0; i < 130; i++) {
+    all_true[i] = true;
+  }
+  auto empty = grb::complement_view(all_true);
+  REQUIRE(empty.size() == 0);
+  REQUIRE(empty.begin() == empty.end());
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+#include <list>
+#include <map>
+#include <random>
+
+namespace {
+
+template <typename I>
+std::vector<grb::matrix_entry<int, I>>
+random_tuples(grb::index<I> shape, std::size_t count, unsigned seed) {
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<I> row(0, shape[0] - 1);
+  std::uniform_int_distribution<I> col(0, shape[1] - 1);
+  std::uniform_int_distribution<int> value(-100, 100);
+
+  std::vector<grb::matrix_entry<int, I>> tuples;
+  for (std::size_t k = 0; k < count; k++) {
+    tuples.push_back({{row(gen), col(gen)}, value(gen)});
+  }
+  return tuples;
+}
+
+template <typename Tuples, typename Dup>
+auto reference_build(const Tuples& tuples, Dup dup) {
+  using I = std::remove_cvref_t<decltype(std::get<0>(
+      std::get<0>(*std::ranges::begin(tuples))))>;
+  std::map<std::pair<I, I>, int> reference;
+  for (auto&& [index, value] : tuples) {
+    auto [iter, inserted] = reference.try_emplace({index[0], index[1]}, value);
+    if (!inserted) {
+      iter->second = dup(iter->second, value);
+    }
+  }
+  return reference;
+}
+
+template <typename M, typename Reference>
+void check_build(const M& m, const Reference& reference) {
+  REQUIRE(std::size_t(m.size()) == reference.size());
+  for (auto&& [index, value] : m) {
+    auto iter = reference.find({index[0], index[1]});
+    REQUIRE(iter != reference.end());
+    REQUIRE(value == iter->second);
+  }
+}
+
+} // namespace
+
+TEST_CASE("matrix::build combines duplicate tuples", "[matrix]") {
+  auto tuples = random_tuples<int>({300, 200}, 50000, 11);
+
+  SECTION("CSR") {
+    grb::matrix<int, int> a({300, 200});
+    a[{3, 4}] = 1000;
+    a.build(tuples.begin(), tuples.end());
+    check_build(a, reference_build(tuples, grb::plus()));
+    for (auto&& row : a.rows()) {
+      REQUIRE(std::is_sorted(row.columns.begin(), row.columns.end()));
+    }
+
+    a.build(tuples.begin(), tuples.end(), grb::take_left());
+    check_build(a, reference_build(tuples, grb::take_left()));
+    a.build(tuples.begin(), tuples.end(), grb::take_right());
+    check_build(a, reference_build(tuples, grb::take_right()));
+  }
+
+  SECTION("COO") {
+    grb::matrix<int, int, grb::coordinate> a({300, 200});
+    a.build(tuples.begin(), tuples.end(), grb::max());
+    check_build(a, reference_build(tuples, grb::max()));
+  }
+
+  SECTION("COO with a stateful allocator") {
+    grb::workspace ws;
+    grb::matrix<int, int, grb::coordinate, grb::workspace_allocator<int>> a(
+        {300, 200}, ws);
+    a.build(tuples.begin(), tuples.end());
+    check_build(a, reference_build(tuples, grb::plus()));
+    REQUIRE(&a.backend().get_allocator().get_workspace() == &ws);
+    REQUIRE(ws.system_allocations() > 0);
+  }
+
+  SECTION("forward iterators") {
+    std::list<grb::matrix_entry<int, int>> list(tuples.begin(),
+                                                tuples.begin() + 1000);
+    grb::matrix<int, int> a({300, 200});
+    a.build(list.begin(), list.end(), grb::take_right());
+    check_build(a, reference_build(list, grb::take_right()));
+  }
+
+  SECTION("empty range") {
+    grb::matrix<int, int> a({300, 200});
+    a[{1, 1}] = 1;
+    a.build(tuples.begin(), tuples.begin());
+    REQUIRE(a.size() == 0);
+    REQUIRE(a.shape() == grb::index<int>(300, 200));
+  }
+}
+
+TEST_CASE("matrix::build with indices wider than 64 bits", "[matrix]") {
+  // Row and column indices together need 70 bits, so tuples are sorted by
+  // column and then by row.
+  grb::index<std::size_t> shape(std::size_t(1) << 40, std::size_t(1) << 30);
+  auto tuples = random_tuples<std::size_t>({1000, 50}, 5000, 12);
+  for (auto&& tuple : tuples) {
+    auto [index, value] = tuple;
+    tuple = {{index[0] << 30, index[1] << 20}, value};
+  }
+
+  grb::matrix<int, std::size_t, grb::coordinate> a(shape);
+  a.build(tuples.begin(), tuples.end());
+  check_build(a, reference_build(tuples, grb::plus()));
+
+  REQUIRE(std::is_sorted(a.begin(), a.end()));
+}
+
+TEST_CASE("matrix::build rejects out-of-bounds indices", "[matrix]") {
+  std::vector<grb::matrix_entry<int, int>> tuples = {{{0, 0}, 1},
+                                                     {{2, 5}, 2}};
+  grb::matrix<int, int> a({4, 4});
+  a[{1, 1}] = 7;
+  REQUIRE_THROWS_AS(a.build(tuples.begin(), tuples.end()), grb::out_of_range);
+  REQUIRE(a.size() == 1);
+  REQUIRE(a[{1, 1}] == 7);
+}
@@ -0,0 +1,431 @@
+#pragma once
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <grb/grb.hpp>
+#include <string>
+
+inline std::string write_temp_file(const std::string& name,
+                                   const std::string& contents) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream f(path);
+  f << contents;
+  return path.string();
+}
+
+TEMPLATE_TEST_CASE("mmread", "[template]", int, float) {
+  using T = TestType;
+
+  SECTION("general") {
+    auto path = write_temp_file("grb_mmread_general.mtx",
+                                "%%MatrixMarket matrix coordinate integer "
+                                "general\n"
+                                "% a comment\n"
+                                "%\n"
+                                "4 5 5\n"
+                                "1 1 1\n"
+                                "4 5 +2\n"
+                                "\n"
+                                "2 3 3\r\n"
+                                "2 1 4\n"
+                                "1 5 5");
+
+    grb::matrix<T, int> a(path);
+    REQUIRE(a.shape() == grb::index<int>{4, 5});
+    REQUIRE(a.size() == 5);
+    REQUIRE(a[{0, 0}] == T(1));
+    REQUIRE(a[{3, 4}] == T(2));
+    REQUIRE(a[{1, 2}] == T(3));
+    REQUIRE(a[{1, 0}] == T(4));
+    REQUIRE(a[{0, 4}] == T(5));
+
+    auto tuples = grb::mmread<T, int>(path);
+    REQUIRE(tuples.size() == 5);
+
+    std::remove(path.c_str());
+  }
+
+  SECTION("symmetric pattern") {
+    auto path = write_temp_file("grb_mmread_symmetric.mtx",
+                                "%%MatrixMarket matrix coordinate pattern "
+                                "symmetric\n"
+                                "3 3 3\n"
+                                "1 1\n"
+                                "3 1\n"
+                                "3 2\n");
+
+    grb::matrix<T, int> a(path);
+    REQUIRE(a.size() == 5);
+    REQUIRE(a[{0, 0}] == T(1));
+    REQUIRE(a[{2, 0}] == T(1));
+    REQUIRE(a[{0, 2}] == T(1));
+    REQUIRE(a[{2, 1}] == T(1));
+    REQUIRE(a[{1, 2}] == T(1));
+
+    // Rows are sorted, as CSR requires.
+    int prev_i = -1;
+    int prev_j = -1;
+    for (auto&& [index, _] : a) {
+      auto&& [i, j] = index;
+      REQUIRE((i > prev_i || (i == prev_i && j > prev_j)));
+      prev_i = i;
+      prev_j = j;
+    }
+
+    std::remove(path.c_str());
+  }
+
+  SECTION("errors") {
+    auto bounds = write_temp_file("grb_mmread_bounds.mtx",
+                                  "%%MatrixMarket matrix coordinate real "
+                                  "general\n"
+                                  "2 2 1\n"
+                                  "3 1 1.0\n");
+    REQUIRE_THROWS_AS(grb::matrix<T>(bounds), std::runtime_error);
+
+    auto extra = write_temp_file("grb_mmread_extra.mtx",
+                                 "%%MatrixMarket matrix coordinate real "
+                                 "general\n"
+                                 "2 2 1\n"
+                                 "1 1 1.0\n"
+                                 "2 2 1.0\n");
+    REQUIRE_THROWS_AS(grb::matrix<T>(extra), std::runtime_error);
+
+    REQUIRE_THROWS_AS(grb::matrix<T>("grb_mmread_missing.mtx"),
+                      std::runtime_error);
+
+    std::remove(bounds.c_str());
+    std::remove(extra.c_str());
+  }
+}
+
+TEST_CASE("mmread large", "[mmread]") {
+  // Enough lines to be split between threads.
+  std::string contents =
+      "%%MatrixMarket matrix coordinate real general\n1000 1000 200000\n";
+  for (int k = 0; k < 200000; k++) {
+    int i = (k * 7919) % 1000;
+    int j = (k / 1000 * 13 + k) % 1000;
+    contents += std::to_string(i + 1) + " " + std::to_string(j + 1) + " " +
+                std::to_string(k % 100) + ".5e0\n";
+  }
+  auto path = write_temp_file("grb_mmread_large.mtx", contents);
+
+  grb::matrix<double, int> a(path);
+  auto tuples = grb::mmread<double, int>(path);
+  REQUIRE(tuples.size() == 200000);
+
+  grb::matrix<double, int> b({1000, 1000});
+  b.insert(tuples.begin(), tuples.end());
+  REQUIRE(a.size() == b.size());
+  for (auto&& [index, value] : b) {
+    REQUIRE(a.find(index) != a.end());
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("mmread keeps the first of duplicate elements", "[mmread]") {
+  // Every index appears 20 times, in lines split between threads, and
+  // first with the value `i + 1000 * j`.
+  std::string contents =
+      "%%MatrixMarket matrix coordinate integer general\n1000 10 200000\n";
+  for (int k = 0; k < 200000; k++) {
+    int i = k % 1000;
+    int j = (k / 1000) % 10;
+    contents += std::to_string(i + 1) + " " + std::to_string(j + 1) + " " +
+                std::to_string(k) + "\n";
+  }
+  auto path = write_temp_file("grb_mmread_duplicates.mtx", contents);
+
+  grb::matrix<int, int> a(path);
+  REQUIRE(a.size() == 10000);
+  for (auto&& [index, value] : a) {
+    auto&& [i, j] = index;
+    REQUIRE(value == i + 1000 * j);
+  }
+
+  std::remove(path.c_str());
+}
+
+inline std::string read_file(const std::string& path) {
+  std::ifstream f(path);
+  return std::string(std::istreambuf_iterator<char>(f),
+                     std::istreambuf_iterator<char>());
+}
+
+TEMPLATE_TEST_CASE("mmwrite", "[template]", int, float) {
+  using T = TestType;
+
+  auto path = (std::filesystem::temp_directory_path() / "grb_mmwrite.mtx")
+                  .string();
+
+  SECTION("round trip") {
+    // Elements on the diagonal hold explicit zeros.
+    std::vector<grb::matrix_entry<T, int>> elements;
+    for (int i = 0; i < 300; i++) {
+      for (int j = i % 3; j < 200; j += 1 + i % 7) {
+        elements.push_back({{i, j}, T(i - j) / T(2)});
+      }
+    }
+    grb::matrix<T, int> a({300, 200});
+    a.insert(elements.begin(), elements.end());
+
+    auto check_element = [](auto&& m, grb::index<int> index, T value) {
+      auto iter = m.find(index);
+      REQUIRE(iter != m.end());
+      auto&& [_, m_value] = *iter;
+      REQUIRE(m_value == value);
+    };
+
+    grb::mmwrite(path, a);
+    grb::matrix<T, int> b(path);
+    REQUIRE(b.shape() == a.shape());
+    REQUIRE(b.size() == a.size());
+    for (auto&& [index, value] : a) {
+      check_element(b, index, value);
+    }
+
+    // Matrices without CSR storage take the generic path.
+    grb::mmwrite(path, grb::transpose(a));
+    grb::matrix<T, int> t(path);
+    REQUIRE(t.size() == a.size());
+    for (auto&& [index, value] : a) {
+      auto&& [i, j] = index;
+      check_element(t, {j, i}, value);
+    }
+  }
+
+  SECTION("symmetric pattern") {
+    grb::matrix<T, int> a({4, 4});
+    a[{0, 1}] = 1;
+    a[{1, 0}] = 1;
+    a[{2, 2}] = 1;
+    a[{3, 1}] = 1;
+    a[{1, 3}] = 1;
+
+    grb::mmwrite(path, a, {.symmetric = true, .pattern = true});
+    REQUIRE(read_file(path) ==
+            "%%MatrixMarket matrix coordinate pattern symmetric\n"
+            "4 4 3\n"
+            "2 1\n"
+            "3 3\n"
+            "4 2\n");
+
+    grb::matrix<T, int> b(path);
+    REQUIRE(b.size() == a.size());
+  }
+
+  SECTION("vector") {
+    grb::vector<T, int> v(100000);
+    for (int i = 3; i < 100000; i += 5) {
+      v[i] = T(i % 11);
+    }
+    grb::mmwrite(path, v);
+
+    grb::matrix<T, int> m(path);
+    REQUIRE(m.shape() == grb::index<int>{100000, 1});
+    REQUIRE(m.size() == v.size());
+    for (auto&& [index, value] : v) {
+      auto iter = m.find({index, 0});
+      REQUIRE(iter != m.end());
+      auto&& [_, m_value] = *iter;
+      REQUIRE(m_value == value);
+    }
+  }
+
+  SECTION("edge list") {
+    grb::matrix<T, int> a({3, 3});
+    a[{0, 2}] = 5;
+    a[{2, 1}] = 7;
+
+    grb::write_edge_list(path, a);
+    REQUIRE(read_file(path) == "0\t2\t5\n2\t1\t7\n");
+
+    grb::write_edge_list(path, a, {.delimiter = ',', .one_indexed = true,
+                                   .weights = false});
+    REQUIRE(read_file(path) == "1,3\n3,2\n");
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("mmwrite writes blocks in order", "[mmwrite]") {
+  auto path =
+      (std::filesystem::temp_directory_path() / "grb_mmwrite_blocks.txt")
+          .string();
+
+  // More rounds of blocks than buffers, so buffers are reused.
+  for (std::size_t nthreads : {1, 3}) {
+    auto f = grb::__detail::open_for_writing(path);
+    grb::__detail::write_blocks(
+        f, 100, nthreads,
+        [](std::size_t b, grb::__detail::line_buffer& out) {
+          out.append(b);
+          out.put('\n');
+        });
+    f.close();
+
+    std::string expected;
+    for (std::size_t b = 0; b < 100; b++) {
+      expected += std::to_string(b) + "\n";
+    }
+    REQUIRE(read_file(path) == expected);
+  }
+
+  // A failing block stops the write instead of leaving threads waiting.
+  {
+    auto f = grb::__detail::open_for_writing(path);
+    REQUIRE_THROWS_AS(
+        grb::__detail::write_blocks(
+            f, 100, 3,
+            [](std::size_t b, grb::__detail::line_buffer&) {
+              if (b == 40) {
+                throw std::runtime_error("block 40");
+              }
+            }),
+        std::runtime_error);
+  }
+
+  // Matrices of several blocks round trip.
+  grb::matrix<int, int> a({1000, 1000});
+  std::vector<grb::matrix_entry<int, int>> elements;
+  for (int i = 0; i < 1000; i++) {
+    for (int j = i % 3; j < 1000; j += 3) {
+      elements.push_back({{i, j}, i - j});
+    }
+  }
+  a.insert(elements.begin(), elements.end());
+  REQUIRE(a.size() > 2 * grb::__detail::write_block_size);
+
+  grb::mmwrite(path, a);
+  grb::matrix<int, int> b(path);
+  REQUIRE(b.size() == a.size());
+  for (auto&& [index, value] : a) {
+    REQUIRE(b[index] == value);
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("mmwrite writes char values as numbers", "[mmwrite]") {
+  auto path =
+      (std::filesystem::temp_directory_path() / "grb_mmwrite_char.mtx")
+          .string();
+
+  grb::matrix<char, int> a({2, 2});
+  a[{0, 1}] = 65;
+  a[{1, 0}] = 7;
+  grb::mmwrite(path, a);
+  REQUIRE(read_file(path) == "%%MatrixMarket matrix coordinate integer "
+                             "general\n"
+                             "2 2 2\n"
+                             "1 2 65\n"
+                             "2 1 7\n");
+
+  grb::matrix<signed char, int> s({1, 1});
+  s[{0, 0}] = -3;
+  grb::write_edge_list(path, s);
+  REQUIRE(read_file(path) == "0\t0\t-3\n");
+
+  grb::matrix<unsigned char, int> u({1, 1});
+  u[{0, 0}] = 200;
+  grb::write_edge_list(path, u);
+  REQUIRE(read_file(path) == "0\t0\t200\n");
+
+  std::remove(path.c_str());
+}
+
+TEMPLATE_TEST_CASE("read_edge_list", "[template]", int, float) {
+  using T = TestType;
+
+  SECTION("plain ids") {
+    auto path = write_temp_file("grb_edge_list.tsv", "# comment\n"
+                                                     "0\t1\t2\n"
+                                                     "3 2 4\n"
+                                                     "\n"
+                                                     "1,0,5\r\n"
+                                                     "2\t2\n");
+    auto a = grb::read_edge_list<T, int>(path);
+    REQUIRE(a.shape() == grb::index<int>{4, 4});
+    REQUIRE(a.size() == 4);
+    REQUIRE(a[{0, 1}] == T(2));
+    REQUIRE(a[{3, 2}] == T(4));
+    REQUIRE(a[{1, 0}] == T(5));
+    REQUIRE(a[{2, 2}] == T(1));
+
+    auto s = grb::read_edge_list<T, int>(
+        path, {.weights = false, .symmetrize = true});
+    REQUIRE(s.size() == 5);
+    REQUIRE(s[{2, 3}] == T(1));
+    REQUIRE(s[{0, 1}] == T(1));
+
+    std::remove(path.c_str());
+  }
+
+  SECTION("compacted ids") {
+    auto path = write_temp_file("grb_edge_list.csv",
+                                "9000000000000,17,1\n"
+                                "17,42,2\n"
+                                "42,9000000000000,3\n"
+                                "17,42,2\n");
+    auto [a, ids] = grb::read_edge_list_compact<T, std::int32_t>(
+        path, {.delimiter = ','});
+    REQUIRE(ids == std::vector<std::uint64_t>{17, 42, 9000000000000});
+    REQUIRE(a.shape() == grb::index<std::int32_t>{3, 3});
+    REQUIRE(a.size() == 3);
+    REQUIRE(a[{2, 0}] == T(1));
+    REQUIRE(a[{0, 1}] == T(2));
+    REQUIRE(a[{1, 2}] == T(3));
+
+    REQUIRE_THROWS_AS((grb::read_edge_list<T, std::int32_t>(path)),
+                      std::runtime_error);
+
+    std::remove(path.c_str());
+  }
+
+  SECTION("id table grows") {
+    grb::__detail::id_table table(1);
+    std::size_t grown = 0;
+    for (std::uint64_t k = 1000; k > 0; k--) {
+      while (!table.insert(k * 1000003)) {
+        table.grow();
+        grown++;
+      }
+      REQUIRE(table.insert(k * 1000003));
+    }
+    REQUIRE(grown > 0);
+
+    auto ids = table.number();
+    REQUIRE(ids.size() == 1000);
+    for (std::uint64_t k = 0; k < 1000; k++) {
+      REQUIRE(ids[k] == (k + 1) * 1000003);
+      REQUIRE(table.find(ids[k]) == k);
+    }
+  }
+
+  SECTION("many edges") {
+    std::string contents;
+    for (std::uint64_t k = 0; k < 100000; k++) {
+      std::uint64_t i = (k * 2654435761ULL) % 5000 * 1000003;
+      std::uint64_t j = (k * 40503ULL) % 5000 * 1000003;
+      contents += std::to_string(i) + " " + std::to_string(j) + "\n";
+    }
+    auto path = write_temp_file("grb_edge_list_many.txt", contents);
+
+    auto [a, ids] = grb::read_edge_list_compact<T, int>(
+        path, {.weights = false, .symmetrize = true});
+    REQUIRE(std::is_sorted(ids.begin(), ids.end()));
+    REQUIRE(ids.size() == std::size_t(a.shape()[0]));
+    for (auto&& [index, value] : a) {
+      auto&& [i, j] = index;
+      REQUIRE(a[{j, i}] == value);
+      REQUIRE(ids[i] % 1000003 == 0);
+    }
+
+    std::remove(path.c_str());
+  }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+
+TEST_CASE("CSR rows are spans of the matrix's elements", "[matrix]") {
+  auto a = grb::generate_random<float, int>({50, 40}, 0.1, 9);
+
+  std::size_t count = 0;
+  int expected_row = 0;
+  for (auto&& row : std::as_const(a).rows()) {
+    REQUIRE(row.index == expected_row++);
+    REQUIRE(std::is_sorted(row.columns.begin(), row.columns.end()));
+    for (std::size_t k = 0; k < row.size(); k++) {
+      REQUIRE(a[{row.index, row.columns[k]}] == row.values[k]);
+    }
+    count += row.size();
+  }
+  REQUIRE(expected_row == 50);
+  REQUIRE(count == a.size());
+
+  // Values are written through the spans.
+  auto row = a.row(7);
+  for (auto&& value : row.values) {
+    value = -1;
+  }
+  for (auto&& [index, value] : a) {
+    if (index[0] == 7) {
+      REQUIRE(value == -1);
+    }
+  }
+}
+
+TEST_CASE("partition splits rows by elements", "[matrix]") {
+  grb::matrix<int, int> a({100, 100});
+  // Row 0 holds half the elements.
+  for (int j = 0; j < 100; j++) {
+    a[{0, j}] = j;
+  }
+  for (int i = 1; i < 100; i++) {
+    a[{i, i}] = i;
+    a[{i, (i * 7) % 100}] = i;
+  }
+
+  for (std::size_t n : {1, 2, 3, 8, 200}) {
+    auto parts = a.partition(n);
+    REQUIRE(parts.size() == n);
+    REQUIRE(parts.front()[0] == 0);
+    REQUIRE(parts.back()[1] == 100);
+
+    std::size_t total = 0;
+    for (std::size_t p = 0; p < n; p++) {
+      auto [first, last] = parts[p];
+      REQUIRE(first <= last);
+      if (p > 0) {
+        REQUIRE(first == parts[p - 1][1]);
+      }
+
+      std::size_t elements = 0;
+      for (auto&& row : a.rows(first, last)) {
+        elements += row.size();
+      }
+      // No part is much more than its share, but for single large rows.
+      REQUIRE((elements <= a.size() / n + 100 || last - first == 1));
+      total += elements;
+    }
+    REQUIRE(total == a.size());
+  }
+
+  // Row reduction goes through the rows of CSR matrices.
+  auto sums = grb::reduce(a);
+  REQUIRE(sums.size() == 100);
+  REQUIRE(sums[0] == 4950);
+  REQUIRE(sums[3] == (3 * 7 % 100 == 3 ? 3 : 6));
+
+  grb::matrix<int, int, grb::coordinate> a_coo({100, 100});
+  a_coo.insert(a.begin(), a.end());
+  auto coo_sums = grb::reduce(a_coo);
+  for (auto&& [i, value] : sums) {
+    REQUIRE(coo_sums[i] == value);
+  }
+}
+
+TEST_CASE("raw_arrays exposes CSR storage", "[matrix]") {
+  auto a = grb::generate_random<float, int>({60, 45}, 0.1, 10);
+  grb::matrix<float, int, grb::coordinate> a_coo({60, 45});
+  a_coo.insert(a.begin(), a.end());
+
+  auto [shape, rowptr, colind, values] = grb::raw_arrays(std::as_const(a));
+  static_assert(std::is_same_v<decltype(values), std::span<const float>>);
+  REQUIRE(shape == a.shape());
+  REQUIRE(rowptr.size() == 61);
+  REQUIRE(colind.size() == a.size());
+
+  auto iter = a.begin();
+  for (std::size_t i = 0; i < 60; i++) {
+    for (auto k = rowptr[i]; k < rowptr[i + 1]; k++, ++iter) {
+      auto&& [index, value] = *iter;
+      REQUIRE(index == grb::index<int>(i, colind[k]));
+      REQUIRE(value == values[k]);
+    }
+  }
+
+  // `views::stored_values` is the value array itself for CSR matrices.
+  auto csr_values = grb::views::stored_values(a);
+  static_assert(std::is_same_v<decltype(csr_values), std::span<float>>);
+  auto coo_values = grb::views::stored_values(a_coo);
+  std::vector<float> sorted_csr(csr_values.begin(), csr_values.end());
+  std::vector<float> sorted_coo(coo_values.begin(), coo_values.end());
+  std::sort(sorted_csr.begin(), sorted_csr.end());
+  std::sort(sorted_coo.begin(), sorted_coo.end());
+  REQUIRE(sorted_csr == sorted_coo);
+
+  // `views::values` stays a range adaptor closure.
+  auto first_values = grb::views::values | std::views::take(3);
+  auto csr_first = a | first_values;
+  auto coo_first = a_coo | first_values;
+  REQUIRE(std::ranges::equal(csr_first, std::span(csr_values).first(3)));
+  REQUIRE(std::ranges::distance(coo_first) == 3);
+
+  // Algorithms reading the arrays match those iterating elements.
+  auto x = grb::generate_random<float, int>(45, 0.3, 11);
+  auto check_equal = [](auto&& y, auto&& y_coo) {
+    REQUIRE(y.size() == y_coo.size());
+    for (auto&& [i, value] : y_coo) {
+      REQUIRE(y.find(i) != y.end());
+      REQUIRE(float(y[i]) == float(value));
+    }
+  };
+
+  check_equal(grb::multiply(a, x), grb::multiply(a_coo, x));
+  check_equal(grb::multiply(a, x, grb::logical_or(), grb::logical_and()),
+              grb::multiply(a_coo, x, grb::logical_or(), grb::logical_and()));
+  auto max = [](float x, float y) { return std::max(x, y); };
+  check_equal(grb::multiply(a, x, max),
+              grb::multiply(a_coo, x, max));
+  check_equal(grb::reduce(a, grb::max()), grb::reduce(a_coo, grb::max()));
+}
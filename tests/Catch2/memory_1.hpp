@@ -0,0 +1,223 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+#include <map>
+
+namespace {
+
+template <typename A, typename B, typename Reduce, typename Combine>
+std::map<std::pair<int, int>, float>
+reference_mxm(const A& a, const B& b, Reduce reduce, Combine combine) {
+  std::map<std::pair<int, int>, float> c;
+  for (auto&& [index, a_value] : a) {
+    auto [i, k] = index;
+    for (auto&& [b_index, b_value] : b) {
+      auto [k_b, j] = b_index;
+      if (k_b == k) {
+        auto product = combine(float(a_value), float(b_value));
+        auto [iter, inserted] = c.try_emplace({i, j}, product);
+        if (!inserted) {
+          iter->second = reduce(iter->second, product);
+        }
+      }
+    }
+  }
+  return c;
+}
+
+template <typename C>
+void check_mxm(const C& c,
+               const std::map<std::pair<int, int>, float>& reference) {
+  REQUIRE(std::size_t(c.size()) == reference.size());
+  for (auto&& [index, value] : c) {
+    auto [i, j] = index;
+    auto iter = reference.find({i, j});
+    REQUIRE(iter != reference.end());
+    REQUIRE(float(value) == iter->second);
+  }
+}
+
+} // namespace
+
+TEST_CASE("grb::allocator counts live bytes", "[memory]") {
+  std::size_t before = grb::live_bytes();
+  {
+    grb::vector<float, int> v(1000);
+    for (int i = 0; i < 1000; i++) {
+      v[i] = i;
+    }
+    REQUIRE(grb::live_bytes() >= before + 1000 * sizeof(float));
+  }
+  REQUIRE(grb::live_bytes() == before);
+}
+
+TEST_CASE("live_bytes returns to its start after reassignment", "[memory]") {
+  std::size_t before = grb::live_bytes();
+  {
+    auto a = grb::generate_random<float, int>({50, 40}, 0.1, 7);
+    auto b = grb::generate_random<float, int>({40, 30}, 0.1, 8);
+
+    grb::matrix<float, int> c({50, 30});
+    c = grb::multiply(a, b);
+    std::size_t after_first = grb::live_bytes();
+    for (int k = 0; k < 10; k++) {
+      c = grb::multiply(a, b);
+    }
+    REQUIRE(grb::live_bytes() == after_first);
+
+    c = a;
+    c = std::move(a);
+    grb::vector<float, int> v(100);
+    v = grb::vector<float, int>(200);
+  }
+  REQUIRE(grb::live_bytes() == before);
+}
+
+TEST_CASE("mxm matches a reference product", "[memory][multiply]") {
+  auto a = grb::generate_random<float, int>({40, 30}, 0.1, 1);
+  auto b = grb::generate_random<float, int>({30, 50}, 0.1, 2);
+
+  SECTION("CSR operands") {
+    auto c = grb::multiply(a, b);
+    check_mxm(c, reference_mxm(a, b, grb::plus(), grb::multiplies()));
+  }
+
+  SECTION("COO operands") {
+    grb::matrix<float, int, grb::coordinate> a_coo(a.shape());
+    a_coo.insert(a.begin(), a.end());
+    auto c = grb::multiply(a_coo, b);
+    check_mxm(c, reference_mxm(a, b, grb::plus(), grb::multiplies()));
+  }
+
+  SECTION("min-plus semiring") {
+    auto c = grb::multiply(a, b, grb::min(), grb::plus());
+    check_mxm(c, reference_mxm(a, b, grb::min(), grb::plus()));
+  }
+
+  SECTION("masked") {
+    grb::matrix<bool, int> mask({40, 50});
+    for (int i = 0; i < 40; i++) {
+      for (int j = i % 3; j < 50; j += 3) {
+        mask[{i, j}] = true;
+      }
+    }
+    auto c = grb::multiply(a, b, grb::plus(), grb::multiplies(), mask);
+    auto reference = reference_mxm(a, b, grb::plus(), grb::multiplies());
+    std::erase_if(reference, [](auto&& element) {
+      auto [i, j] = element.first;
+      return j % 3 != i % 3;
+    });
+    check_mxm(c, reference);
+  }
+}
+
+TEST_CASE("mxm plans within the memory budget", "[memory][multiply]") {
+  // Many products collapse onto the first 64 of 4000 columns, so the
+  // result is small but a dense accumulator is not.
+  auto a = grb::generate_random<float, int>({20, 200}, 0.5, 3);
+  grb::matrix<float, int> b({200, 4000});
+  for (int k = 0; k < 200; k++) {
+    for (int j = k % 8; j < 64; j += 8) {
+      b[{k, j}] = k + j;
+    }
+  }
+  auto reference = reference_mxm(a, b, grb::plus(), grb::multiplies());
+
+  // Not even the row pointers of the result fit.
+  grb::set_memory_budget(grb::live_bytes() + 16);
+  REQUIRE_THROWS_AS(grb::multiply(a, b), grb::out_of_memory);
+  try {
+    grb::multiply(a, b);
+  } catch (const grb::out_of_memory& e) {
+    REQUIRE(e.required() > e.available());
+  }
+
+  grb::set_memory_budget(grb::live_bytes() + 32 * 1024);
+  auto plan = grb::__detail::plan_spgemm<float>(
+      grb::__detail::storage_of(a), grb::__detail::storage_of(b));
+  auto c = grb::multiply(a, b);
+  grb::set_memory_budget(grb::unlimited_memory);
+
+  REQUIRE(plan.strategy == grb::__detail::spgemm_strategy::sort_accumulator);
+  check_mxm(c, reference);
+  REQUIRE(grb::memory_budget() == grb::unlimited_memory);
+}
+
+TEST_CASE("mxm batches rows when output and scratch do not fit together",
+          "[memory][multiply]") {
+  auto a = grb::generate_random<float, int>({20, 200}, 0.5, 3);
+  grb::matrix<float, int> b({200, 4000});
+  for (int k = 0; k < 200; k++) {
+    for (int j = k % 8; j < 64; j += 8) {
+      b[{k, j}] = k + j;
+    }
+  }
+  auto reference = reference_mxm(a, b, grb::plus(), grb::multiplies());
+  auto&& a_csr = grb::__detail::storage_of(a);
+  auto&& b_csr = grb::__detail::storage_of(b);
+
+  // Leave room for the row pointers of the result and one dense
+  // accumulator, but not for the result beside it.
+  auto dense = grb::__detail::spgemm_strategy::dense_accumulator;
+  std::size_t dense_bytes = grb::__detail::spgemm_thread_bytes<float, int>(
+      dense, 4000, grb::__detail::plan_spgemm<float>(a_csr, b_csr)
+                       .max_row_products);
+  grb::set_memory_budget(grb::live_bytes() + 21 * sizeof(int) + dense_bytes);
+  auto plan = grb::__detail::plan_spgemm<float>(a_csr, b_csr);
+  REQUIRE(plan.strategy == dense);
+
+  grb::matrix<float, int> c({20, 4000});
+  grb::__detail::spgemm_csr(a_csr, b_csr, grb::__detail::storage_of(c),
+                            grb::plus(), grb::multiplies(),
+                            grb::full_matrix_mask(), plan);
+  REQUIRE(plan.strategy == grb::__detail::spgemm_strategy::sort_accumulator);
+  auto d = grb::multiply(a, b);
+  grb::set_memory_budget(grb::unlimited_memory);
+
+  check_mxm(c, reference);
+  check_mxm(d, reference);
+}
+
+TEST_CASE("panelled mxm matches mxm", "[memory][multiply]") {
+  auto a = grb::generate_random<float, int>({60, 40}, 0.1, 5);
+  auto b = grb::generate_random<float, int>({40, 50}, 0.1, 6);
+  grb::matrix<bool, int> mask({60, 50});
+  for (int i = 0; i < 60; i++) {
+    for (int j = i % 2; j < 50; j += 2) {
+      mask[{i, j}] = true;
+    }
+  }
+
+  auto check_panels = [&](auto reduce, auto combine, auto&& mask) {
+    auto c = grb::multiply(a, b, reduce, combine, mask);
+
+    std::size_t next_row = 0;
+    std::size_t npanels = 0;
+    std::map<std::pair<int, int>, float> elements;
+    grb::multiply(
+        grb::row_panels{256}, a, b,
+        [&](std::size_t first_row, grb::matrix<float, int>& panel) {
+          REQUIRE(first_row == next_row);
+          REQUIRE(panel.shape()[1] == 50);
+          std::size_t bytes = (panel.shape()[0] + 1) * sizeof(int) +
+                              panel.size() * (sizeof(int) + sizeof(float));
+          REQUIRE((bytes <= 256 || panel.shape()[0] == 1));
+          for (auto&& [index, value] : panel) {
+            auto [i, j] = index;
+            elements[{int(first_row) + i, j}] = value;
+          }
+          next_row += panel.shape()[0];
+          npanels++;
+        },
+        reduce, combine, mask);
+
+    REQUIRE(next_row == 60);
+    REQUIRE(npanels > 1);
+    check_mxm(c, elements);
+  };
+
+  check_panels(grb::plus(), grb::multiplies(), grb::full_matrix_mask());
+  check_panels(grb::min(), grb::plus(), grb::full_matrix_mask());
+  check_panels(grb::plus(), grb::multiplies(), mask);
+}
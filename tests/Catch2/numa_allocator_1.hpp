@@ -0,0 +1,54 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+
+TEST_CASE("numa_allocator allocates with both policies", "[numa]") {
+  REQUIRE(grb::numa_allocator<float>::num_nodes() >= 1);
+
+  for (auto policy :
+       {grb::numa_policy::first_touch, grb::numa_policy::interleave}) {
+    grb::numa_allocator<double> allocator(policy);
+    REQUIRE(allocator.policy() == policy);
+
+    // Large enough to be mapped and placed, and small.
+    for (std::size_t n : {std::size_t(1) << 18, std::size_t(10)}) {
+      double* p = allocator.allocate(n);
+      REQUIRE(reinterpret_cast<std::uintptr_t>(p) % alignof(double) == 0);
+      for (std::size_t i = 0; i < n; i++) {
+        p[i] = double(i);
+      }
+      REQUIRE(p[n - 1] == double(n - 1));
+      allocator.deallocate(p, n);
+    }
+  }
+
+  grb::numa_allocator<int> ints(grb::numa_policy::interleave);
+  grb::numa_allocator<double> doubles(ints);
+  REQUIRE(doubles.policy() == grb::numa_policy::interleave);
+  REQUIRE(ints == doubles);
+}
+
+TEST_CASE("containers store elements with numa_allocator", "[numa]") {
+  using allocator = grb::numa_allocator<float>;
+
+  auto a = grb::generate_random<float, int>({1000, 800}, 0.5, 5);
+  grb::matrix<float, int, grb::sparse, allocator> b(a.shape());
+  b.insert(a.begin(), a.end());
+  REQUIRE(b.size() == a.size());
+
+  grb::vector<float, int, grb::dense, allocator> x(
+      800, allocator(grb::numa_policy::interleave));
+  grb::vector<float, int> y(800);
+  for (int j = 0; j < 800; j++) {
+    x[j] = j % 7;
+    y[j] = j % 7;
+  }
+
+  auto expected = grb::multiply(a, y);
+  auto result = grb::multiply(b, x);
+  REQUIRE(result.size() == expected.size());
+  for (auto&& [i, value] : expected) {
+    REQUIRE(result[i] == value);
+  }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+#include <numeric>
+#include <random>
+
+TEMPLATE_TEST_CASE("permute", "[template]", int, float) {
+  using T = TestType;
+
+  grb::matrix<T, int> a("chesapeake/chesapeake.mtx");
+
+  grb::matrix<T, int, grb::coordinate> c(a.shape());
+  for (auto&& [index, value] : a) {
+    c.insert({index, value});
+  }
+
+  std::vector<int> p(a.shape()[0]);
+  std::iota(p.begin(), p.end(), 0);
+  std::shuffle(p.begin(), p.end(), std::mt19937(12));
+
+  auto check_permuted = [&](auto&& o, auto&& rows, auto&& columns) {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < rows.size(); i++) {
+      for (std::size_t j = 0; j < columns.size(); j++) {
+        auto iter = a.find({rows[i], columns[j]});
+        auto o_iter = o.find({int(i), int(j)});
+        REQUIRE((iter == a.end()) == (o_iter == o.end()));
+        if (iter != a.end()) {
+          REQUIRE(grb::get<1>(*iter) == grb::get<1>(*o_iter));
+          size++;
+        }
+      }
+    }
+    REQUIRE(o.size() == size);
+
+    // Column indices are sorted within each row.
+    int prev_i = -1;
+    int prev_j = -1;
+    for (auto&& [index, _] : o) {
+      auto&& [i, j] = index;
+      REQUIRE((i > prev_i || (i == prev_i && j > prev_j)));
+      prev_i = i;
+      prev_j = j;
+    }
+  };
+
+  check_permuted(grb::permute(a, p), p, p);
+  check_permuted(grb::permute(c, p), p, p);
+
+  // Repeated and dropped rows and columns.
+  std::vector<int> rows = {3, 3, 0, 38, 5};
+  std::vector<int> columns = {1, 2, 1, 20};
+  check_permuted(grb::permute(a, rows, columns), rows, columns);
+  check_permuted(grb::permute(a, rows, p), rows, p);
+
+  std::vector<int> bad = {0, 1, a.shape()[0]};
+  REQUIRE_THROWS_AS(grb::permute(a, bad), grb::invalid_argument);
+}
+
+TEST_CASE("reorder", "[reorder]") {
+  // A path graph with shuffled vertex ids.
+  int n = 200;
+  std::vector<int> ids(n);
+  std::iota(ids.begin(), ids.end(), 0);
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(3));
+
+  grb::matrix<int, int> a({n, n});
+  for (int v = 0; v + 1 < n; v++) {
+    a[{ids[v], ids[v + 1]}] = 1;
+    a[{ids[v + 1], ids[v]}] = 1;
+  }
+
+  auto bandwidth = [](auto&& m) {
+    int width = 0;
+    for (auto&& [index, _] : m) {
+      auto&& [i, j] = index;
+      width = std::max(width, std::abs(i - j));
+    }
+    return width;
+  };
+
+  auto check_ordering = [&](auto method) {
+    auto [b, p] = grb::reorder(a, method);
+
+    std::vector<int> sorted(p.begin(), p.end());
+    std::sort(sorted.begin(), sorted.end());
+    for (int v = 0; v < n; v++) {
+      REQUIRE(sorted[v] == v);
+    }
+
+    REQUIRE(b.size() == a.size());
+    for (auto&& [index, value] : b) {
+      auto&& [i, j] = index;
+      REQUIRE(a.find({p[i], p[j]}) != a.end());
+    }
+    return b;
+  };
+
+  // Number of edges between vertices at most 5 positions apart.
+  auto local_edges = [](auto&& m) {
+    int count = 0;
+    for (auto&& [index, _] : m) {
+      auto&& [i, j] = index;
+      count += std::abs(i - j) <= 5;
+    }
+    return count;
+  };
+
+  REQUIRE(bandwidth(check_ordering(grb::reverse_cuthill_mckee{})) == 1);
+  check_ordering(grb::degree_order{});
+  REQUIRE(local_edges(check_ordering(grb::gorder{})) > 2 * local_edges(a));
+
+  grb::matrix<int, int> rectangular({3, 4});
+  REQUIRE_THROWS_AS(grb::reorder_permutation(rectangular),
+                    grb::invalid_argument);
+}
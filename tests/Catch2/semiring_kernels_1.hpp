@@ -0,0 +1,81 @@
+#pragma once
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+
+template <typename V1, typename V2>
+void check_vectors_equal(V1&& a, V2&& b) {
+  REQUIRE(a.shape() == b.shape());
+  REQUIRE(a.size() == b.size());
+  for (auto&& [i, v] : a) {
+    auto iter = b.find(i);
+    REQUIRE(iter != b.end());
+    auto&& [_, b_v] = *iter;
+    REQUIRE(v == b_v);
+  }
+}
+
+TEMPLATE_TEST_CASE("semiring kernels match generic multiply", "[template]",
+                   int, float) {
+  using T = TestType;
+
+  static_assert(grb::has_semiring_kernel_v<grb::plus<>, grb::times<>, T>);
+  static_assert(grb::has_semiring_kernel_v<grb::min<>, grb::plus<>, T>);
+  static_assert(
+      grb::has_semiring_kernel_v<grb::logical_or<>, grb::logical_and<>, bool>);
+  static_assert(grb::has_semiring_kernel_v<grb::take_left<>, grb::pair<>, T>);
+  static_assert(!grb::has_semiring_kernel_v<grb::minus<>, grb::times<>, T>);
+
+  grb::matrix<T, int> a("chesapeake/chesapeake.mtx");
+
+  grb::vector<T, int> b(a.shape()[1]);
+  for (int i = 0; i < a.shape()[1]; i += 3) {
+    b[i] = T(i % 5);
+  }
+
+  grb::vector<bool, int> mask(a.shape()[0]);
+  for (int i = 0; i < a.shape()[0]; i += 2) {
+    mask[i] = true;
+  }
+
+  // Lambdas are not recognized, so they take the generic path.
+  auto plus = [](auto x, auto y) { return x + y; };
+  auto min = [](auto x, auto y) { return grb::min{}(x, y); };
+  auto lor = [](auto x, auto y) { return x || y; };
+  auto take_left = [](auto x, auto) { return x; };
+
+  check_vectors_equal(grb::multiply(a, b, grb::plus{}, grb::times{}),
+                      grb::multiply(a, b, plus, grb::times{}));
+
+  check_vectors_equal(grb::multiply(a, b, grb::min{}, grb::plus{}, mask),
+                      grb::multiply(a, b, min, grb::plus{}, mask));
+
+  check_vectors_equal(
+      grb::multiply(a, b, grb::logical_or{}, grb::logical_and{}),
+      grb::multiply(a, b, lor, grb::logical_and{}));
+
+  check_vectors_equal(grb::multiply(a, b, grb::take_left{}, grb::pair{},
+                                    grb::complement_view(mask)),
+                      grb::multiply(a, b, take_left, grb::pair{},
+                                    grb::complement_view(mask)));
+
+  // Kernels skip the rows the mask does not allow, whether `a` is read by
+  // row or element by element.
+  grb::matrix<T, int, grb::coordinate> a_coo(a.shape());
+  a_coo.insert(a.begin(), a.end());
+
+  check_vectors_equal(grb::multiply(a, b, grb::plus{}, grb::times{},
+                                    grb::complement_view(mask)),
+                      grb::multiply(a, b, plus, grb::times{},
+                                    grb::complement_view(mask)));
+
+  check_vectors_equal(grb::multiply(a_coo, b, grb::plus{}, grb::times{},
+                                    grb::complement_view(mask)),
+                      grb::multiply(a, b, plus, grb::times{},
+                                    grb::complement_view(mask)));
+
+  check_vectors_equal(
+      grb::multiply(a_coo, b, grb::logical_or{}, grb::logical_and{}, mask),
+      grb::multiply(a, b, lor, grb::logical_and{}, mask));
+}
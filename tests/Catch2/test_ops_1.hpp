@@ -103,3 +103,89 @@ TEMPLATE_TEST_CASE("basic operator test modulus 1", "[template]", int, size_t) {
   test_op<false>(num_values, T(1), grb::modulus<T, T>(), std::modulus<T>());
   test_op<false>(num_values, T(1), grb::modulus<T, T, T>(), std::modulus<T>());
 }
+
+TEMPLATE_TEST_CASE("monoid algebraic traits 1", "[template]", int, size_t,
+                   float, double) {
+  using T = TestType;
+
+  static_assert(grb::is_commutative_v<grb::plus<>>);
+  static_assert(grb::is_commutative_v<grb::times<T>>);
+  static_assert(!grb::is_commutative_v<grb::minus<>>);
+  static_assert(!grb::is_commutative_v<grb::take_left<>>);
+
+  static_assert(grb::is_idempotent_v<grb::min<>>);
+  static_assert(grb::is_idempotent_v<grb::max<T>>);
+  static_assert(grb::is_idempotent_v<grb::logical_or<>>);
+  static_assert(!grb::is_idempotent_v<grb::plus<>>);
+
+  static_assert(grb::is_any_op_v<grb::take_left<>>);
+  static_assert(!grb::is_any_op_v<grb::take_right<T>>);
+  static_assert(!grb::is_any_op_v<grb::max<>>);
+
+  static_assert(grb::monoid_traits<grb::min<>, T>::terminal() ==
+                std::numeric_limits<T>::lowest() ||
+                grb::monoid_traits<grb::min<>, T>::terminal() ==
+                    -std::numeric_limits<T>::infinity());
+  static_assert(grb::has_terminal_v<grb::logical_or<>, bool>);
+  static_assert(grb::monoid_traits<grb::logical_or<>, bool>::terminal());
+  static_assert(!grb::has_terminal_v<grb::plus<>, T>);
+  static_assert(grb::has_terminal_v<grb::times<>, T> ==
+                std::is_integral_v<T>);
+
+  grb::vector<T> a(100);
+  grb::vector<T> b(100);
+  for (std::size_t i = 0; i < 100; i++) {
+    a[i] = T(i);
+    b[i] = T(1);
+  }
+
+  // Place min's terminal in the middle of `a`, so that reductions stop
+  // there, and must still agree with the full reduction.
+  T terminal = grb::monoid_traits<grb::min<>, T>::terminal();
+  a[50] = terminal;
+
+  auto min_v = grb::multiply(a, b, grb::min{}, grb::times{});
+  REQUIRE(min_v == terminal);
+
+  auto max_v = grb::multiply(a, b, grb::max{}, grb::times{});
+  REQUIRE(max_v == T(99));
+
+  // Row 0 reaches the terminal, row 1 does not.
+  auto check_rows = [&](auto&& m) {
+    for (std::size_t j = 0; j < 100; j++) {
+      m.insert({{0, j}, j == 50 ? terminal : T(j + 1)});
+      m.insert({{1, j}, T(j + 1)});
+    }
+
+    auto c = grb::multiply(m, b, grb::min{}, grb::times{});
+    REQUIRE(c.size() == 2);
+    REQUIRE(c[0] == terminal);
+    REQUIRE(c[1] == T(1));
+  };
+  check_rows(grb::matrix<T>({2, 100}));
+  check_rows(grb::matrix<T, std::size_t, grb::coordinate>({2, 100}));
+}
+
+TEST_CASE("take_right reductions keep the last value", "[semiring]") {
+  grb::matrix<int, int, grb::coordinate> a({1, 4});
+  grb::vector<int, int> b(4);
+  for (int j = 0; j < 4; j++) {
+    a.insert({{0, j}, j + 1});
+    b[j] = 1;
+  }
+
+  int last = 0;
+  for (auto&& [index, value] : a) {
+    last = value;
+  }
+
+  auto c = grb::multiply(a, b, grb::take_right{}, grb::times{});
+  REQUIRE(c.size() == 1);
+  REQUIRE(c[0] == last);
+
+  grb::matrix<int, int> a_csr(a.shape());
+  a_csr.insert(a.begin(), a.end());
+  c = grb::multiply(a_csr, b, grb::take_right{}, grb::times{});
+  REQUIRE(c.size() == 1);
+  REQUIRE(c[0] == 4);
+}
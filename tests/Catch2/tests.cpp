@@ -6,6 +6,24 @@
 #include "matrix_methods_1.hpp"
 #include "matrix_methods_2.hpp"
 #include "matrix_methods_3.hpp"
+#include "matrix_rows_1.hpp"
+#include "matrix_build_1.hpp"
 // #include "algorithms_1.hpp"
 
+#include "binary_io_1.hpp"
+#ifdef BINSPARSE_IO
+#include "binsparse_1.hpp"
+#endif
+#include "csr_matrix_view_1.hpp"
+#include "generate_1.hpp"
+#include "huge_page_allocator_1.hpp"
+#include "masks_1.hpp"
+#include "memory_1.hpp"
+#include "matrix_io_1.hpp"
+#include "numa_allocator_1.hpp"
+#include "permute_1.hpp"
+#include "semiring_kernels_1.hpp"
 #include "test_ops_1.hpp"
+#include "trace_1.hpp"
+#include "transpose_1.hpp"
+#include "workspace_1.hpp"
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+#include <grb/util/trace.hpp>
+
+TEST_CASE("trace_scope records algorithm calls", "[trace]") {
+  grb::matrix<float, int> a({4, 3});
+  a[{0, 0}] = 1;
+  a[{1, 0}] = 2;
+  a[{2, 2}] = 3;
+
+  grb::vector<float, int> x(3);
+  x[0] = 1;
+  x[1] = 1;
+
+  grb::clear_trace();
+
+  {
+    grb::detail::trace_scope<true> scope("multiply", a, x);
+    scope.mask(grb::complement_view(x));
+    scope.kernel("dense_semiring");
+    scope.flops([&] { return grb::detail::multiply_flops(a, x); });
+    scope.output(x);
+  }
+
+  {
+    grb::detail::trace_scope<true> scope("reduce", a);
+    scope.flops(3);
+  }
+
+  auto events = grb::trace_events();
+  REQUIRE(events.size() == 2);
+
+  auto&& multiply = events[0];
+  REQUIRE(multiply.name == "multiply");
+  REQUIRE(multiply.kernel == "dense_semiring");
+  REQUIRE(multiply.mask == "complement");
+  REQUIRE(multiply.flops == 4);
+  REQUIRE(multiply.bytes > 0);
+  REQUIRE(multiply.duration_us >= 0);
+  REQUIRE(multiply.operands.size() == 2);
+  REQUIRE(multiply.operands[0].shape == std::vector<std::size_t>{4, 3});
+  REQUIRE(multiply.operands[0].nnz == 3);
+  REQUIRE(multiply.operands[0].backend == "csr");
+  REQUIRE(multiply.operands[1].shape == std::vector<std::size_t>{3});
+  REQUIRE(multiply.operands[1].backend == "bitmap");
+
+  REQUIRE(events[1].kernel == "generic");
+  REQUIRE(events[1].mask == "none");
+  REQUIRE(events[1].flops == 3);
+
+  auto trace = grb::chrome_trace();
+  REQUIRE(trace["traceEvents"].size() == 2);
+  REQUIRE(trace["traceEvents"][0]["ph"] == "X");
+  REQUIRE(trace["traceEvents"][0]["args"]["kernel"] == "dense_semiring");
+  REQUIRE(trace["traceEvents"][1]["args"]["flops"] == 3);
+
+  auto report = grb::trace_report();
+  REQUIRE(report.find("multiply") != std::string::npos);
+  REQUIRE(report.find("reduce") != std::string::npos);
+
+  grb::clear_trace();
+  REQUIRE(grb::trace_events().empty());
+}
+
+TEST_CASE("trace_scope is empty when tracing is disabled", "[trace]") {
+  REQUIRE(std::is_empty_v<grb::detail::trace_scope<false>>);
+}
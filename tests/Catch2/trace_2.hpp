@@ -0,0 +1,134 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+#include <grb/util/trace.hpp>
+
+// Compiled with `GRB_ENABLE_TRACING`, so that the algorithms record events.
+TEST_CASE("algorithms record trace events", "[trace]") {
+  REQUIRE(grb::tracing_enabled);
+
+  grb::matrix<float, int> a({4, 3});
+  a[{0, 0}] = 1;
+  a[{1, 0}] = 2;
+  a[{2, 2}] = 3;
+  a[{3, 1}] = 4;
+
+  grb::matrix<float, int, grb::coordinate> a_coo(a.shape());
+  a_coo.insert(a.begin(), a.end());
+
+  grb::vector<float, int> x(3);
+  x[0] = 1;
+  x[1] = 1;
+
+  grb::vector<float, int> y(3);
+  y[1] = 2;
+  y[2] = 2;
+
+  grb::clear_trace();
+
+  auto last_event = [] {
+    auto events = grb::trace_events();
+    REQUIRE(!events.empty());
+    return events.back();
+  };
+
+  SECTION("multiply") {
+    // Column 0 of `a` meets x[0] twice and column 1 meets x[1] once.
+    grb::multiply(a, x);
+    auto event = last_event();
+    REQUIRE(event.name == "multiply");
+    REQUIRE(event.kernel == "dense_semiring");
+    REQUIRE(event.mask == "none");
+    REQUIRE(event.flops == 6);
+    REQUIRE(event.operands.size() == 2);
+    REQUIRE(event.operands[0].backend == "csr");
+    REQUIRE(event.operands[0].nnz == 4);
+    REQUIRE(event.bytes > 0);
+
+    grb::vector<bool, int> b(3);
+    b[0] = true;
+    grb::multiply(a, b, grb::logical_or<bool>(), grb::logical_and<bool>());
+    REQUIRE(last_event().kernel == "bitmap_semiring");
+
+    grb::multiply(a, x, grb::plus(), [](float l, float r) { return l - r; },
+                  grb::complement_view(x));
+    event = last_event();
+    REQUIRE(event.kernel == "generic");
+    REQUIRE(event.mask == "complement");
+
+    // Vector-matrix products with a matrix that caches its transpose read
+    // the transpose's arrays.
+    grb::vector<float, int> z(4);
+    z[0] = 1;
+    z[3] = 1;
+    grb::multiply(z, a);
+    REQUIRE(last_event().operands[0].backend == "view");
+    a.cache_transpose();
+    grb::multiply(z, a);
+    event = last_event();
+    REQUIRE(event.kernel == "dense_semiring");
+    REQUIRE(event.operands[0].backend == "csr");
+    REQUIRE(event.operands[0].shape == std::vector<std::size_t>{3, 4});
+    a.cache_transpose(false);
+
+    // Rows 0, 1 and 3 of `a` meet the rows of `a` stored in column 0, and
+    // row 2 meets the empty row 2.
+    grb::multiply(a, grb::transpose(a));
+    event = last_event();
+    REQUIRE(event.kernel == "dense_accumulator");
+    REQUIRE(event.flops == 2 * (2 * 2 + 1 * 1 + 1 * 1));
+    REQUIRE(event.operands[1].shape == std::vector<std::size_t>{3, 4});
+  }
+
+  SECTION("ewise") {
+    grb::ewise_intersection(x, y, grb::plus());
+    auto event = last_event();
+    REQUIRE(event.name == "ewise_intersection");
+    REQUIRE(event.flops == 1);
+
+    grb::ewise_union(x, y, grb::plus());
+    event = last_event();
+    REQUIRE(event.name == "ewise_union");
+    REQUIRE(event.flops == 1);
+  }
+
+  SECTION("reduce") {
+    grb::reduce(a, grb::plus(), grb::views::structure(x));
+    auto event = last_event();
+    REQUIRE(event.name == "reduce");
+    REQUIRE(event.mask == "structure");
+    REQUIRE(event.flops == 4);
+  }
+
+  SECTION("transpose") {
+    grb::transpose_materialize(a);
+    auto event = last_event();
+    REQUIRE(event.name == "transpose");
+    REQUIRE(event.kernel == "csr");
+
+    grb::transpose_materialize(grb::transpose(a));
+    event = last_event();
+    REQUIRE(event.kernel == "counting_sort");
+    REQUIRE(event.operands[0].backend == "view");
+
+    grb::transpose_materialize(a_coo);
+    event = last_event();
+    REQUIRE(event.kernel == "generic");
+    REQUIRE(event.operands[0].backend == "coo");
+  }
+
+  SECTION("permute") {
+    std::vector<int> rows = {3, 2, 1, 0};
+    std::vector<int> columns = {2, 0, 1};
+    grb::permute(a, rows, columns);
+    auto event = last_event();
+    REQUIRE(event.name == "permute");
+    REQUIRE(event.kernel == "csr");
+
+    grb::permute(a_coo, rows, columns);
+    REQUIRE(last_event().kernel == "generic");
+  }
+
+  grb::clear_trace();
+}
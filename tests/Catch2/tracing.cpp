@@ -0,0 +1,4 @@
+#define CATCH_CONFIG_MAIN
+#define GRB_ENABLE_TRACING
+
+#include "trace_2.hpp"
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+
+template <typename M1, typename M2>
+void check_transposed(M1&& a, M2&& t) {
+  REQUIRE(t.shape()[0] == a.shape()[1]);
+  REQUIRE(t.shape()[1] == a.shape()[0]);
+  REQUIRE(t.size() == a.size());
+  for (auto&& [index, value] : a) {
+    auto&& [i, j] = index;
+    auto iter = t.find({j, i});
+    REQUIRE(iter != t.end());
+    auto&& [_, t_value] = *iter;
+    REQUIRE(t_value == value);
+  }
+}
+
+TEMPLATE_TEST_CASE("transpose_materialize", "[template]", int, float) {
+  using T = TestType;
+
+  grb::matrix<T, int> a({37, 53});
+  for (int i = 0; i < 37; i++) {
+    for (int j = (i * 7) % 5; j < 53; j += 3 + i % 4) {
+      a[{i, j}] = T(i * 53 + j);
+    }
+  }
+
+  auto t = grb::transpose_materialize(a);
+  check_transposed(a, t);
+
+  // Rows of the result are sorted, as CSR requires.
+  int prev_i = -1;
+  int prev_j = -1;
+  for (auto&& [index, _] : t) {
+    auto&& [i, j] = index;
+    REQUIRE((i > prev_i || (i == prev_i && j > prev_j)));
+    prev_i = i;
+    prev_j = j;
+  }
+
+  grb::matrix<T, int, grb::coordinate> c({37, 53});
+  for (auto&& [index, value] : a) {
+    c.insert({index, value});
+  }
+  check_transposed(c, grb::transpose_materialize(c));
+  check_transposed(a, grb::transpose_materialize(grb::views::all(a)));
+}
+
+TEST_CASE("cached transpose", "[transpose]") {
+  grb::matrix<float, int> a("chesapeake/chesapeake.mtx");
+  const auto& const_a = a;
+
+  REQUIRE(a.cached_transpose() == nullptr);
+  check_transposed(a, grb::transpose(a));
+
+  a.cache_transpose();
+  REQUIRE(a.caches_transpose());
+  auto cached = a.cached_transpose();
+  REQUIRE(cached != nullptr);
+  REQUIRE(a.cached_transpose() == cached);
+  check_transposed(const_a, grb::transpose(a));
+
+  // Threads asking for the transpose at once share a single build.
+  a.invalidate_transpose();
+  std::vector<std::shared_ptr<const grb::matrix<float, int>>> built(4);
+  grb::detail::parallel_invoke(
+      built.size(), [&](std::size_t t) { built[t] = a.cached_transpose(); });
+  REQUIRE(built[0] != nullptr);
+  REQUIRE(std::count(built.begin(), built.end(), built[0]) == 4);
+
+  // Non-const accessors discard the transpose, and views read the current
+  // one.
+  auto view = grb::transpose(a);
+  cached = a.cached_transpose();
+  a.backend();
+  REQUIRE(a.cached_transpose() != cached);
+  cached = a.cached_transpose();
+  a.row(0);
+  REQUIRE(a.cached_transpose() != cached);
+
+  a[{0, 1}] = 12;
+  REQUIRE(view.find({1, 0}) != view.end());
+  REQUIRE(grb::get<1>(*view.find({1, 0})) == 12);
+  check_transposed(const_a, view);
+
+  // Vector-matrix products read the transpose's arrays.
+  grb::vector<float, int> x(a.shape()[0]);
+  for (int i = 0; i < a.shape()[0]; i += 3) {
+    x[i] = float(i % 5);
+  }
+  auto b = a;
+  b.cache_transpose(false);
+  auto expected = grb::multiply(x, b);
+  auto y = grb::multiply(x, a);
+  REQUIRE(y.size() == expected.size());
+  for (auto&& [i, value] : expected) {
+    REQUIRE(y[i] == value);
+  }
+
+  a.clear();
+  REQUIRE(a.caches_transpose());
+  REQUIRE(grb::transpose(a).size() == 0);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <grb/grb.hpp>
+
+TEST_CASE("workspace allocates and resets", "[workspace]") {
+  grb::workspace ws(256);
+
+  void* p = ws.allocate(100, 64);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+  REQUIRE(ws.used() == 100);
+
+  // Allocations larger than a block grow the arena.
+  ws.allocate(1000);
+  REQUIRE(ws.system_allocations() == 2);
+  REQUIRE(ws.capacity() >= 1100);
+
+  // Resetting merges the blocks, so the same allocations now fit.
+  ws.reset();
+  REQUIRE(ws.used() == 0);
+  ws.allocate(100, 64);
+  ws.allocate(1000);
+  REQUIRE(ws.system_allocations() == 3);
+
+  grb::workspace& local = ws.local(1);
+  local.allocate(10);
+  REQUIRE(local.used() == 10);
+  REQUIRE(&ws.local(1) == &local);
+  ws.reset();
+  REQUIRE(local.used() == 0);
+}
+
+TEST_CASE("workspace overloads match the allocating algorithms",
+          "[workspace]") {
+  auto a = grb::generate_random<float, int>({40, 30}, 0.2, 1);
+  auto x = grb::generate_random<float, int>(30, 0.5, 2);
+  auto y = grb::generate_random<float, int>(30, 0.5, 3);
+  grb::vector<float, int> mask(40);
+  for (int i = 0; i < 40; i += 3) {
+    mask[i] = 1;
+  }
+
+  auto same = [](auto&& u, auto&& v) {
+    REQUIRE(u.shape() == v.shape());
+    REQUIRE(u.size() == v.size());
+    for (auto&& [i, value] : v) {
+      auto iter = u.find(i);
+      REQUIRE(iter != u.end());
+      REQUIRE(grb::get<1>(*iter) == value);
+    }
+  };
+
+  grb::workspace ws;
+
+  same(grb::multiply(ws, a, x), grb::multiply(a, x));
+  same(grb::multiply(ws, a, x, grb::min{}, grb::plus{}, mask),
+       grb::multiply(a, x, grb::min{}, grb::plus{}, mask));
+  same(grb::multiply(ws, a, x, grb::logical_or{}, grb::logical_and{},
+                     grb::complement_view(mask)),
+       grb::multiply(a, x, grb::logical_or{}, grb::logical_and{},
+                     grb::complement_view(mask)));
+  same(grb::multiply(ws, a, x, grb::max{}, grb::minus{}),
+       grb::multiply(a, x, grb::max{}, grb::minus{}));
+  same(grb::multiply(ws, mask, a), grb::multiply(mask, a));
+
+  same(grb::ewise_union(ws, x, y, grb::plus{}),
+       grb::ewise_union(x, y, grb::plus{}));
+  same(
+      grb::ewise_intersection(ws, x, y, grb::times{}, grb::views::structure(y)),
+      grb::ewise_intersection(x, y, grb::times{}, grb::views::structure(y)));
+
+  same(grb::reduce(ws, a, grb::max{}, mask), grb::reduce(a, grb::max{}, mask));
+}
+
+TEST_CASE("workspace stops allocating once an iteration fits",
+          "[workspace]") {
+  auto a = grb::generate_random<float, int>({200, 200}, 0.05, 4);
+
+  // Power iteration, double-buffered between two workspaces so that each
+  // step can read the previous step's result.
+  grb::workspace buffers[2] = {grb::workspace(64), grb::workspace(64)};
+  grb::vector<float, int, grb::dense, grb::workspace_allocator<float>> x(
+      200, buffers[0]);
+  for (int i = 0; i < 200; i++) {
+    x[i] = 1;
+  }
+
+  std::size_t warm = 0;
+  for (std::size_t step = 1; step <= 10; step++) {
+    auto&& ws = buffers[step % 2];
+    ws.reset();
+    auto y = grb::multiply(ws, a, x);
+    x = grb::ewise_union(ws, y, x, grb::plus{});
+
+    // Each workspace has been reset after a step by now, merging the blocks
+    // that step needed.
+    if (step == 4) {
+      warm = buffers[0].system_allocations() +
+             buffers[1].system_allocations();
+    }
+  }
+
+  REQUIRE(warm > 0);
+  REQUIRE(buffers[0].system_allocations() + buffers[1].system_allocations() ==
+          warm);
+}